@@ -58,6 +58,7 @@ EditorContext::EditorContext(DevicePtr dptr) :
 
 
 	load_world();
+	update_flight_recorder();
 }
 
 EditorContext::~EditorContext() {
@@ -73,6 +74,44 @@ void EditorContext::end_perf_capture() {
 	}
 }
 
+void EditorContext::update_flight_recorder() {
+	const PerfSettings& perf_settings = settings().perf();
+	if(perf_settings.flight_recorder) {
+		perf::FlightRecorderSettings flight_settings;
+		flight_settings.frame_count = perf_settings.flight_frames;
+		flight_settings.spike_threshold_ms = perf_settings.spike_threshold_ms;
+		flight_settings.output_prefix = perf_settings.spike_dump_prefix;
+		perf::start_flight_recorder(flight_settings);
+	} else {
+		perf::stop_flight_recorder();
+	}
+}
+
+void EditorContext::sample_perf_counters() const {
+#ifdef Y_PERF_LOG_ENABLED
+	if(!perf::is_capturing() && !perf::is_flight_recording()) {
+		return;
+	}
+
+	usize heap_used = 0;
+	for(auto&& [type, heaps] : device()->allocator().heaps()) {
+		unused(type);
+		for(const auto& heap : heaps) {
+			heap_used += heap->size() - heap->available();
+		}
+	}
+	for(auto&& [type, heap] : device()->allocator().dedicated_heaps()) {
+		unused(type);
+		heap_used += heap->allocated_size();
+	}
+
+	y_profile_counter("Device heap used bytes", heap_used);
+	y_profile_counter("Pending deletions", device()->lifetime_manager().pending_deletions());
+	y_profile_counter("Asset loading jobs", _loader.thread_pool().pending_loading_jobs());
+	y_profile_counter("Asset finalize jobs", _loader.thread_pool().pending_finalize_jobs());
+#endif
+}
+
 void EditorContext::reload_device_resources() {
 	_reload_resources = true;
 }
@@ -118,6 +157,9 @@ void EditorContext::flush_deferred() {
 	}
 	_world.flush();
 
+	sample_perf_counters();
+	perf::end_frame();
+
 	if(_perf_capture_frames) {
 		if(perf::is_capturing()) {
 			if(--_perf_capture_frames == 0) {
@@ -46,6 +46,7 @@ class EditorContext : NonMovable, public DeviceLinked {
 
 		void start_perf_capture();
 		void end_perf_capture();
+		void update_flight_recorder();
 		void reload_device_resources();
 		void set_device_resource_reloaded();
 		bool device_resources_reload_requested() const;
@@ -94,6 +95,8 @@ class EditorContext : NonMovable, public DeviceLinked {
 	private:
 		static ecs::EntityWorld create_editor_world();
 
+		void sample_perf_counters() const;
+
 		std::unique_ptr<FileSystemModel> _filesystem;
 
 		std::mutex _deferred_lock;
@@ -28,6 +28,8 @@ SOFTWARE.
 #include <y/core/String.h>
 #include <y/utils/log.h>
 
+#include <mutex>
+
 namespace editor {
 
 class Logs {
@@ -41,11 +43,14 @@ class Logs {
 			log_msg(Message{std::move(msg), type});
 		}
 
+		// Called from the log drain thread
 		void log_msg(Message msg) {
+			const std::unique_lock lock(_lock);
 			_this_frame.emplace_back(std::move(msg));
 		}
 
 		void flush() {
+			const std::unique_lock lock(_lock);
 			_this_frame.swap(_last_frame);
 			_this_frame.clear();
 		}
@@ -55,6 +60,7 @@ class Logs {
 		}
 
 	private:
+		std::mutex _lock;
 		core::Vector<Message> _this_frame;
 		core::Vector<Message> _last_frame;
 };
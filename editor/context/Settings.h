@@ -70,7 +70,12 @@ struct PerfSettings {
 	u32 capture_frames = 60;
 	core::String capture_name = "../perfdump.json";
 
-	y_serde3(capture_forever, capture_frames, capture_name)
+	bool flight_recorder = false;
+	u32 flight_frames = 8;
+	float spike_threshold_ms = 50.0f;
+	core::String spike_dump_prefix = "../perfspike";
+
+	y_serde3(capture_forever, capture_frames, capture_name, flight_recorder, flight_frames, spike_threshold_ms, spike_dump_prefix)
 };
 
 
@@ -167,7 +167,7 @@ void Ui::paint(CmdBufferRecorder& recorder, const FrameToken& token) {
 
 void Ui::refresh_all(core::Span<std::unique_ptr<UiElement>> elements) {
 	for(const auto& elem : elements) {
-		y_profile_zone(elem->title().data());
+		y_profile_zone_id(elem->_zone_id);
 		elem->refresh();
 		refresh_all(elem->children());
 	}
@@ -22,6 +22,8 @@ SOFTWARE.
 
 #include "transforms.h"
 
+#include <y/concurrent/parallel.h>
+
 #include <y/utils/log.h>
 #include <y/utils/perf.h>
 
@@ -93,9 +95,9 @@ MeshData compute_tangents(const MeshData& mesh) {
 		vertices[tri[2]].tangent += ta;
 	}
 
-	for(Vertex& v : vertices) {
+	concurrent::parallel_for(vertices, 1024, [](Vertex& v) {
 		v.tangent.normalize();
-	}
+	});
 
 	return MeshData(std::move(vertices), std::move(triangles), copy(mesh.skin()), copy(mesh.bones()));
 }
@@ -142,26 +144,30 @@ ImageData compute_mipmaps(const ImageData& image) {
 	const std::unique_ptr<u8[]> data = std::make_unique<u8[]>(data_size);
 
 	const auto compute_mip = [&](const u8* image_data, u8* output, const math::Vec2ui& orig_size) -> usize {
-			usize cursor = 0;
 			const math::Vec2ui mip_size = {std::max(1u, orig_size.x() / 2),
 										   std::max(1u, orig_size.y() / 2)};
 
-			usize row_size = orig_size.x();
-
-			for(usize y = 0; y != mip_size.y(); ++y) {
-				for(usize x = 0; x != mip_size.x(); ++x) {
-					const usize orig = (x * 2 + y * 2 * row_size);
-					for(usize c = 0; c != components; ++c) {
-						u32 acc  = image_data[components * (orig) + c];
-						acc		+= image_data[components * (orig + 1) + c];
-						acc		+= image_data[components * (orig + row_size) + c];
-						acc		+= image_data[components * (orig + row_size + 1) + c];
-						y_debug_assert(output + cursor < data.get() + data_size);
-						output[cursor++] = std::min(acc / 4, 0xFFu);
+			const usize row_size = orig_size.x();
+			const usize mip_row_byte_size = mip_size.x() * components;
+
+			// Rows are independent, each chunk writes its own slice of the output
+			concurrent::parallel_for_chunks(mip_size.y(), 16, [&](usize begin, usize end) {
+				usize cursor = begin * mip_row_byte_size;
+				for(usize y = begin; y != end; ++y) {
+					for(usize x = 0; x != mip_size.x(); ++x) {
+						const usize orig = (x * 2 + y * 2 * row_size);
+						for(usize c = 0; c != components; ++c) {
+							u32 acc  = image_data[components * (orig) + c];
+							acc		+= image_data[components * (orig + 1) + c];
+							acc		+= image_data[components * (orig + row_size) + c];
+							acc		+= image_data[components * (orig + row_size + 1) + c];
+							y_debug_assert(output + cursor < data.get() + data_size);
+							output[cursor++] = std::min(acc / 4, 0xFFu);
+						}
 					}
 				}
-			}
-			return cursor;
+			});
+			return mip_row_byte_size * mip_size.y();
 		};
 
 
@@ -31,6 +31,9 @@ SOFTWARE.
 
 #include <y/core/Chrono.h>
 #include <y/concurrent/concurrent.h>
+#include <y/utils/log.h>
+
+#include <atomic>
 
 #ifdef Y_OS_WIN
 #include <windows.h>
@@ -39,7 +42,8 @@ SOFTWARE.
 
 using namespace editor;
 
-static EditorContext* context = nullptr;
+// Read from the log drain thread
+static std::atomic<EditorContext*> context = nullptr;
 
 #ifdef Y_DEBUG
 static bool display_console = true;
@@ -83,8 +87,8 @@ static void parse_args(int argc, char** argv) {
 
 static void setup_logger() {
 	set_log_callback([](std::string_view msg, Log type, void*) {
-			if(context) {
-				context->log_message(msg, type);
+			if(EditorContext* ctx = context.load()) {
+				ctx->log_message(msg, type);
 			}
 			return !display_console;
 		});
@@ -113,6 +117,7 @@ int main(int argc, char** argv) {
 
 	parse_args(argc, argv);
 	setup_logger();
+	start_async_logging();
 
 	if(!crashhandler::setup_handler()) {
 		log_msg("Unable to setup crash handler.", Log::Warning);
@@ -165,6 +170,7 @@ int main(int argc, char** argv) {
 		perf::end_capture();
 	}
 
+	stop_async_logging();
 	set_log_callback(nullptr);
 	context = nullptr;
 
@@ -42,6 +42,9 @@ void UiElement::set_title(std::string_view title) {
 	const core::String new_title = fmt("%##%", title, _id);
 	_title_with_id = std::move(new_title);
 	_title = std::string_view(_title_with_id.begin(), title.size());
+#ifdef Y_PERF_LOG_ENABLED
+	_zone_id = perf::zone_id(core::String(_title).data());
+#endif
 }
 
 bool UiElement::can_destroy() const {
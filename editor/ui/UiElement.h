@@ -26,6 +26,7 @@ SOFTWARE.
 #include <yave/graphics/swapchain/FrameToken.h>
 
 #include <y/core/String.h>
+#include <y/utils/perf.h>
 
 namespace editor {
 
@@ -77,6 +78,10 @@ class UiElement : NonMovable {
 		bool has_visible_children() const;
 
 		u64 _id = 0;
+
+		// Interned from the title without its id, so that every instance of a window shares its zone
+		perf::ZoneId _zone_id = 0;
+
 		bool _is_child = false;
 		bool _refresh_all = false;
 		core::Vector<std::unique_ptr<UiElement>> _children;
@@ -128,6 +128,9 @@ EntityView::EntityView(ContextPtr cptr) :
 void EntityView::paint_view() {
 	const ecs::EntityWorld& world = context()->world();
 	
+	// One label per entity per frame, the placeholders are found at compile time
+	static constexpr FmtString entity_label = ICON_FA_CUBE " %##%";
+
 	if(ImGui::BeginChild("##entities", ImVec2(), true)) {
 		imgui::alternating_rows_background();
 		for(ecs::EntityId id : world.entities()) {
@@ -138,7 +141,7 @@ void EntityView::paint_view() {
 			}
 
 			const bool selected = context()->selection().selected_entity() == id;
-			if(ImGui::Selectable(fmt_c_str(ICON_FA_CUBE " %##%", comp->name(), id.index()), selected)) {
+			if(ImGui::Selectable(fmt_c_str(entity_label, comp->name(), id.index()), selected)) {
 				 context()->selection().set_selected(id);
 			}
 			if(ImGui::IsItemHovered()) {
@@ -155,6 +158,8 @@ void EntityView::paint_view() {
 void EntityView::paint_clustered_view() {
 	const ecs::EntityWorld& world = context()->world();
 
+	static constexpr FmtString entity_label = "% %##%";
+
 	auto paint_group = [&](const ArchetypeBase& archetype) {
 		const char* icon = archetype.icon();
 		ImGui::PushID(archetype.name());
@@ -182,7 +187,7 @@ void EntityView::paint_clustered_view() {
 				if(context()->selection().selected_entity() == id) {
 					flags |= ImGuiTreeNodeFlags_Selected;
 				}
-				ImGui::TreeNodeEx(fmt_c_str("% %##%", icon, editor_comp->name(), id.index()), flags);
+				ImGui::TreeNodeEx(fmt_c_str(entity_label, icon, editor_comp->name(), id.index()), flags);
 
 				if(ImGui::IsItemClicked()) {
 					context()->selection().set_selected(id);
@@ -114,6 +114,40 @@ void MemoryInfo::paint_ui(CmdBufferRecorder&, const FrameToken&) {
 
 		ImGui::ProgressBar(used_sets / float(total_sets), ImVec2(0, 0), fmt_c_str("% / % sets", used_sets, total_sets));
 	}
+
+	{
+		ImGui::Spacing();
+		ImGui::Separator();
+
+		if(_tag_timer.elapsed().to_secs() > 0.5) {
+			_tag_timer.reset();
+			_tag_sampler.sample();
+		}
+
+		ImGui::Columns(4);
+		ImGui::TextUnformatted("Host memory");
+		ImGui::NextColumn();
+		ImGui::TextUnformatted("Live");
+		ImGui::NextColumn();
+		ImGui::TextUnformatted("Peak");
+		ImGui::NextColumn();
+		ImGui::TextUnformatted("Allocations");
+		ImGui::NextColumn();
+		ImGui::Separator();
+
+		const memory::MemoryTagReport& report = _tag_sampler.last_sample();
+		for(usize i = 0; i != report.size(); ++i) {
+			ImGui::TextUnformatted(memory::memory_tag_name(memory::MemoryTag(i)));
+			ImGui::NextColumn();
+			ImGui::Text("%.1fMB", to_mb(report[i].live_bytes));
+			ImGui::NextColumn();
+			ImGui::Text("%.1fMB", to_mb(report[i].peak_bytes));
+			ImGui::NextColumn();
+			ImGui::Text("%.0f/s (%.1fMB/s)", report[i].allocations_per_sec, to_mb(usize(report[i].bytes_per_sec)));
+			ImGui::NextColumn();
+		}
+		ImGui::Columns(1);
+	}
 }
 
 }
@@ -25,6 +25,7 @@ SOFTWARE.
 #include <editor/ui/Widget.h>
 
 #include <y/core/Chrono.h>
+#include <y/mem/MemoryTags.h>
 
 namespace editor {
 
@@ -41,6 +42,9 @@ class MemoryInfo : public Widget, public ContextLinked {
 
 		usize _current_index = 0;
 		std::array<float, 256> _history;
+
+		core::Chrono _tag_timer;
+		memory::MemoryTagSampler _tag_sampler;
 };
 
 }
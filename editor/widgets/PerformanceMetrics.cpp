@@ -28,6 +28,28 @@ SOFTWARE.
 
 namespace editor {
 
+static constexpr usize max_displayed_zones = 32;
+
+static void sort_zones(core::Vector<perf::ZoneStats>& zones, usize column) {
+	const auto sort_by = [&](auto&& key) {
+		std::sort(zones.begin(), zones.end(), [&](const perf::ZoneStats& a, const perf::ZoneStats& b) { return key(a) > key(b); });
+	};
+
+	switch(column) {
+		case 0:
+			std::sort(zones.begin(), zones.end(), [](const perf::ZoneStats& a, const perf::ZoneStats& b) { return a.name < b.name; });
+		break;
+
+		case 1: sort_by([](const perf::ZoneStats& z) { return double(z.count); }); break;
+		case 3: sort_by([](const perf::ZoneStats& z) { return z.min_us; }); break;
+		case 4: sort_by([](const perf::ZoneStats& z) { return z.max_us; }); break;
+		case 5: sort_by([](const perf::ZoneStats& z) { return z.p50_us; }); break;
+		case 6: sort_by([](const perf::ZoneStats& z) { return z.p99_us; }); break;
+
+		default: sort_by([](const perf::ZoneStats& z) { return z.total_us; }); break;
+	}
+}
+
 PerformanceMetrics::PerformanceMetrics(ContextPtr cptr) : Widget("Performance", ImGuiWindowFlags_AlwaysAutoResize), ContextLinked(cptr) {
 	std::fill(_frames.begin(), _frames.end(), 0.0f);
 	std::fill(_average.begin(), _average.end(), 0.0f);
@@ -66,6 +88,63 @@ void PerformanceMetrics::paint_ui(CmdBufferRecorder&, const FrameToken&) {
 
 	ImGui::Text("%.3u resources waiting deletion", unsigned(device()->lifetime_manager().pending_deletions()));
 	ImGui::Text("%.3u active command buffers", unsigned(device()->lifetime_manager().active_cmd_buffers()));
+
+	paint_zones();
+}
+
+void PerformanceMetrics::paint_zones() {
+	ImGui::Spacing();
+	ImGui::Separator();
+
+	bool enabled = perf::zone_stats_enabled();
+	if(ImGui::Checkbox("Zone stats", &enabled)) {
+		perf::set_zone_stats_enabled(enabled);
+	}
+
+	if(!enabled) {
+		return;
+	}
+
+	// Stats are per frame, refresh slowly enough to be readable
+	if(_zone_timer.elapsed().to_secs() > 0.5) {
+		_zone_timer.reset();
+		_zones = perf::zone_stats();
+		sort_zones(_zones.zones, _sort_column);
+	}
+
+	ImGui::Text("Frame %u: %.2fms", unsigned(_zones.frame), _zones.frame_us / 1000.0);
+
+	const std::array<const char*, 7> headers = {"Zone", "Count", "Total", "Min", "Max", "p50", "p99"};
+
+	ImGui::Columns(int(headers.size()));
+	for(usize i = 0; i != headers.size(); ++i) {
+		if(ImGui::Selectable(headers[i], _sort_column == i)) {
+			_sort_column = i;
+			sort_zones(_zones.zones, _sort_column);
+		}
+		ImGui::NextColumn();
+	}
+	ImGui::Separator();
+
+	const usize zone_count = std::min(_zones.zones.size(), max_displayed_zones);
+	for(usize i = 0; i != zone_count; ++i) {
+		const perf::ZoneStats& zone = _zones.zones[i];
+		ImGui::TextUnformatted(zone.name.data());
+		ImGui::NextColumn();
+		ImGui::Text("%u", unsigned(zone.count));
+		ImGui::NextColumn();
+		ImGui::Text("%.3fms", zone.total_us / 1000.0);
+		ImGui::NextColumn();
+		ImGui::Text("%.1fus", zone.min_us);
+		ImGui::NextColumn();
+		ImGui::Text("%.1fus", zone.max_us);
+		ImGui::NextColumn();
+		ImGui::Text("%.1fus", zone.p50_us);
+		ImGui::NextColumn();
+		ImGui::Text("%.1fus", zone.p99_us);
+		ImGui::NextColumn();
+	}
+	ImGui::Columns(1);
 }
 
 }
@@ -25,6 +25,7 @@ SOFTWARE.
 #include <editor/ui/Widget.h>
 
 #include <y/core/Chrono.h>
+#include <y/utils/perf.h>
 
 namespace editor {
 
@@ -34,6 +35,7 @@ class PerformanceMetrics : public Widget, public ContextLinked {
 
 	private:
 		void paint_ui(CmdBufferRecorder&, const FrameToken&) override;
+		void paint_zones();
 
 		core::Chrono _timer;
 
@@ -45,6 +47,10 @@ class PerformanceMetrics : public Widget, public ContextLinked {
 		
 		double _total = 0.0;
 		float _max = 16.0f;
+
+		core::Chrono _zone_timer;
+		perf::ZoneStatsSnapshot _zones;
+		usize _sort_column = 2;
 };
 
 }
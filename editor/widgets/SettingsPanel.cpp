@@ -94,6 +94,29 @@ static void perf_settings(ContextPtr ctx) {
 	if(capture_frames > 1) {
 		perf.capture_frames = capture_frames;
 	}
+
+	ImGui::Separator();
+
+	bool flight_changed = ImGui::Checkbox("Flight recorder", &perf.flight_recorder);
+
+	int flight_frames = perf.flight_frames;
+	flight_changed |= ImGui::InputInt("Number of frames to keep", &flight_frames);
+	flight_changed |= ImGui::InputFloat("Spike threshold (ms)", &perf.spike_threshold_ms);
+
+	if(flight_frames > 0) {
+		perf.flight_frames = flight_frames;
+	}
+
+	if(flight_changed) {
+		ctx->update_flight_recorder();
+	}
+
+	if(perf::is_flight_recording() && ImGui::Button("Dump recent frames")) {
+		const core::String filename = perf::dump_recent();
+		if(!filename.is_empty()) {
+			log_msg(fmt("Recent frames dumped to %", filename));
+		}
+	}
 }
 
 void SettingsPanel::paint_ui(CmdBufferRecorder&, const FrameToken&) {
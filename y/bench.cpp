@@ -0,0 +1,136 @@
+/*******************************
+Copyright (c) 2016-2020 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+
+
+#include <y/bench/bench.h>
+
+#include <y/io2/File.h>
+#include <y/utils/log.h>
+#include <y/utils/format.h>
+
+#include <cstdlib>
+#include <new>
+#include <string_view>
+
+using namespace y;
+
+// Counts every global allocation so benchmarks can report allocations per item
+void* operator new(std::size_t size) {
+	bench::detail::count_allocation();
+	if(void* ptr = std::malloc(size ? size : 1)) {
+		return ptr;
+	}
+	throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+	std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+	std::free(ptr);
+}
+
+// y_bench [--filter name] [--warmup n] [--reps n] [--json out.json] [--baseline baseline.json] [--threshold percent]
+// Exits with an error if any benchmark is slower than its baseline by more than the threshold (10% by default)
+int main(int argc, char** argv) {
+	bench::BenchSettings settings;
+	core::String json_filename;
+	core::String baseline_filename;
+	double threshold = 10.0;
+
+	for(int i = 1; i < argc; ++i) {
+		const std::string_view arg = argv[i];
+		const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+		if(!value) {
+			log_msg(fmt("Missing value for %", arg), Log::Error);
+			return 1;
+		}
+		++i;
+
+		if(arg == "--filter") {
+			settings.filter = value;
+		} else if(arg == "--warmup") {
+			settings.warmup = usize(std::atoll(value));
+		} else if(arg == "--reps") {
+			settings.repetitions = usize(std::atoll(value));
+		} else if(arg == "--json") {
+			json_filename = value;
+		} else if(arg == "--baseline") {
+			baseline_filename = value;
+		} else if(arg == "--threshold") {
+			threshold = std::atof(value);
+		} else {
+			log_msg(fmt("Unknown argument %", arg), Log::Error);
+			return 1;
+		}
+	}
+
+	const core::Vector<bench::BenchResult> results = bench::run_benches(settings);
+
+	if(!json_filename.is_empty()) {
+		const core::String json = bench::to_json(results);
+		auto file = io2::File::create(json_filename);
+		if(!file || !file.unwrap().write(json.data(), json.size())) {
+			log_msg(fmt("Unable to write %", json_filename), Log::Error);
+			return 1;
+		}
+	}
+
+	if(baseline_filename.is_empty()) {
+		return 0;
+	}
+
+	core::Vector<u8> data;
+	{
+		auto file = io2::File::open(baseline_filename);
+		if(!file || !file.unwrap().read_all(data)) {
+			log_msg(fmt("Unable to read %", baseline_filename), Log::Error);
+			return 1;
+		}
+	}
+
+	const auto baseline = bench::from_json(std::string_view(reinterpret_cast<const char*>(data.data()), data.size()));
+	if(!baseline) {
+		log_msg(fmt("Invalid baseline %", baseline_filename), Log::Error);
+		return 1;
+	}
+
+	usize regressions = 0;
+	for(const bench::BenchComparison& comparison : bench::compare(results, baseline.unwrap())) {
+		const double change = (comparison.ratio - 1.0) * 100.0;
+		if(change > threshold) {
+			++regressions;
+			log_msg(fmt("%[%]: %% slower than baseline (% vs %ns)", comparison.result->name, comparison.result->param, change, "%", comparison.result->median_ns, comparison.baseline->median_ns), Log::Error);
+		} else if(change < -threshold) {
+			log_msg(fmt("%[%]: %% faster than baseline", comparison.result->name, comparison.result->param, -change, "%"), Log::Perf);
+		}
+	}
+
+	if(regressions) {
+		log_msg(fmt("% regressions above %%", regressions, threshold, "%"), Log::Error);
+		return 1;
+	}
+
+	log_msg("No regressions");
+	return 0;
+}
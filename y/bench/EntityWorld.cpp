@@ -0,0 +1,348 @@
+/*******************************
+Copyright (c) 2016-2020 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+
+
+#include <y/bench/bench.h>
+
+#include <y/ecs/EntityWorld.h>
+#include <y/ecs/Query.h>
+#include <y/core/Vector.h>
+
+#include <array>
+
+namespace {
+using namespace y;
+
+struct Position {
+	float x = 0.0f;
+	float y = 0.0f;
+	float z = 0.0f;
+};
+
+struct Velocity {
+	float x = 1.0f;
+	float y = 1.0f;
+	float z = 1.0f;
+};
+
+struct Tag {
+	u32 value = 0;
+};
+
+struct Payload {
+	std::array<u64, 8> data = {};
+};
+
+template<usize I>
+struct Component {
+	u32 value = I;
+};
+
+static constexpr usize component_type_count = 9;
+static constexpr usize archetype_count = 500;
+
+template<usize I = 0>
+static void add_component_type(ecs::EntityWorld& world, ecs::EntityID id, usize type) {
+	if constexpr(I < component_type_count) {
+		if(type == I) {
+			world.add_component<Component<I>>(id);
+		} else {
+			add_component_type<I + 1>(world, id, type);
+		}
+	}
+}
+
+// Entity i gets the components matching the bits of (i % archetype_count) + 1
+static core::Vector<ecs::EntityID> create_archetype_entities(ecs::EntityWorld& world, usize count) {
+	static_assert((1 << component_type_count) > archetype_count);
+	core::Vector<ecs::EntityID> ids;
+	for(usize i = 0; i != count; ++i) {
+		const ecs::EntityID id = world.create_entity();
+		const usize signature = (i % archetype_count) + 1;
+		for(usize c = 0; c != component_type_count; ++c) {
+			if(signature & (usize(1) << c)) {
+				add_component_type(world, id, c);
+			}
+		}
+		ids << id;
+	}
+	return ids;
+}
+
+static core::Vector<ecs::EntityID> create_entities(ecs::EntityWorld& world, usize count) {
+	core::Vector<ecs::EntityID> ids;
+	for(usize i = 0; i != count; ++i) {
+		const ecs::EntityID id = world.create_entity();
+		world.add_components<Position, Velocity>(id);
+		ids << id;
+	}
+	return ids;
+}
+
+y_bench_func("EntityWorld create", 1024, 100 * 1024) {
+	const usize count = state.param();
+	while(state.run()) {
+		ecs::EntityWorld world;
+		bench::do_not_optimize(create_entities(world, count).data());
+	}
+	state.set_items_per_run(count);
+}
+
+y_bench_func("EntityWorld create batched", 1024, 100 * 1024) {
+	const usize count = state.param();
+	while(state.run()) {
+		ecs::EntityWorld world;
+		bench::do_not_optimize(world.create_entities<Position, Velocity>(count).data());
+	}
+	state.set_items_per_run(count);
+}
+
+y_bench_func("EntityWorld iterate", 1024, 16 * 1024, 256 * 1024) {
+	const usize count = state.param();
+	ecs::EntityWorld world;
+	create_entities(world, count);
+	while(state.run()) {
+		for(const auto& archetype : world.archetypes()) {
+			for(auto&& [pos, vel] : archetype->view<Position, Velocity>()) {
+				pos.x += vel.x;
+				pos.y += vel.y;
+				pos.z += vel.z;
+			}
+		}
+	}
+	state.set_items_per_run(count);
+}
+
+y_bench_func("EntityWorld iterate chunks", 1024, 16 * 1024, 256 * 1024) {
+	const usize count = state.param();
+	ecs::EntityWorld world;
+	create_entities(world, count);
+	const auto view = world.view<Position, const Velocity>();
+	while(state.run()) {
+		view.for_each_chunk([](const ecs::ComponentChunk<Position, const Velocity>& chunk) {
+			chunk.for_each([](Position& pos, const Velocity& vel) {
+				pos.x += vel.x;
+				pos.y += vel.y;
+				pos.z += vel.z;
+			});
+		});
+	}
+	state.set_items_per_run(count);
+}
+
+y_bench_func("EntityWorld par_each", 1024, 16 * 1024, 256 * 1024) {
+	const usize count = state.param();
+	ecs::EntityWorld world;
+	create_entities(world, count);
+	const auto view = world.view<Position, const Velocity>();
+	while(state.run()) {
+		view.par_each([](Position& pos, const Velocity& vel) {
+			pos.x += vel.x;
+			pos.y += vel.y;
+			pos.z += vel.z;
+		});
+	}
+	state.set_items_per_run(count);
+}
+
+// Entities leave their archetype in reverse creation order, so that every entity is the last of its archetype
+y_bench_func("EntityWorld add component", 1024, 16 * 1024) {
+	const usize count = state.param();
+	while(state.run()) {
+		state.pause();
+		ecs::EntityWorld world;
+		const core::Vector<ecs::EntityID> ids = create_entities(world, count);
+		state.resume();
+
+		for(usize i = ids.size(); i != 0; --i) {
+			world.add_component<Tag>(ids[i - 1]);
+		}
+	}
+	state.set_items_per_run(count);
+}
+
+// Entities already have components so the type list of their new archetype is built from the old one
+y_bench_func("EntityWorld add components", 1024, 16 * 1024) {
+	const usize count = state.param();
+	while(state.run()) {
+		state.pause();
+		ecs::EntityWorld world;
+		const core::Vector<ecs::EntityID> ids = create_entities(world, count);
+		state.resume();
+
+		for(usize i = ids.size(); i != 0; --i) {
+			world.add_components<Tag, float, u64>(ids[i - 1]);
+		}
+
+		state.pause();
+	}
+	state.set_items_per_run(count);
+}
+
+y_bench_func("EntityWorld remove", 1024, 16 * 1024) {
+	const usize count = state.param();
+	while(state.run()) {
+		state.pause();
+		ecs::EntityWorld world;
+		core::Vector<ecs::EntityID> ids = create_entities(world, count);
+		state.resume();
+
+		while(!ids.is_empty()) {
+			world.remove_entity(ids.pop());
+		}
+	}
+	state.set_items_per_run(count);
+}
+
+y_bench_func("EntityWorld add component batched", 1024, 16 * 1024) {
+	const usize count = state.param();
+	while(state.run()) {
+		state.pause();
+		ecs::EntityWorld world;
+		const core::Vector<ecs::EntityID> ids = world.create_entities<Position, Velocity>(count);
+		state.resume();
+
+		world.add_components<Tag>(ids);
+	}
+	state.set_items_per_run(count);
+}
+
+y_bench_func("EntityWorld remove batched", 1024, 16 * 1024) {
+	const usize count = state.param();
+	while(state.run()) {
+		state.pause();
+		ecs::EntityWorld world;
+		const core::Vector<ecs::EntityID> ids = world.create_entities<Position, Velocity>(count);
+		state.resume();
+
+		world.remove_entities(ids);
+	}
+	state.set_items_per_run(count);
+}
+
+// Entities leave from the front of their archetype, so the source has to be compacted every time
+y_bench_func("EntityWorld migrate", 1024, 16 * 1024) {
+	const usize count = state.param();
+	while(state.run()) {
+		state.pause();
+		ecs::EntityWorld world;
+		const core::Vector<ecs::EntityID> ids = world.create_entities<Position, Velocity, Payload>(count);
+		state.resume();
+
+		for(const ecs::EntityID id : ids) {
+			world.add_component<Tag>(id);
+		}
+	}
+	state.set_items_per_run(count);
+}
+
+// Every other entity, so runs are short in the source but contiguous in the destination
+y_bench_func("EntityWorld migrate batched", 1024, 16 * 1024) {
+	const usize count = state.param();
+	while(state.run()) {
+		state.pause();
+		ecs::EntityWorld world;
+		const core::Vector<ecs::EntityID> ids = world.create_entities<Position, Velocity, Payload>(count * 2);
+		core::Vector<ecs::EntityID> half;
+		for(usize i = 0; i != ids.size(); i += 2) {
+			half << ids[i];
+		}
+		state.resume();
+
+		world.add_components<Tag>(half);
+	}
+	state.set_items_per_run(count);
+}
+
+y_bench_func("EntityWorld migrate batched contiguous", 1024, 16 * 1024) {
+	const usize count = state.param();
+	while(state.run()) {
+		state.pause();
+		ecs::EntityWorld world;
+		const core::Vector<ecs::EntityID> ids = world.create_entities<Position, Velocity, Payload>(count);
+		state.resume();
+
+		world.add_components<Tag>(ids);
+	}
+	state.set_items_per_run(count);
+}
+
+// One entity per archetype: the cost is dominated by finding the matching archetypes
+y_bench_func("EntityWorld view 500 archetypes", 1) {
+	ecs::EntityWorld world;
+	create_archetype_entities(world, archetype_count);
+	while(state.run()) {
+		for(auto&& [a, b] : world.view<Component<0>, const Component<3>>()) {
+			a.value += b.value;
+		}
+	}
+	state.set_items_per_run(archetype_count);
+}
+
+y_bench_func("EntityWorld query 500 archetypes", 1) {
+	ecs::EntityWorld world;
+	create_archetype_entities(world, archetype_count);
+	ecs::Query<Component<0>, const Component<3>> query(world);
+	while(state.run()) {
+		query.for_each([](Component<0>& a, const Component<3>& b) {
+			a.value += b.value;
+		});
+	}
+	state.set_items_per_run(archetype_count);
+}
+
+// Oscillates around the chunk boundary so that chunks keep being freed and reallocated
+y_bench_func("EntityWorld chunk churn", 2 * 1024) {
+	ecs::EntityWorld world;
+	core::Vector<ecs::EntityID> ids;
+	const usize low = state.param();
+	const usize high = 10 * low;
+	while(state.run()) {
+		while(ids.size() < high) {
+			const ecs::EntityID id = world.create_entity();
+			world.add_components<Position, Payload>(id);
+			ids << id;
+		}
+		while(ids.size() > low) {
+			world.remove_entity(ids.pop());
+		}
+	}
+	state.set_items_per_run(high - low);
+}
+
+// Every structural change after the first one of each archetype goes through the cached edges
+y_bench_func("EntityWorld add remove component 500 archetypes", 1024 * 1024) {
+	const usize count = state.param();
+	ecs::EntityWorld world;
+	const core::Vector<ecs::EntityID> ids = create_archetype_entities(world, count);
+	while(state.run()) {
+		for(const ecs::EntityID id : ids) {
+			world.add_component<Tag>(id);
+		}
+		for(const ecs::EntityID id : ids) {
+			world.remove_component<Tag>(id);
+		}
+	}
+	state.set_items_per_run(count * 2);
+}
+
+}
@@ -0,0 +1,80 @@
+/*******************************
+Copyright (c) 2016-2020 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+
+#include <y/bench/bench.h>
+
+#include <y/core/Functor.h>
+#include <y/concurrent/StaticThreadPool.h>
+
+#include <atomic>
+
+namespace {
+using namespace y;
+
+// Same layout as core::Function before it got inline storage
+using HeapFunction = core::detail::Functor<std::unique_ptr, void()>;
+
+static constexpr usize tasks_per_frame = 1000;
+
+// A frame worth of small captures queued then run, allocations are reported per task
+template<typename Func>
+static void bench_function_frame(bench::State& state) {
+	std::atomic<u64> sink = 0;
+	core::Vector<Func> queue;
+	queue.set_min_capacity(tasks_per_frame);
+
+	for(u64 frame = 0; state.run(); ++frame) {
+		for(usize i = 0; i != tasks_per_frame; ++i) {
+			const u64 a = frame;
+			const u64 b = i;
+			queue.emplace_back([&sink, a, b, c = a * b] { sink += a + b + c; });
+		}
+		for(const Func& f : queue) {
+			f();
+		}
+		queue.make_empty();
+	}
+	state.set_items_per_run(tasks_per_frame);
+}
+
+y_bench_func("Function heap frame") {
+	bench_function_frame<HeapFunction>(state);
+}
+
+y_bench_func("Function inline frame") {
+	bench_function_frame<core::Function<void()>>(state);
+}
+
+y_bench_func("StaticThreadPool frame", 4) {
+	concurrent::StaticThreadPool pool(state.param());
+	std::atomic<u64> sink = 0;
+	for(usize frame = 0; state.run(); ++frame) {
+		concurrent::DependencyGroup group;
+		for(usize i = 0; i != tasks_per_frame; ++i) {
+			pool.schedule([&sink, frame, i] { sink += frame + i; }, &group);
+		}
+		pool.process_until_complete(group);
+	}
+	state.set_items_per_run(tasks_per_frame);
+}
+
+}
@@ -0,0 +1,147 @@
+/*******************************
+Copyright (c) 2016-2020 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+
+
+#include <y/bench/bench.h>
+
+#include <y/core/HashMap.h>
+#include <y/core/SwissHashMap.h>
+#include <y/core/Vector.h>
+#include <y/math/random.h>
+
+#include <unordered_map>
+
+namespace {
+using namespace y;
+
+static core::Vector<u64> random_keys(usize count, u32 seed) {
+	math::FastRandom rng(seed);
+	core::Vector<u64> keys;
+	keys.set_min_capacity(count);
+	for(usize i = 0; i != count; ++i) {
+		keys << (u64(rng()) << 32 | rng());
+	}
+	return keys;
+}
+
+template<typename Map>
+static void bench_insert(bench::State& state) {
+	const core::Vector<u64> keys = random_keys(state.param(), 1);
+	while(state.run()) {
+		Map map;
+		for(const u64 k : keys) {
+			map.insert({k, k});
+		}
+		bench::do_not_optimize(map.size());
+	}
+	state.set_items_per_run(keys.size());
+}
+
+template<typename Map>
+static void bench_find(bench::State& state, bool hit) {
+	const core::Vector<u64> keys = random_keys(state.param(), 1);
+	const core::Vector<u64> missing = random_keys(state.param(), 2);
+
+	Map map;
+	for(const u64 k : keys) {
+		map.insert({k, k});
+	}
+
+	const core::Vector<u64>& lookups = hit ? keys : missing;
+	while(state.run()) {
+		u64 found = 0;
+		for(const u64 k : lookups) {
+			found += map.find(k) != map.end();
+		}
+		bench::do_not_optimize(found);
+	}
+	state.set_items_per_run(keys.size());
+}
+
+template<typename Map>
+static void bench_erase(bench::State& state) {
+	const core::Vector<u64> keys = random_keys(state.param(), 1);
+	while(state.run()) {
+		state.pause();
+		Map map;
+		for(const u64 k : keys) {
+			map.insert({k, k});
+		}
+		state.resume();
+
+		for(const u64 k : keys) {
+			map.erase(map.find(k));
+		}
+		bench::do_not_optimize(map.size());
+	}
+	state.set_items_per_run(keys.size());
+}
+
+y_bench_func("ExternalHashMap insert", 1024, 64 * 1024, 1024 * 1024, 10 * 1024 * 1024) {
+	bench_insert<core::ExternalHashMap<u64, u64>>(state);
+}
+
+y_bench_func("SwissHashMap insert", 1024, 64 * 1024, 1024 * 1024, 10 * 1024 * 1024) {
+	bench_insert<core::SwissHashMap<u64, u64>>(state);
+}
+
+y_bench_func("std::unordered_map insert", 1024, 64 * 1024, 1024 * 1024, 10 * 1024 * 1024) {
+	bench_insert<std::unordered_map<u64, u64>>(state);
+}
+
+y_bench_func("ExternalHashMap find hit", 1024, 64 * 1024, 1024 * 1024, 10 * 1024 * 1024) {
+	bench_find<core::ExternalHashMap<u64, u64>>(state, true);
+}
+
+y_bench_func("SwissHashMap find hit", 1024, 64 * 1024, 1024 * 1024, 10 * 1024 * 1024) {
+	bench_find<core::SwissHashMap<u64, u64>>(state, true);
+}
+
+y_bench_func("std::unordered_map find hit", 1024, 64 * 1024, 1024 * 1024, 10 * 1024 * 1024) {
+	bench_find<std::unordered_map<u64, u64>>(state, true);
+}
+
+y_bench_func("ExternalHashMap find miss", 1024, 64 * 1024, 1024 * 1024, 10 * 1024 * 1024) {
+	bench_find<core::ExternalHashMap<u64, u64>>(state, false);
+}
+
+y_bench_func("SwissHashMap find miss", 1024, 64 * 1024, 1024 * 1024, 10 * 1024 * 1024) {
+	bench_find<core::SwissHashMap<u64, u64>>(state, false);
+}
+
+y_bench_func("std::unordered_map find miss", 1024, 64 * 1024, 1024 * 1024, 10 * 1024 * 1024) {
+	bench_find<std::unordered_map<u64, u64>>(state, false);
+}
+
+y_bench_func("ExternalHashMap erase", 1024, 64 * 1024, 1024 * 1024, 10 * 1024 * 1024) {
+	bench_erase<core::ExternalHashMap<u64, u64>>(state);
+}
+
+y_bench_func("SwissHashMap erase", 1024, 64 * 1024, 1024 * 1024, 10 * 1024 * 1024) {
+	bench_erase<core::SwissHashMap<u64, u64>>(state);
+}
+
+y_bench_func("std::unordered_map erase", 1024, 64 * 1024, 1024 * 1024, 10 * 1024 * 1024) {
+	bench_erase<std::unordered_map<u64, u64>>(state);
+}
+
+}
@@ -0,0 +1,98 @@
+/*******************************
+Copyright (c) 2016-2020 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+
+
+#include <y/bench/bench.h>
+
+#include <y/core/Name.h>
+#include <y/core/HashMap.h>
+#include <y/core/String.h>
+#include <y/core/Vector.h>
+#include <y/utils/format.h>
+
+#include <map>
+
+namespace {
+using namespace y;
+
+// Looks like asset paths: long enough to not fit in the short string buffer
+static core::Vector<core::String> asset_names(usize count) {
+	core::Vector<core::String> names;
+	for(usize i = 0; i != count; ++i) {
+		names << core::String(fmt("assets/meshes/imported/mesh_%.mesh", i));
+	}
+	return names;
+}
+
+y_bench_func("Name lookup std::map<String>", 1024, 64 * 1024) {
+	const core::Vector<core::String> names = asset_names(state.param());
+
+	std::map<core::String, usize> map;
+	for(usize i = 0; i != names.size(); ++i) {
+		map[names[i]] = i;
+	}
+
+	while(state.run()) {
+		usize sum = 0;
+		for(const core::String& name : names) {
+			sum += map.find(std::string_view(name))->second;
+		}
+		bench::do_not_optimize(sum);
+	}
+	state.set_items_per_run(names.size());
+}
+
+y_bench_func("Name lookup ExternalHashMap<Name>", 1024, 64 * 1024) {
+	const core::Vector<core::String> names = asset_names(state.param());
+
+	core::ExternalHashMap<core::Name, usize> map;
+	for(usize i = 0; i != names.size(); ++i) {
+		map[core::Name(names[i])] = i;
+	}
+
+	while(state.run()) {
+		usize sum = 0;
+		for(const core::String& name : names) {
+			sum += map.find(*core::Name::find(name))->second;
+		}
+		bench::do_not_optimize(sum);
+	}
+	state.set_items_per_run(names.size());
+}
+
+y_bench_func("Name compare", 1024) {
+	const usize count = state.param();
+	core::Vector<core::Name> names;
+	for(usize i = 0; i != count; ++i) {
+		names << core::Name("This string is too long to fit in the short string buffer");
+	}
+	while(state.run()) {
+		usize equal = 0;
+		for(usize i = 1; i != count; ++i) {
+			equal += names[i] == names[i - 1];
+		}
+		bench::do_not_optimize(equal);
+	}
+	state.set_items_per_run(count);
+}
+
+}
@@ -0,0 +1,51 @@
+/*******************************
+Copyright (c) 2016-2020 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+
+
+#include <y/bench/bench.h>
+
+#include <y/core/RingQueue.h>
+
+namespace {
+using namespace y;
+
+y_bench_func("RingQueue push pop", 16, 1024) {
+	const usize capacity = state.param();
+	core::RingQueue<u64> queue(capacity);
+	const usize count = 64 * 1024;
+	while(state.run()) {
+		u64 sum = 0;
+		for(usize i = 0; i != count; ++i) {
+			if(queue.size() == capacity) {
+				sum += queue.pop();
+			}
+			queue.push(i);
+		}
+		while(!queue.is_empty()) {
+			sum += queue.pop();
+		}
+		bench::do_not_optimize(sum);
+	}
+	state.set_items_per_run(count);
+}
+
+}
@@ -0,0 +1,93 @@
+/*******************************
+Copyright (c) 2016-2020 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+
+
+#include <y/bench/bench.h>
+
+#include <y/core/SparseVector.h>
+
+namespace {
+using namespace y;
+
+using BenchSparseVector = core::SparseVector<u64, u32>;
+
+static BenchSparseVector filled(usize size) {
+	BenchSparseVector vec;
+	for(u32 i = 0; i != size; ++i) {
+		vec.insert(i * 3, i);
+	}
+	return vec;
+}
+
+y_bench_func("SparseVector insert", 1024, 64 * 1024) {
+	const usize size = state.param();
+	while(state.run()) {
+		const BenchSparseVector vec = filled(size);
+		bench::do_not_optimize(vec.size());
+	}
+	state.set_items_per_run(size);
+}
+
+y_bench_func("SparseVector lookup", 1024, 64 * 1024) {
+	const usize size = state.param();
+	const BenchSparseVector vec = filled(size);
+	while(state.run()) {
+		u64 sum = 0;
+		for(u32 i = 0; i != size * 3; ++i) {
+			if(vec.has(i)) {
+				sum += vec[i];
+			}
+		}
+		bench::do_not_optimize(sum);
+	}
+	state.set_items_per_run(size * 3);
+}
+
+y_bench_func("SparseVector iterate", 1024, 64 * 1024) {
+	const usize size = state.param();
+	const BenchSparseVector vec = filled(size);
+	while(state.run()) {
+		u64 sum = 0;
+		for(const auto& [index, value] : vec) {
+			sum += index + value;
+		}
+		bench::do_not_optimize(sum);
+	}
+	state.set_items_per_run(size);
+}
+
+y_bench_func("SparseVector erase", 1024, 64 * 1024) {
+	const usize size = state.param();
+	while(state.run()) {
+		state.pause();
+		BenchSparseVector vec = filled(size);
+		state.resume();
+
+		for(u32 i = 0; i != size; ++i) {
+			vec.erase(i * 3);
+		}
+		bench::do_not_optimize(vec.size());
+	}
+	state.set_items_per_run(size);
+}
+
+}
@@ -0,0 +1,142 @@
+/*******************************
+Copyright (c) 2016-2020 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+
+#include <y/bench/bench.h>
+
+#include <y/concurrent/StaticThreadPool.h>
+
+#include <list>
+
+namespace {
+using namespace y;
+
+// Reference implementation: the single mutex + list pool StaticThreadPool used before work stealing
+class MutexThreadPool : NonMovable {
+	public:
+		MutexThreadPool(usize thread_count) {
+			for(usize i = 0; i != thread_count; ++i) {
+				_threads.emplace_back([this] { worker(); });
+			}
+		}
+
+		~MutexThreadPool() {
+			{
+				const std::unique_lock lock(_lock);
+				_run = false;
+			}
+			_condition.notify_all();
+			for(auto& thread : _threads) {
+				thread.join();
+			}
+		}
+
+		void schedule(core::Function<void()>&& func) {
+			{
+				const std::unique_lock lock(_lock);
+				_queue.emplace_back(std::move(func));
+			}
+			_condition.notify_one();
+		}
+
+	private:
+		void worker() {
+			while(true) {
+				std::unique_lock lock(_lock);
+				_condition.wait(lock, [&] { return !_queue.empty() || !_run; });
+				if(!_run) {
+					break;
+				}
+				auto func = std::move(_queue.front());
+				_queue.pop_front();
+				lock.unlock();
+				func();
+			}
+		}
+
+		std::mutex _lock;
+		std::condition_variable _condition;
+		std::list<core::Function<void()>> _queue;
+		core::Vector<std::thread> _threads;
+		bool _run = true;
+};
+
+static void wait_for(const std::atomic<usize>& done, usize count) {
+	while(done != count) {
+		std::this_thread::yield();
+	}
+}
+
+// Tasks are scheduled from outside the pool, the parameter is the thread count
+template<typename Pool>
+static void bench_throughput(bench::State& state) {
+	static constexpr usize task_count = 4 * 1024;
+	static constexpr usize work_per_task = 64;
+
+	Pool pool(state.param());
+	std::atomic<usize> done = 0;
+	std::atomic<u64> sink = 0;
+	while(state.run()) {
+		done = 0;
+		for(usize i = 0; i != task_count; ++i) {
+			pool.schedule([&, i] {
+				u64 acc = i;
+				for(usize k = 0; k != work_per_task; ++k) {
+					acc = acc * 6364136223846793005ull + 1442695040888963407ull;
+				}
+				sink += acc;
+				++done;
+			});
+		}
+		wait_for(done, task_count);
+	}
+	state.set_items_per_run(task_count);
+}
+
+// Time between scheduling a single task and seeing it done
+template<typename Pool>
+static void bench_latency(bench::State& state) {
+	Pool pool(state.param());
+	std::atomic<usize> done = 0;
+	while(state.run()) {
+		done = 0;
+		pool.schedule([&] { ++done; });
+		wait_for(done, 1);
+	}
+}
+
+y_bench_func("MutexThreadPool throughput", 1, 4, 16, 64) {
+	bench_throughput<MutexThreadPool>(state);
+}
+
+y_bench_func("StaticThreadPool throughput", 1, 4, 16, 64) {
+	bench_throughput<concurrent::StaticThreadPool>(state);
+}
+
+y_bench_func("MutexThreadPool latency", 1, 4, 16, 64) {
+	bench_latency<MutexThreadPool>(state);
+}
+
+y_bench_func("StaticThreadPool latency", 1, 4, 16, 64) {
+	bench_latency<concurrent::StaticThreadPool>(state);
+}
+
+}
@@ -0,0 +1,84 @@
+/*******************************
+Copyright (c) 2016-2020 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+
+
+#include <y/bench/bench.h>
+
+#include <y/core/String.h>
+#include <y/core/Vector.h>
+
+namespace {
+using namespace y;
+
+static const char* long_string = "This string is too long to fit in the short string buffer";
+
+y_bench_func("String create short", 1024) {
+	const usize count = state.param();
+	while(state.run()) {
+		for(usize i = 0; i != count; ++i) {
+			const core::String str = "short";
+			bench::do_not_optimize(str.data());
+		}
+	}
+	state.set_items_per_run(count);
+}
+
+y_bench_func("String create long", 1024) {
+	const usize count = state.param();
+	while(state.run()) {
+		for(usize i = 0; i != count; ++i) {
+			const core::String str = long_string;
+			bench::do_not_optimize(str.data());
+		}
+	}
+	state.set_items_per_run(count);
+}
+
+y_bench_func("String append", 16, 1024) {
+	const usize count = state.param();
+	while(state.run()) {
+		core::String str;
+		for(usize i = 0; i != count; ++i) {
+			str += "abcd";
+		}
+		bench::do_not_optimize(str.data());
+	}
+	state.set_items_per_run(count);
+}
+
+y_bench_func("String compare", 1024) {
+	const usize count = state.param();
+	core::Vector<core::String> strings;
+	for(usize i = 0; i != count; ++i) {
+		strings << core::String(long_string);
+	}
+	while(state.run()) {
+		usize equal = 0;
+		for(usize i = 1; i != count; ++i) {
+			equal += strings[i] == strings[i - 1];
+		}
+		bench::do_not_optimize(equal);
+	}
+	state.set_items_per_run(count);
+}
+
+}
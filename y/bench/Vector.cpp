@@ -0,0 +1,112 @@
+/*******************************
+Copyright (c) 2016-2020 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+
+
+#include <y/bench/bench.h>
+
+#include <y/core/Vector.h>
+
+namespace {
+using namespace y;
+
+y_bench_func("Vector push_back", 16, 1024, 64 * 1024) {
+	const usize size = state.param();
+	while(state.run()) {
+		core::Vector<u32> vec;
+		for(usize i = 0; i != size; ++i) {
+			vec << u32(i);
+		}
+		bench::do_not_optimize(vec.data());
+	}
+	state.set_items_per_run(size);
+}
+
+y_bench_func("Vector reserve push_back", 16, 1024, 64 * 1024) {
+	const usize size = state.param();
+	while(state.run()) {
+		core::Vector<u32> vec;
+		vec.set_min_capacity(size);
+		for(usize i = 0; i != size; ++i) {
+			vec << u32(i);
+		}
+		bench::do_not_optimize(vec.data());
+	}
+	state.set_items_per_run(size);
+}
+
+y_bench_func("Vector iterate", 1024, 64 * 1024) {
+	const usize size = state.param();
+	const core::Vector<u32> vec(size, 7);
+	while(state.run()) {
+		u32 sum = 0;
+		for(const u32 i : vec) {
+			sum += i;
+		}
+		bench::do_not_optimize(sum);
+	}
+	state.set_items_per_run(size);
+}
+
+y_bench_func("Vector erase_unordered", 1024, 64 * 1024) {
+	const usize size = state.param();
+	while(state.run()) {
+		state.pause();
+		core::Vector<u32> vec(size, 7);
+		state.resume();
+
+		while(!vec.is_empty()) {
+			vec.erase_unordered(vec.begin() + vec.size() / 2);
+		}
+		bench::do_not_optimize(vec.data());
+	}
+	state.set_items_per_run(size);
+}
+
+// Many short lived vectors, like the temporaries built on every submit
+template<typename Vec>
+static void bench_temporaries(bench::State& state) {
+	const usize size = state.param();
+	static constexpr usize vector_count = 1024;
+	while(state.run()) {
+		u32 sum = 0;
+		for(usize k = 0; k != vector_count; ++k) {
+			Vec vec;
+			vec.set_min_capacity(size);
+			for(usize i = 0; i != size; ++i) {
+				vec << u32(i + k);
+			}
+			sum += vec.last();
+		}
+		bench::do_not_optimize(sum);
+	}
+	state.set_items_per_run(vector_count);
+}
+
+y_bench_func("Vector temporaries", 2, 8, 32) {
+	bench_temporaries<core::Vector<u32>>(state);
+}
+
+y_bench_func("SmallVector temporaries", 2, 8, 32) {
+	bench_temporaries<core::SmallVector<u32, 8>>(state);
+}
+
+}
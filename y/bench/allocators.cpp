@@ -0,0 +1,207 @@
+/*******************************
+Copyright (c) 2016-2020 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+
+
+#include <y/bench/bench.h>
+
+#include <y/mem/memory.h>
+#include <y/mem/allocators.h>
+#include <y/mem/ThreadCachingAllocator.h>
+#include <y/mem/FrameArena.h>
+#include <y/mem/ChunkAllocator.h>
+#include <y/core/Vector.h>
+#include <y/math/random.h>
+
+#include <array>
+#include <thread>
+#include <cstdlib>
+
+namespace {
+using namespace y;
+
+static constexpr usize allocation_count = 4 * 1024;
+
+template<typename Alloc, typename Free>
+static void bench_alloc_free(bench::State& state, usize count, Alloc&& alloc, Free&& free) {
+	const usize size = state.param();
+	core::Vector<void*> ptrs(count, nullptr);
+	while(state.run()) {
+		for(void*& ptr : ptrs) {
+			ptr = alloc(size);
+		}
+		for(void* ptr : ptrs) {
+			free(ptr, size);
+		}
+		bench::do_not_optimize(ptrs.data());
+	}
+	state.set_items_per_run(count);
+}
+
+y_bench_func("malloc free", 16, 256, 4 * 1024) {
+	bench_alloc_free(state, allocation_count, [](usize size) { return std::malloc(size); }, [](void* ptr, usize) { std::free(ptr); });
+}
+
+y_bench_func("global allocator", 16, 256, 4 * 1024) {
+	bench_alloc_free(state, allocation_count, [](usize size) { return memory::global_allocator()->allocate(size); }, [](void* ptr, usize size) { memory::global_allocator()->deallocate(ptr, size); });
+}
+
+y_bench_func("ChunkAllocator", 16 * 1024, 64 * 1024) {
+	memory::ChunkAllocator allocator;
+	bench_alloc_free(state, 256, [&](usize size) { return allocator.allocate(size); }, [&](void* ptr, usize size) { allocator.deallocate(ptr, size); });
+}
+
+y_bench_func("FrameArena", 16, 256, 4 * 1024) {
+	const usize size = state.param();
+	memory::FrameArena arena;
+	while(state.run()) {
+		for(usize i = 0; i != allocation_count; ++i) {
+			bench::do_not_optimize(arena.allocate(size));
+		}
+		arena.reset();
+	}
+	state.set_items_per_run(allocation_count);
+}
+
+
+// Every thread replaces random entries of its own live set, the parameter is the thread count
+template<typename Allocator>
+static void bench_allocator_churn(bench::State& state) {
+	static constexpr usize live_count = 256;
+	static constexpr usize op_count = 64 * 1024;
+
+	Allocator allocator;
+	const auto churn = [&](usize index) {
+		std::pair<void*, usize> live[live_count] = {};
+		math::FastRandom rng(static_cast<u32>(index));
+		for(usize i = 0; i != op_count; ++i) {
+			auto& [ptr, size] = live[rng() % live_count];
+			allocator.deallocate(ptr, size);
+			size = 8 + rng() % 504;
+			ptr = allocator.allocate(size);
+		}
+		for(auto& [ptr, size] : live) {
+			allocator.deallocate(ptr, size);
+		}
+	};
+
+	const usize thread_count = state.param();
+	while(state.run()) {
+		core::Vector<std::thread> threads;
+		for(usize i = 0; i != thread_count; ++i) {
+			threads.emplace_back(churn, i);
+		}
+		for(auto& thread : threads) {
+			thread.join();
+		}
+	}
+	state.set_items_per_run(op_count * thread_count);
+}
+
+y_bench_func("mutex leak detector churn", 1, 2, 4, 8) {
+	bench_allocator_churn<memory::ThreadSafeAllocator<memory::LeakDetectorAllocator<memory::Mallocator>>>(state);
+}
+
+y_bench_func("malloc churn", 1, 2, 4, 8) {
+	bench_allocator_churn<memory::Mallocator>(state);
+}
+
+y_bench_func("ThreadCachingAllocator churn", 1, 2, 4, 8) {
+	bench_allocator_churn<memory::ThreadCachingAllocator>(state);
+}
+
+
+// Chunks are touched like an archetype would when it constructs its components, the parameter is the chunk size
+template<typename Allocator>
+static void bench_chunk_churn(bench::State& state) {
+	static constexpr usize live_count = 64;
+	static constexpr usize op_count = 16 * 1024;
+
+	const usize chunk_size = state.param();
+	Allocator allocator;
+	void* live[live_count] = {};
+	math::FastRandom rng;
+	while(state.run()) {
+		for(usize i = 0; i != op_count; ++i) {
+			void*& ptr = live[rng() % live_count];
+			allocator.deallocate(ptr, chunk_size);
+			ptr = allocator.allocate(chunk_size);
+			static_cast<u8*>(ptr)[(i * 4096) % chunk_size] = u8(i);
+		}
+	}
+	for(void* ptr : live) {
+		allocator.deallocate(ptr, chunk_size);
+	}
+	state.set_items_per_run(op_count);
+}
+
+y_bench_func("malloc chunk churn", 16 * 1024, 80 * 1024, 256 * 1024) {
+	bench_chunk_churn<memory::Mallocator>(state);
+}
+
+y_bench_func("ThreadCachingAllocator chunk churn", 16 * 1024, 80 * 1024, 256 * 1024) {
+	bench_chunk_churn<memory::ThreadCachingAllocator>(state);
+}
+
+y_bench_func("ChunkAllocator chunk churn", 16 * 1024, 80 * 1024, 256 * 1024) {
+	bench_chunk_churn<memory::ChunkAllocator>(state);
+}
+
+
+// A frame worth of short lived vectors, the arena is reset at the end of every frame
+template<typename Vec, typename F>
+static void bench_transient_vectors(bench::State& state, F&& create_vector) {
+	static constexpr usize vectors_per_frame = 200;
+	static constexpr usize elements_per_vector = 24;
+
+	for(u64 frame = 0; state.run(); ++frame) {
+		for(usize v = 0; v != vectors_per_frame; ++v) {
+			Vec vec = create_vector();
+			for(usize i = 0; i != elements_per_vector; ++i) {
+				vec.emplace_back(std::array<u64, 4>{frame, v, i, 0});
+			}
+			bench::do_not_optimize(vec.data());
+		}
+		create_vector.reset();
+	}
+	state.set_items_per_run(vectors_per_frame);
+}
+
+y_bench_func("transient Vector") {
+	using Elem = std::array<u64, 4>;
+	struct {
+		core::Vector<Elem> operator()() { return {}; }
+		void reset() {}
+	} global;
+	bench_transient_vectors<core::Vector<Elem>>(state, global);
+}
+
+y_bench_func("transient FrameVector") {
+	using Elem = std::array<u64, 4>;
+	struct {
+		memory::FrameArena arena;
+		memory::FrameVector<Elem> operator()() { return memory::FrameVector<Elem>(memory::FrameArenaAllocator(arena)); }
+		void reset() { arena.reset(); }
+	} frame;
+	bench_transient_vectors<memory::FrameVector<Elem>>(state, frame);
+}
+
+}
@@ -0,0 +1,87 @@
+/*******************************
+Copyright (c) 2016-2020 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+
+
+#include <y/bench/bench.h>
+
+#include <y/utils/format.h>
+#include <y/core/String.h>
+
+#include <cstdio>
+
+namespace {
+using namespace y;
+
+static constexpr usize fmt_count = 1024;
+
+y_bench_func("fmt ints") {
+	while(state.run()) {
+		for(usize i = 0; i != fmt_count; ++i) {
+			bench::do_not_optimize(fmt("% % %", i, -int(i), i * 1000003).data());
+		}
+	}
+	state.set_items_per_run(fmt_count);
+}
+
+y_bench_func("fmt floats") {
+	while(state.run()) {
+		for(usize i = 0; i != fmt_count; ++i) {
+			bench::do_not_optimize(fmt("% %", float(i) * 0.25f, double(i) / 3.0).data());
+		}
+	}
+	state.set_items_per_run(fmt_count);
+}
+
+y_bench_func("fmt entity label") {
+	const core::String name = "Some entity name";
+	while(state.run()) {
+		for(usize i = 0; i != fmt_count; ++i) {
+			bench::do_not_optimize(fmt("% %##%", "icon", name, i).data());
+		}
+	}
+	state.set_items_per_run(fmt_count);
+}
+
+y_bench_func("fmt entity label constexpr fmt_to") {
+	static constexpr FmtString label_fmt = "% %##%";
+	const core::String name = "Some entity name";
+	char label[256];
+	while(state.run()) {
+		for(usize i = 0; i != fmt_count; ++i) {
+			bench::do_not_optimize(fmt_to(label, label_fmt, "icon", name, i).data());
+		}
+	}
+	state.set_items_per_run(fmt_count);
+}
+
+y_bench_func("fmt snprintf ints") {
+	char buffer[256];
+	while(state.run()) {
+		for(usize i = 0; i != fmt_count; ++i) {
+			std::snprintf(buffer, sizeof(buffer), "%zu %d %zu", i, -int(i), i * 1000003);
+			bench::do_not_optimize(buffer);
+		}
+	}
+	state.set_items_per_run(fmt_count);
+}
+
+}
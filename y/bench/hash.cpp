@@ -0,0 +1,115 @@
+/*******************************
+Copyright (c) 2016-2020 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+
+
+#include <y/bench/bench.h>
+
+#include <y/utils/hash.h>
+#include <y/core/Vector.h>
+
+#include <string_view>
+
+namespace {
+using namespace y;
+
+// Same layout as VkDescriptorSetLayoutBinding
+struct LayoutBinding {
+	u32 binding;
+	u32 descriptor_type;
+	u32 descriptor_count;
+	u32 stage_flags;
+	const void* immutable_samplers;
+};
+
+static core::Vector<LayoutBinding> layout_bindings(usize count) {
+	core::Vector<LayoutBinding> bindings;
+	for(usize i = 0; i != count; ++i) {
+		bindings << LayoutBinding{u32(i), u32(i % 11), 1, 0x1F, nullptr};
+	}
+	return bindings;
+}
+
+static constexpr usize layout_hash_count = 256;
+
+// What std::hash<VkDescriptorSetLayoutBinding> used to do
+static usize char_hash(const LayoutBinding& binding) {
+	const char* data = reinterpret_cast<const char*>(&binding);
+	usize h = 0;
+	for(usize i = 0; i != sizeof(binding); ++i) {
+		hash_combine(h, hash(data[i]));
+	}
+	return h;
+}
+
+y_bench_func("hash layout bindings per char", 1, 8, 32) {
+	const core::Vector<LayoutBinding> bindings = layout_bindings(state.param());
+	while(state.run()) {
+		for(usize i = 0; i != layout_hash_count; ++i) {
+			usize h = 0;
+			for(const LayoutBinding& b : bindings) {
+				hash_combine(h, char_hash(b));
+			}
+			bench::do_not_optimize(h);
+		}
+	}
+	state.set_items_per_run(layout_hash_count);
+}
+
+y_bench_func("hash layout bindings hash_range", 1, 8, 32) {
+	const core::Vector<LayoutBinding> bindings = layout_bindings(state.param());
+	while(state.run()) {
+		for(usize i = 0; i != layout_hash_count; ++i) {
+			bench::do_not_optimize(hash_range(bindings));
+		}
+	}
+	state.set_items_per_run(layout_hash_count);
+}
+
+y_bench_func("hash_bytes", 8, 64, 1024, 64 * 1024) {
+	const core::Vector<u8> bytes(state.param(), u8(7));
+	while(state.run()) {
+		bench::do_not_optimize(hash_bytes(bytes.data(), bytes.size()));
+	}
+	state.set_items_per_run(bytes.size());
+}
+
+y_bench_func("hash std::hash<string_view>", 8, 64, 1024, 64 * 1024) {
+	const core::Vector<char> bytes(state.param(), char(7));
+	while(state.run()) {
+		bench::do_not_optimize(std::hash<std::string_view>()(std::string_view(bytes.data(), bytes.size())));
+	}
+	state.set_items_per_run(bytes.size());
+}
+
+y_bench_func("hash BytesHasher 16 byte pieces", 1024, 64 * 1024) {
+	const core::Vector<u8> bytes(state.param(), u8(7));
+	while(state.run()) {
+		BytesHasher hasher;
+		for(usize i = 0; i != bytes.size(); i += 16) {
+			hasher.add(bytes.data() + i, 16);
+		}
+		bench::do_not_optimize(hasher.hash());
+	}
+	state.set_items_per_run(bytes.size());
+}
+
+}
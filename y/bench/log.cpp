@@ -0,0 +1,71 @@
+/*******************************
+Copyright (c) 2016-2020 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+
+
+#include <y/bench/bench.h>
+
+#include <y/utils/log.h>
+
+#include <thread>
+#include <chrono>
+
+namespace {
+using namespace y;
+
+static constexpr usize log_count = 256;
+
+// Stands in for a file or editor sink
+static bool slow_sink(std::string_view msg, Log, void*) {
+	const auto end = std::chrono::steady_clock::now() + std::chrono::microseconds(2);
+	while(std::chrono::steady_clock::now() < end) {
+		bench::do_not_optimize(msg.data());
+	}
+	return true;
+}
+
+y_bench_func("log sync slow sink") {
+	set_log_callback(&slow_sink);
+	while(state.run()) {
+		for(usize i = 0; i != log_count; ++i) {
+			log_msg("Loading asset from the thumbnail worker", Log::Debug);
+		}
+	}
+	set_log_callback(nullptr);
+	state.set_items_per_run(log_count);
+}
+
+y_bench_func("log async slow sink") {
+	set_log_callback(&slow_sink);
+	AsyncLogSettings settings;
+	settings.ring_size = 1024 * 1024;
+	start_async_logging(settings);
+	while(state.run()) {
+		for(usize i = 0; i != log_count; ++i) {
+			log_msg("Loading asset from the thumbnail worker", Log::Debug);
+		}
+	}
+	stop_async_logging();
+	set_log_callback(nullptr);
+	state.set_items_per_run(log_count);
+}
+
+}
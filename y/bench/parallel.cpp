@@ -0,0 +1,68 @@
+/*******************************
+Copyright (c) 2016-2020 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+
+#include <y/bench/bench.h>
+
+#include <y/concurrent/parallel.h>
+#include <y/core/Vector.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+using namespace y;
+
+static constexpr usize element_count = 1024 * 1024;
+static constexpr usize grain = 1024;
+
+static const auto transform = [](float& f) { f = std::sqrt(f * f + 1.0f) * 0.5f; };
+
+y_bench_func("for_each sqrt") {
+	core::Vector<float> values(element_count, 1.0f);
+	while(state.run()) {
+		std::for_each(values.begin(), values.end(), transform);
+		bench::do_not_optimize(values.data());
+	}
+	state.set_items_per_run(element_count);
+}
+
+// The parameter is the thread count, 0 runs everything on the calling thread
+y_bench_func("parallel_for sqrt", 0, 1, 2, 4, 8, 16) {
+	concurrent::StaticThreadPool pool(state.param());
+	core::Vector<float> values(element_count, 1.0f);
+	while(state.run()) {
+		concurrent::parallel_for(values, grain, transform, pool);
+		bench::do_not_optimize(values.data());
+	}
+	state.set_items_per_run(element_count);
+}
+
+y_bench_func("parallel_reduce sum", 0, 1, 2, 4, 8, 16) {
+	concurrent::StaticThreadPool pool(state.param());
+	const core::Vector<float> values(element_count, 1.0f);
+	while(state.run()) {
+		bench::do_not_optimize(concurrent::parallel_reduce(values, grain, 0.0f, std::plus<float>(), std::plus<float>(), pool));
+	}
+	state.set_items_per_run(element_count);
+}
+
+}
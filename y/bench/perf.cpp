@@ -0,0 +1,113 @@
+/*******************************
+Copyright (c) 2016-2020 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+
+#include <y/bench/bench.h>
+
+#include <y/utils/perf.h>
+#include <y/core/String.h>
+
+#include <cstdio>
+
+namespace {
+using namespace y;
+
+// Small enough to fit in the per thread ring buffers
+static constexpr usize pairs_per_run = 2 * 1024;
+
+static const char* capture_filename = "y_perf_bench_capture.json";
+
+static void record_zones(bench::State& state) {
+	const perf::ZoneId outer = perf::zone_id("bench outer");
+	const perf::ZoneId inner = perf::zone_id("bench inner");
+
+	while(state.run()) {
+		for(usize i = 0; i != pairs_per_run / 2; ++i) {
+			const perf::ScopedZone o(outer);
+			const perf::ScopedZone n(inner);
+		}
+
+		// Leave time for the flusher so that nothing is dropped
+		if(perf::is_capturing()) {
+			state.pause();
+			core::Duration::sleep(core::Duration::milliseconds(10));
+			state.resume();
+		}
+	}
+	state.set_items_per_run(pairs_per_run);
+}
+
+static void remove_capture() {
+	std::remove(capture_filename);
+	std::remove((core::String(capture_filename) + ".bin").data());
+}
+
+y_bench_func("perf zones disabled") {
+	const bool stats_enabled = perf::zone_stats_enabled();
+	perf::set_zone_stats_enabled(false);
+	record_zones(state);
+	perf::set_zone_stats_enabled(stats_enabled);
+}
+
+y_bench_func("perf zones stats") {
+	const bool stats_enabled = perf::zone_stats_enabled();
+	perf::set_zone_stats_enabled(true);
+	record_zones(state);
+	perf::end_frame();
+	perf::set_zone_stats_enabled(stats_enabled);
+}
+
+y_bench_func("perf zones flight recorder") {
+	const bool stats_enabled = perf::zone_stats_enabled();
+	perf::set_zone_stats_enabled(false);
+	perf::start_flight_recorder();
+	record_zones(state);
+	perf::stop_flight_recorder();
+	perf::set_zone_stats_enabled(stats_enabled);
+}
+
+y_bench_func("perf zones capture") {
+	const bool stats_enabled = perf::zone_stats_enabled();
+	perf::set_zone_stats_enabled(false);
+	perf::start_capture(capture_filename);
+	record_zones(state);
+	perf::end_capture();
+	perf::set_zone_stats_enabled(stats_enabled);
+	remove_capture();
+}
+
+// Time to stop a capture and convert it to JSON
+y_bench_func("perf end capture") {
+	const perf::ZoneId zone = perf::zone_id("bench capture");
+	while(state.run()) {
+		state.pause();
+		perf::start_capture(capture_filename);
+		for(usize i = 0; i != pairs_per_run; ++i) {
+			const perf::ScopedZone z(zone);
+		}
+		state.resume();
+
+		perf::end_capture();
+	}
+	remove_capture();
+}
+
+}
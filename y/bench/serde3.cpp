@@ -0,0 +1,90 @@
+/*******************************
+Copyright (c) 2016-2020 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+
+
+#include <y/bench/bench.h>
+
+#include <y/serde3/archives.h>
+#include <y/io2/Buffer.h>
+#include <y/core/Vector.h>
+#include <y/core/String.h>
+
+namespace {
+using namespace y;
+
+struct Item {
+	u32 id = 0;
+	float weight = 0.0f;
+	core::String name;
+
+	y_serde3(id, weight, name)
+};
+
+struct Inventory {
+	core::Vector<Item> items;
+	core::Vector<u32> counts;
+
+	y_serde3(items, counts)
+};
+
+static Inventory create_inventory(usize size) {
+	Inventory inventory;
+	for(usize i = 0; i != size; ++i) {
+		inventory.items << Item{u32(i), float(i) * 0.5f, "item"};
+		inventory.counts << u32(i);
+	}
+	return inventory;
+}
+
+y_bench_func("serde3 serialize", 16, 1024) {
+	const usize size = state.param();
+	const Inventory inventory = create_inventory(size);
+	while(state.run()) {
+		io2::Buffer buffer;
+		serde3::WritableArchive arc(buffer);
+		y_always_assert(arc.serialize(inventory), "Serialization failed");
+		bench::do_not_optimize(buffer.size());
+	}
+	state.set_items_per_run(size);
+}
+
+y_bench_func("serde3 round trip", 16, 1024) {
+	const usize size = state.param();
+	const Inventory inventory = create_inventory(size);
+	while(state.run()) {
+		io2::Buffer buffer;
+		{
+			serde3::WritableArchive arc(buffer);
+			y_always_assert(arc.serialize(inventory), "Serialization failed");
+		}
+
+		buffer.reset();
+
+		Inventory read;
+		serde3::ReadableArchive arc(buffer);
+		y_always_assert(arc.deserialize(read), "Deserialization failed");
+		bench::do_not_optimize(read.items.data());
+	}
+	state.set_items_per_run(size);
+}
+
+}
@@ -0,0 +1,107 @@
+/*******************************
+Copyright (c) 2016-2020 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+
+
+#include <y/bench/bench.h>
+
+#include <y/utils/sort.h>
+#include <y/concurrent/parallel.h>
+#include <y/core/Vector.h>
+#include <y/math/random.h>
+
+#include <algorithm>
+
+namespace {
+using namespace y;
+
+struct DrawItem {
+	u64 sort_key;
+	u32 instance;
+	u32 material;
+};
+
+template<typename T>
+static core::Vector<T> random_values(usize count) {
+	math::FastRandom rng(1);
+	core::Vector<T> values;
+	values.set_min_capacity(count);
+	for(usize i = 0; i != count; ++i) {
+		const u64 r = u64(rng()) << 32 | rng();
+		if constexpr(std::is_same_v<T, DrawItem>) {
+			values << DrawItem{r, u32(i), u32(r)};
+		} else {
+			values << T(r);
+		}
+	}
+	return values;
+}
+
+template<typename T, typename F>
+static void bench_sort(bench::State& state, F&& sort_func) {
+	const core::Vector<T> values = random_values<T>(state.param());
+	core::Vector<T> sorted;
+	while(state.run()) {
+		state.pause();
+		sorted = values;
+		state.resume();
+
+		sort_func(sorted.begin(), sorted.end());
+		bench::do_not_optimize(sorted.data());
+	}
+	state.set_items_per_run(values.size());
+}
+
+static const auto draw_key = [](const DrawItem& item) { return item.sort_key; };
+
+y_bench_func("sort std::sort u32", 1024, 64 * 1024, 1024 * 1024, 16 * 1024 * 1024, 100 * 1000 * 1000) {
+	bench_sort<u32>(state, [](auto b, auto e) { std::sort(b, e); });
+}
+
+y_bench_func("sort pdqsort u32", 1024, 64 * 1024, 1024 * 1024, 16 * 1024 * 1024, 100 * 1000 * 1000) {
+	bench_sort<u32>(state, [](auto b, auto e) { y::sort(b, e, std::less<>()); });
+}
+
+y_bench_func("sort y::sort u32", 1024, 64 * 1024, 1024 * 1024, 16 * 1024 * 1024, 100 * 1000 * 1000) {
+	bench_sort<u32>(state, [](auto b, auto e) { y::sort(b, e); });
+}
+
+y_bench_func("sort parallel_sort u32", 1024, 64 * 1024, 1024 * 1024, 16 * 1024 * 1024, 100 * 1000 * 1000) {
+	bench_sort<u32>(state, [](auto b, auto e) { concurrent::parallel_sort(b, e); });
+}
+
+y_bench_func("sort pdqsort u64", 1024, 64 * 1024, 1024 * 1024, 16 * 1024 * 1024) {
+	bench_sort<u64>(state, [](auto b, auto e) { y::sort(b, e, std::less<>()); });
+}
+
+y_bench_func("sort y::sort u64", 1024, 64 * 1024, 1024 * 1024, 16 * 1024 * 1024) {
+	bench_sort<u64>(state, [](auto b, auto e) { y::sort(b, e); });
+}
+
+y_bench_func("sort pdqsort draw items", 1024, 64 * 1024, 1024 * 1024) {
+	bench_sort<DrawItem>(state, [](auto b, auto e) { y::sort(b, e, [](const DrawItem& a, const DrawItem& c) { return a.sort_key < c.sort_key; }); });
+}
+
+y_bench_func("sort y::sort draw items by key", 1024, 64 * 1024, 1024 * 1024) {
+	bench_sort<DrawItem>(state, [](auto b, auto e) { y::sort(b, e, draw_key); });
+}
+
+}
@@ -0,0 +1,346 @@
+/*******************************
+Copyright (c) 2016-2020 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+
+
+#include <y/test/test.h>
+#include <y/ecs/EntityWorld.h>
+#include <y/ecs/Query.h>
+#include <y/core/Vector.h>
+#include <y/math/random.h>
+
+#include <atomic>
+
+namespace {
+using namespace y;
+
+struct Position {
+	usize value = 0;
+};
+
+struct Velocity {
+	float x = 1.0f;
+};
+
+struct Tag {
+	u32 value = 7;
+};
+
+// Not trivially copyable: migrations have to move construct and destroy it
+struct Counted {
+	static inline isize live = 0;
+
+	core::Vector<usize> values = {usize(7)};
+
+	Counted() {
+		++live;
+	}
+
+	Counted(Counted&& other) : values(std::move(other.values)) {
+		++live;
+	}
+
+	Counted& operator=(Counted&& other) {
+		values = std::move(other.values);
+		return *this;
+	}
+
+	~Counted() {
+		--live;
+	}
+};
+
+static core::Vector<ecs::EntityID> create_entities(ecs::EntityWorld& world, usize count) {
+	core::Vector<ecs::EntityID> ids;
+	for(usize i = 0; i != count; ++i) {
+		const ecs::EntityID id = world.create_entity();
+		world.add_components<Position, Velocity>(id);
+		world.component<Position>(id)->value = i;
+		ids << id;
+	}
+	return ids;
+}
+
+static bool check_positions(const ecs::EntityWorld& world, core::Span<ecs::EntityID> ids) {
+	for(const ecs::EntityID id : ids) {
+		const Position* pos = world.component<Position>(id);
+		if(!pos || pos->value != id.index()) {
+			return false;
+		}
+	}
+	return true;
+}
+
+y_test_func("EntityWorld remove in any order") {
+	ecs::EntityWorld world;
+	core::Vector<ecs::EntityID> ids = create_entities(world, 3000);
+
+	math::FastRandom rng;
+	for(usize i = 0; i != 2000; ++i) {
+		const usize index = rng() % ids.size();
+		world.remove_entity(ids[index]);
+		ids.erase_unordered(ids.begin() + index);
+	}
+
+	y_test_assert(check_positions(world, ids));
+	y_test_assert(world.archetypes()[0]->entity_count() == ids.size());
+}
+
+y_test_func("EntityWorld add and remove components") {
+	ecs::EntityWorld world;
+	const core::Vector<ecs::EntityID> ids = create_entities(world, 3000);
+
+	for(usize i = 0; i != ids.size(); i += 2) {
+		world.add_component<Tag>(ids[i]);
+	}
+	y_test_assert(world.archetypes().size() == 2);
+	y_test_assert(check_positions(world, ids));
+
+	for(usize i = 0; i != ids.size(); ++i) {
+		const Tag* tag = world.component<Tag>(ids[i]);
+		y_test_assert((tag != nullptr) == (i % 2 == 0));
+		y_test_assert(!tag || tag->value == 7);
+	}
+
+	// Removing a component the entity doesn't have does nothing
+	for(const ecs::EntityID id : ids) {
+		world.remove_component<Tag>(id);
+	}
+	y_test_assert(world.archetypes().size() == 2);
+	y_test_assert(world.archetypes()[1]->entity_count() == 0);
+	y_test_assert(check_positions(world, ids));
+
+	world.remove_components<Velocity, Position>(ids[0]);
+	y_test_assert(world.exists(ids[0]));
+	y_test_assert(!world.component<Position>(ids[0]));
+	y_test_assert(check_positions(world, core::Span<ecs::EntityID>(ids.begin() + 1, ids.size() - 1)));
+}
+
+y_test_func("EntityWorld archetype reuse") {
+	ecs::EntityWorld world;
+
+	const ecs::EntityID a = world.create_entity();
+	world.add_component<Tag>(a);
+	world.add_component<Position>(a);
+
+	const ecs::EntityID b = world.create_entity();
+	world.add_components<Position, Tag>(b);
+
+	const ecs::EntityID c = world.create_entity();
+	world.add_components<Position, Tag, Velocity>(c);
+	world.remove_component<Velocity>(c);
+
+	// {Tag}, {Position, Tag} and {Position, Tag, Velocity}
+	y_test_assert(world.archetypes().size() == 3);
+	y_test_assert(world.archetypes()[1]->entity_count() == 3);
+}
+
+y_test_func("EntityWorld batches") {
+	ecs::EntityWorld world;
+	core::Vector<ecs::EntityID> ids = world.create_entities<Position, Velocity>(3000);
+	y_test_assert(world.archetypes().size() == 1);
+	y_test_assert(world.archetypes()[0]->entity_count() == ids.size());
+	for(const ecs::EntityID id : ids) {
+		world.component<Position>(id)->value = id.index();
+	}
+
+	// Some entities already have a tag, so the batch spans two archetypes
+	for(usize i = 0; i < ids.size(); i += 3) {
+		world.add_component<Tag>(ids[i]);
+	}
+	core::Vector<ecs::EntityID> untagged;
+	for(usize i = 0; i != ids.size(); ++i) {
+		if(i % 3) {
+			untagged << ids[i];
+		}
+	}
+	world.add_components<Velocity>(core::Vector<ecs::EntityID>());
+	// Duplicated ids are only moved once
+	untagged << untagged[0] << untagged.last();
+	world.add_components<Tag>(untagged);
+	y_test_assert(world.archetypes()[1]->entity_count() == ids.size());
+	y_test_assert(check_positions(world, ids));
+
+	math::FastRandom rng;
+	core::Vector<ecs::EntityID> removed;
+	for(usize i = 0; i != 2000; ++i) {
+		const usize index = rng() % ids.size();
+		removed << ids[index];
+		ids.erase_unordered(ids.begin() + index);
+	}
+	removed << removed[0];
+	world.remove_entities(removed);
+
+	for(const ecs::EntityID id : removed) {
+		y_test_assert(!world.exists(id));
+	}
+	y_test_assert(world.archetypes()[1]->entity_count() == ids.size());
+	y_test_assert(check_positions(world, ids));
+}
+
+y_test_func("EntityWorld migrate non trivial components") {
+	{
+		ecs::EntityWorld world;
+		core::Vector<ecs::EntityID> ids = world.create_entities<Position, Counted>(3000);
+		for(const ecs::EntityID id : ids) {
+			world.component<Position>(id)->value = id.index();
+			world.component<Counted>(id)->values << id.index();
+		}
+		y_test_assert(Counted::live == 3000);
+
+		core::Vector<ecs::EntityID> odd;
+		for(usize i = 1; i < ids.size(); i += 2) {
+			odd << ids[i];
+		}
+		world.add_components<Tag>(odd);
+		world.remove_component<Counted>(ids[0]);
+		world.remove_components<Counted, Tag>(ids[1]);
+		y_test_assert(Counted::live == 2998);
+
+		world.remove_entities(core::Span<ecs::EntityID>(ids.begin() + 100, 1000));
+		y_test_assert(Counted::live == 1998);
+
+		y_test_assert(check_positions(world, core::Span<ecs::EntityID>(ids.begin(), 100)));
+		y_test_assert(check_positions(world, core::Span<ecs::EntityID>(ids.begin() + 1100, ids.size() - 1100)));
+		for(usize i = 2; i != ids.size(); ++i) {
+			if(i >= 100 && i < 1100) {
+				continue;
+			}
+			const Counted* counted = world.component<Counted>(ids[i]);
+			y_test_assert(counted && counted->values.size() == 2 && counted->values[1] == ids[i].index());
+		}
+	}
+	y_test_assert(Counted::live == 0);
+}
+
+y_test_func("EntityWorld parallel chunks") {
+	concurrent::StaticThreadPool pool(4);
+
+	ecs::EntityWorld world;
+	const core::Vector<ecs::EntityID> ids = create_entities(world, 5000);
+	for(usize i = 0; i < ids.size(); i += 3) {
+		world.add_component<Tag>(ids[i]);
+	}
+
+	const auto view = world.view<Position, const Velocity>();
+
+	std::atomic<usize> entity_count = 0;
+	std::atomic<usize> chunk_count = 0;
+	view.for_each_chunk_parallel([&](const ecs::ComponentChunk<Position, const Velocity>& chunk) {
+		y_test_assert(chunk.size() && chunk.size() <= ecs::entities_per_chunk);
+		entity_count += chunk.size();
+		++chunk_count;
+	}, pool);
+	y_test_assert(entity_count == ids.size());
+	y_test_assert(chunk_count == view.chunk_count());
+	y_test_assert(chunk_count > 2);
+
+	// Disjoint writes: each thread only touches the entities of its chunks
+	world.view<Position, Tag>().par_each([](Position& pos, Tag& tag) {
+		pos.value += tag.value;
+	}, pool);
+	world.view<Position>().par_each([](Position& pos) {
+		pos.value *= 2;
+	}, pool);
+
+	for(usize i = 0; i != ids.size(); ++i) {
+		const usize expected = (i % 3 ? i : i + 7) * 2;
+		y_test_assert(world.component<Position>(ids[i])->value == expected);
+	}
+
+	const auto empty_view = world.view<Tag, Counted>();
+	y_test_assert(!empty_view.chunk_count());
+}
+
+y_test_func("EntityWorld queries") {
+	ecs::EntityWorld world;
+	ecs::Query<Position, const Velocity> query(world);
+	y_test_assert(query.archetype_count() == 0);
+
+	const core::Vector<ecs::EntityID> ids = create_entities(world, 3000);
+	y_test_assert(query.archetype_count() == 1);
+	y_test_assert(query.entity_count() == ids.size());
+
+	// Only new archetypes invalidate the query
+	const u64 version = world.structural_version();
+	world.add_components<Position>(world.create_entities(100));
+	world.add_component<Tag>(ids[0]);
+	world.add_component<Tag>(ids[1]);
+	y_test_assert(world.structural_version() != version);
+	world.add_component<Tag>(ids[2]);
+	y_test_assert(query.archetype_count() == 2);
+
+	const u64 stable_version = world.structural_version();
+	world.remove_component<Tag>(ids[2]);
+	world.add_component<Tag>(ids[2]);
+	y_test_assert(world.structural_version() == stable_version);
+
+	query.for_each([](Position& pos, const Velocity&) {
+		pos.value += 1;
+	});
+	query.par_each([](Position& pos, const Velocity&) {
+		pos.value *= 3;
+	});
+	for(usize i = 0; i != ids.size(); ++i) {
+		y_test_assert(world.component<Position>(ids[i])->value == (i + 1) * 3);
+	}
+
+	usize entity_count = 0;
+	query.for_each_chunk([&](const ecs::ComponentChunk<Position, const Velocity>& chunk) {
+		entity_count += chunk.size();
+	});
+	y_test_assert(entity_count == ids.size());
+
+	usize view_count = 0;
+	for(auto&& [pos, vel] : world.view<Position, const Velocity>()) {
+		y_test_assert(pos.value % 3 == 0 && vel.x == 1.0f);
+		++view_count;
+	}
+	y_test_assert(view_count == query.entity_count());
+}
+
+// Archetype can't be serialized yet, so this calls what serde3 runs once the archetypes have been read
+y_test_func("EntityWorld post deserialization") {
+	ecs::EntityWorld world;
+	ecs::Query<Position, const Velocity> query(world);
+	const core::Vector<ecs::EntityID> ids = create_entities(world, 100);
+	world.add_component<Tag>(ids[0]);
+	y_test_assert(query.archetype_count() == 2);
+
+	const usize archetype_count = world.archetypes().size();
+	const u64 generation = world.archetype_generation();
+	const u64 version = world.structural_version();
+	world.post_deserialize();
+	y_test_assert(world.archetype_generation() != generation);
+	y_test_assert(world.structural_version() != version);
+
+	// The query is rebuilt instead of appending to its old matches
+	y_test_assert(query.archetype_count() == 2);
+	y_test_assert(query.entity_count() == ids.size());
+
+	// Transitions are found again through the rebuilt index
+	world.add_component<Tag>(ids[1]);
+	world.remove_component<Tag>(ids[0]);
+	y_test_assert(world.archetypes().size() == archetype_count);
+	y_test_assert(query.entity_count() == ids.size());
+}
+
+}
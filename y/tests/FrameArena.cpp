@@ -0,0 +1,144 @@
+/*******************************
+Copyright (c) 2016-2020 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+
+
+#include <y/test/test.h>
+#include <y/mem/FrameArena.h>
+
+#include <thread>
+
+namespace {
+using namespace y;
+using namespace memory;
+
+y_test_func("FrameArena basics") {
+	FrameArena arena(1024);
+
+	core::Vector<u8*> ptrs;
+	for(usize i = 0; i != 100; ++i) {
+		u8* ptr = static_cast<u8*>(arena.allocate(64, i % 2 ? 16 : 64));
+		y_test_assert(ptr);
+		y_test_assert(reinterpret_cast<usize>(ptr) % (i % 2 ? 16 : 64) == 0);
+		std::fill_n(ptr, 64, u8(i));
+		ptrs << ptr;
+	}
+	for(usize i = 0; i != ptrs.size(); ++i) {
+		y_test_assert(std::all_of(ptrs[i], ptrs[i] + 64, [=](u8 b) { return b == i; }));
+	}
+
+	y_test_assert(arena.allocated_bytes() == 6400);
+	y_test_assert(arena.reserved_bytes() > 6400);
+
+	arena.reset();
+	y_test_assert(arena.allocated_bytes() == 0);
+	y_test_assert(arena.last_frame_bytes() == 6400);
+	y_test_assert(arena.peak_bytes() == 6400);
+
+	// Overflow pages have been merged, the same frame should not need any new page
+	const usize reserved = arena.reserved_bytes();
+	for(usize i = 0; i != 100; ++i) {
+		y_test_assert(arena.allocate(64));
+	}
+	y_test_assert(arena.reserved_bytes() == reserved);
+
+	arena.reset();
+	y_test_assert(arena.allocate(10));
+	arena.reset();
+	y_test_assert(arena.last_frame_bytes() == 10);
+	y_test_assert(arena.peak_bytes() == 6400);
+}
+
+y_test_func("FrameArena deallocate") {
+	FrameArena arena;
+
+	void* a = arena.allocate(32);
+	void* b = arena.allocate(32);
+	arena.deallocate(a, 32);
+	y_test_assert(arena.allocated_bytes() == 64);
+
+	arena.deallocate(b, 32);
+	y_test_assert(arena.allocated_bytes() == 32);
+	y_test_assert(arena.allocate(32) == b);
+}
+
+y_test_func("FrameArena vector") {
+	FrameArena arena;
+
+	FrameVector<u32> vec(FrameArenaAllocator{arena});
+	for(u32 i = 0; i != 10000; ++i) {
+		vec << i;
+	}
+	y_test_assert(arena.allocated_bytes() >= 10000 * sizeof(u32));
+
+	const usize allocated = arena.allocated_bytes();
+	{
+		const FrameVector<u32> moved = std::move(vec);
+		y_test_assert(vec.is_empty());
+		y_test_assert(moved.size() == 10000);
+		y_test_assert(moved[9999] == 9999);
+
+		// Copies use the global allocator
+		const FrameVector<u32> copy = moved;
+		y_test_assert(copy == moved);
+		y_test_assert(arena.allocated_bytes() == allocated);
+	}
+
+	// The vector storage was the last allocation, so it was given back
+	y_test_assert(arena.allocated_bytes() < allocated);
+	y_test_assert(arena.peak_bytes() == allocated);
+	arena.reset();
+}
+
+y_test_func("FrameArena threads") {
+	static constexpr usize thread_count = 4;
+	static constexpr usize alloc_count = 10000;
+
+	FrameArena arena(4096);
+
+	core::Vector<u32*> ptrs[thread_count];
+	{
+		core::Vector<std::thread> threads;
+		for(usize t = 0; t != thread_count; ++t) {
+			threads.emplace_back([&, t] {
+				for(usize i = 0; i != alloc_count; ++i) {
+					u32* ptr = static_cast<u32*>(arena.allocate(sizeof(u32) * 4));
+					std::fill_n(ptr, 4, u32(t * alloc_count + i));
+					ptrs[t] << ptr;
+				}
+			});
+		}
+		for(auto& t : threads) {
+			t.join();
+		}
+	}
+
+	for(usize t = 0; t != thread_count; ++t) {
+		for(usize i = 0; i != alloc_count; ++i) {
+			y_test_assert(ptrs[t][i][3] == t * alloc_count + i);
+		}
+	}
+
+	y_test_assert(arena.allocated_bytes() == thread_count * alloc_count * sizeof(u32) * 4);
+	arena.reset();
+}
+
+}
@@ -23,6 +23,8 @@ SOFTWARE.
 #include <y/core/Functor.h>
 #include <y/test/test.h>
 
+#include <array>
+
 namespace {
 using namespace y;
 using namespace y::core;
@@ -131,6 +133,73 @@ y_test_func("Function void boxing") {
 	y_test_assert(i == 1);
 }
 
+struct DtorCounter {
+	DtorCounter(usize* ptr) : counter(ptr) {
+	}
+
+	DtorCounter(DtorCounter&& other) noexcept : counter(other.counter) {
+		other.counter = nullptr;
+	}
+
+	~DtorCounter() {
+		if(counter) {
+			++(*counter);
+		}
+	}
+
+	usize* counter = nullptr;
+};
+
+static_assert(sizeof(core::Function<void()>) == 64);
+static_assert(core::Function<void()>::is_inline<void(*)()>);
+static_assert(!core::Function<void()>::is_inline<std::array<u8, 128>>);
+
+y_test_func("Function move only") {
+	auto ptr = std::make_unique<int>(7);
+	core::Function<int()> func = [p = std::move(ptr)] { return *p; };
+	y_test_assert(func() == 7);
+
+	core::Function<int()> other = std::move(func);
+	y_test_assert(func.is_empty());
+	y_test_assert(other() == 7);
+}
+
+y_test_func("Function mutable") {
+	const core::Function<int()> counter = [i = 0]() mutable { return ++i; };
+	counter();
+	counter();
+	y_test_assert(counter() == 3);
+}
+
+y_test_func("Function storage") {
+	usize small_dtors = 0;
+	usize big_dtors = 0;
+	{
+		DtorCounter small_counter(&small_dtors);
+		DtorCounter big_counter(&big_dtors);
+		std::array<u8, 128> big_payload = {};
+		big_payload[127] = 4;
+
+		auto small = [c = std::move(small_counter)] { return usize(1); };
+		auto big = [c = std::move(big_counter), big_payload] { return usize(big_payload[127]); };
+		static_assert(core::Function<usize()>::is_inline<decltype(small)>);
+		static_assert(!core::Function<usize()>::is_inline<decltype(big)>);
+
+		core::Function<usize()> a = std::move(small);
+		core::Function<usize()> b = std::move(big);
+
+		std::swap(a, b);
+		y_test_assert(a() == 4);
+		y_test_assert(b() == 1);
+
+		core::Function<usize()> c = std::move(a);
+		y_test_assert(c() == 4);
+		y_test_assert(!small_dtors && !big_dtors);
+	}
+	y_test_assert(small_dtors == 1);
+	y_test_assert(big_dtors == 1);
+}
+
 y_test_func("Functor creation") {
 	int i = 0;
 	const auto inc = functor([&i]() { ++i; });
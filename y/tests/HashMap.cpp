@@ -24,12 +24,14 @@ SOFTWARE.
 
 #include <y/core/Vector.h>
 #include <y/core/HashMap.h>
+#include <y/core/SwissHashMap.h>
 #include <y/core/String.h>
 
 #include <y/utils/format.h>
 
 #include <y/math/random.h>
 
+#include <unordered_map>
 #include <ctime>
 
 namespace {
@@ -184,10 +186,12 @@ y_test_func("HashMap fuzz") {
 	const auto m0 = fuzz<std::unordered_map<i32, i32>>(fuzz_count, seed);
 
 	const auto m2 = fuzz<ExternalHashMap<i32, i32>>(fuzz_count, seed);
+	const auto m5 = fuzz<SwissHashMap<i32, i32>>(fuzz_count, seed);
 	/*const auto m3 = fuzz<ExternalHashMap<i32, i32>>(fuzz_count, seed);
 	const auto m4 = fuzz<HashMap<i32, i32>>(fuzz_count, seed);*/
 
 	y_test_assert(to_vector(m0) == to_vector(m2));
+	y_test_assert(to_vector(m0) == to_vector(m5));
 	/*y_test_assert(to_vector(m0) == to_vector(m3));
 	y_test_assert(to_vector(m0) == to_vector(m4));*/
 }
@@ -244,5 +248,85 @@ y_test_func("HashMap value dtors") {
 	y_test_assert(counter == max_key);
 }
 
+y_test_func("SwissHashMap basics") {
+	static constexpr int max_key = 1000;
+	SwissHashMap<int, int> map;
+
+	for(int i = 0; i != max_key; ++i) {
+		y_test_assert(map.emplace(i, i * 2).second);
+	}
+
+	y_test_assert(map.size() == max_key);
+	y_test_assert(map.load_factor() <= map.max_load_factor);
+	y_test_assert(!map.contains(max_key + 1));
+	y_test_assert(!map.emplace(7, 9999).second);
+
+	usize count = 0;
+	for(const auto& [k, v] : map) {
+		y_test_assert(v == 2 * k);
+		++count;
+	}
+	y_test_assert(count == max_key);
+
+	for(int i = 0; i != max_key; i += 2) {
+		map.erase(map.find(i));
+	}
+	for(int i = 0; i != max_key; ++i) {
+		y_test_assert(map.contains(i) == (i % 2 == 1));
+	}
+}
+
+y_test_func("SwissHashMap bad hash") {
+	static constexpr int max_key = 500;
+	SwissHashMap<int, int, AbysmalHash> map;
+
+	for(int i = 0; i != max_key; ++i) {
+		map[i] = i * 2;
+	}
+
+	for(int i = 0; i != max_key; ++i) {
+		const auto it = map.find(i);
+		y_test_assert(it != map.end());
+		y_test_assert(it->second == 2 * i);
+	}
+}
+
+y_test_func("SwissHashMap tombstones") {
+	SwissHashMap<int, core::String, BadHash<3>> map;
+	map.reserve(64);
+	const usize bucket_count = map.bucket_count();
+
+	// Churning through more keys than buckets should only rehash in place
+	for(int i = 0; i != 10000; ++i) {
+		map.insert({i, "value"});
+		if(i >= 32) {
+			map.erase(map.find(i - 32));
+		}
+	}
+
+	y_test_assert(map.size() == 32);
+	y_test_assert(map.bucket_count() == bucket_count);
+	for(int i = 0; i != 10000; ++i) {
+		y_test_assert(map.contains(i) == (i >= 10000 - 32));
+	}
+}
+
+y_test_func("SwissHashMap value dtors") {
+	static constexpr int max_key = 1000;
+
+	usize counter = 0;
+	{
+		SwissHashMap<int, RaiiCounter> map;
+		for(int i = 0; i != max_key; ++i) {
+			map.insert({i, RaiiCounter(&counter)});
+		}
+
+		y_test_assert(counter == 0);
+		map.erase(map.find(4));
+		y_test_assert(counter == 1);
+	}
+
+	y_test_assert(counter == max_key);
+}
 
 }
@@ -0,0 +1,127 @@
+/*******************************
+Copyright (c) 2016-2020 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+
+
+#include <y/test/test.h>
+#include <y/mem/MemoryTags.h>
+#include <y/core/SparseVector.h>
+
+#include <thread>
+
+namespace {
+using namespace y;
+using namespace memory;
+
+static const MemoryTagStats& stats_of(const MemoryTagReport& report, MemoryTag tag) {
+	return report[usize(tag)];
+}
+
+y_test_func("MemoryTags scopes") {
+	y_test_assert(current_memory_tag() == MemoryTag::Untagged);
+	{
+		const ScopedMemoryTag assets(MemoryTag::Assets);
+		y_test_assert(current_memory_tag() == MemoryTag::Assets);
+		{
+			const ScopedMemoryTag serde(MemoryTag::Serde);
+			y_test_assert(current_memory_tag() == MemoryTag::Serde);
+			y_test_assert(TaggedAllocator<MemoryTag::Ecs>().tag() == MemoryTag::Serde);
+		}
+		y_test_assert(current_memory_tag() == MemoryTag::Assets);
+	}
+	y_test_assert(current_memory_tag() == MemoryTag::Untagged);
+	y_test_assert(TaggedAllocator<MemoryTag::Ecs>().tag() == MemoryTag::Ecs);
+}
+
+y_test_func("MemoryTags live and peak") {
+	static constexpr usize size = 1024 * 1024;
+
+	const MemoryTagStats before = stats_of(memory_tag_stats(), MemoryTag::Serde);
+
+	TaggedAllocator<MemoryTag::Serde> allocator;
+	void* a = allocator.allocate(size);
+	void* b = allocator.allocate(size);
+	{
+		const MemoryTagStats during = stats_of(memory_tag_stats(), MemoryTag::Serde);
+		y_test_assert(during.live_bytes == before.live_bytes + 2 * size);
+		y_test_assert(during.allocation_count == before.allocation_count + 2);
+		y_test_assert(during.allocated_bytes == before.allocated_bytes + 2 * size);
+	}
+	allocator.deallocate(a, size);
+	allocator.deallocate(b, size);
+
+	const MemoryTagStats after = stats_of(memory_tag_stats(), MemoryTag::Serde);
+	y_test_assert(after.live_bytes == before.live_bytes);
+	y_test_assert(after.peak_bytes >= before.live_bytes + 2 * size);
+}
+
+y_test_func("MemoryTags threads") {
+	static constexpr usize thread_count = 4;
+	static constexpr usize alloc_count = 1000;
+	static constexpr usize size = 100;
+
+	const MemoryTagStats before = stats_of(memory_tag_stats(), MemoryTag::Assets);
+
+	// Allocated on worker threads, freed on this one
+	std::array<core::Vector<void*>, thread_count> ptrs;
+	core::Vector<std::thread> threads;
+	for(usize i = 0; i != thread_count; ++i) {
+		threads.emplace_back([&ptrs, i] {
+			const ScopedMemoryTag tag(MemoryTag::Assets);
+			TaggedAllocator<> allocator;
+			for(usize k = 0; k != alloc_count; ++k) {
+				ptrs[i] << allocator.allocate(size);
+			}
+		});
+	}
+	for(auto& t : threads) {
+		t.join();
+	}
+
+	{
+		const MemoryTagStats during = stats_of(memory_tag_stats(), MemoryTag::Assets);
+		y_test_assert(during.live_bytes == before.live_bytes + thread_count * alloc_count * size);
+		y_test_assert(during.allocation_count == before.allocation_count + thread_count * alloc_count);
+	}
+
+	TaggedAllocator<MemoryTag::Assets> allocator;
+	for(const auto& p : ptrs) {
+		for(void* ptr : p) {
+			allocator.deallocate(ptr, size);
+		}
+	}
+
+	y_test_assert(stats_of(memory_tag_stats(), MemoryTag::Assets).live_bytes == before.live_bytes);
+}
+
+y_test_func("MemoryTags containers") {
+	const usize before = stats_of(memory_tag_stats(), MemoryTag::Containers).live_bytes;
+	{
+		core::SparseVector<u32, u32> vec;
+		for(u32 i = 0; i < 10000; i += 3) {
+			vec.insert(i, i);
+		}
+		y_test_assert(stats_of(memory_tag_stats(), MemoryTag::Containers).live_bytes > before);
+	}
+	y_test_assert(stats_of(memory_tag_stats(), MemoryTag::Containers).live_bytes == before);
+}
+
+}
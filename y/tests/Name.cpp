@@ -0,0 +1,128 @@
+/*******************************
+Copyright (c) 2016-2020 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+
+
+#include <y/test/test.h>
+
+#include <y/core/Name.h>
+#include <y/core/String.h>
+#include <y/core/Vector.h>
+#include <y/serde3/archives.h>
+#include <y/io2/Buffer.h>
+#include <y/utils/format.h>
+
+#include <thread>
+
+namespace {
+using namespace y;
+using namespace y::core;
+
+y_test_func("Name interning") {
+	const Name a("bone_root");
+	const Name b(String("bone_root"));
+	const Name c("bone_arm");
+
+	y_test_assert(a == b);
+	y_test_assert(a.data() == b.data());
+	y_test_assert(a != c);
+	y_test_assert(a.view() == "bone_root");
+	y_test_assert(a.hash() == std::hash<String>()("bone_root"));
+	y_test_assert(c < a);
+
+	y_test_assert(Name().is_empty());
+	y_test_assert(Name() == Name(""));
+	y_test_assert(Name().data()[0] == 0);
+}
+
+y_test_func("Name find") {
+	y_test_assert(!Name::find("name that is never interned"));
+
+	const Name name("name that is interned");
+	const auto found = Name::find("name that is interned");
+	y_test_assert(found && *found == name);
+}
+
+y_test_func("Name concurrent interning") {
+	static constexpr usize thread_count = 4;
+	static constexpr usize name_count = 4000;
+
+	Vector<Name> names[thread_count];
+	{
+		Vector<std::thread> threads;
+		for(usize t = 0; t != thread_count; ++t) {
+			threads.emplace_back([&names, t] {
+				for(usize i = 0; i != name_count; ++i) {
+					names[t] << Name(fmt("concurrent_name_%", (i * 7 + t) % name_count));
+				}
+			});
+		}
+		for(auto& thread : threads) {
+			thread.join();
+		}
+	}
+
+	for(usize i = 0; i != name_count; ++i) {
+		const Name expected(fmt("concurrent_name_%", i));
+		for(usize t = 0; t != thread_count; ++t) {
+			const usize index = ((i + name_count - t) * 1143) % name_count;
+			y_test_assert(((index * 7 + t) % name_count) == i);
+			y_test_assert(names[t][index] == expected);
+		}
+	}
+}
+
+y_test_func("Name serde3 string form") {
+	const Vector<Name> names = {Name("serialized"), Name(), Name("names")};
+
+	io2::Buffer buffer;
+	{
+		serde3::WritableArchive arc(buffer);
+		y_test_assert(arc.serialize(names));
+	}
+
+	buffer.reset();
+
+	Vector<String> strings;
+	{
+		serde3::ReadableArchive arc(buffer);
+		y_test_assert(arc.deserialize(strings).unwrap() == serde3::Success::Full);
+	}
+	y_test_assert(strings.size() == 3);
+	y_test_assert(strings[0] == "serialized" && strings[1] == "" && strings[2] == "names");
+
+	io2::Buffer buffer2;
+	{
+		serde3::WritableArchive arc(buffer2);
+		y_test_assert(arc.serialize(strings));
+	}
+
+	buffer2.reset();
+
+	Vector<Name> read;
+	{
+		serde3::ReadableArchive arc(buffer2);
+		y_test_assert(arc.deserialize(read).unwrap() == serde3::Success::Full);
+	}
+	y_test_assert(read == names);
+}
+
+}
@@ -0,0 +1,195 @@
+/*******************************
+Copyright (c) 2016-2020 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+
+
+#include <y/concurrent/StaticThreadPool.h>
+#include <y/test/test.h>
+
+#include <atomic>
+
+namespace {
+using namespace y;
+using namespace y::concurrent;
+
+y_test_func("StaticThreadPool schedule") {
+	std::atomic<usize> counter = 0;
+	{
+		StaticThreadPool pool(4);
+		for(usize i = 0; i != 10000; ++i) {
+			pool.schedule([&] { ++counter; });
+		}
+		pool.schedule_with_future([] {}).wait();
+		pool.process_until_empty();
+	}
+	y_test_assert(counter == 10000);
+}
+
+y_test_func("StaticThreadPool futures") {
+	StaticThreadPool pool(4);
+	core::Vector<std::future<usize>> futures;
+	for(usize i = 0; i != 1000; ++i) {
+		futures.emplace_back(pool.schedule_with_future([i] { return i * 2; }));
+	}
+	for(usize i = 0; i != futures.size(); ++i) {
+		y_test_assert(futures[i].get() == i * 2);
+	}
+}
+
+y_test_func("StaticThreadPool nested schedule") {
+	StaticThreadPool pool(4);
+	std::atomic<usize> counter = 0;
+	core::Vector<std::future<void>> futures;
+	for(usize i = 0; i != 64; ++i) {
+		futures.emplace_back(pool.schedule_with_future([&] {
+			for(usize k = 0; k != 64; ++k) {
+				pool.schedule([&] { ++counter; });
+			}
+		}));
+	}
+	for(auto& f : futures) {
+		f.wait();
+	}
+	while(counter != 64 * 64) {
+		pool.process_until_empty();
+	}
+	y_test_assert(counter == 64 * 64);
+}
+
+y_test_func("StaticThreadPool dependencies") {
+	StaticThreadPool pool(4);
+	for(usize i = 0; i != 100; ++i) {
+		std::atomic<usize> done = 0;
+		DependencyGroup group;
+		for(usize k = 0; k != 16; ++k) {
+			pool.schedule([&] { ++done; }, &group);
+		}
+		auto future = pool.schedule_with_future([&] { return usize(done); }, nullptr, group);
+		y_test_assert(future.get() == 16);
+		y_test_assert(group.is_ready());
+	}
+}
+
+y_test_func("StaticThreadPool dependency chains") {
+	static constexpr usize chain_count = 100;
+	static constexpr usize chain_len = 1000;
+
+	StaticThreadPool pool(4);
+
+	core::Vector<usize> progress(chain_count, 0);
+	std::atomic<bool> ordered = true;
+
+	core::Vector<DependencyGroup> ends;
+	for(usize c = 0; c != chain_count; ++c) {
+		DependencyGroup previous;
+		for(usize i = 0; i != chain_len; ++i) {
+			DependencyGroup next;
+			pool.schedule([&, c, i] {
+				if(progress[c] != i) {
+					ordered = false;
+				}
+				progress[c] = i + 1;
+			}, &next, previous);
+			previous = next;
+		}
+		ends.emplace_back(previous);
+	}
+
+	for(const DependencyGroup& end : ends) {
+		pool.schedule_with_future([] {}, nullptr, end).wait();
+	}
+
+	y_test_assert(ordered);
+	y_test_assert(pool.pending_tasks() == 0);
+	for(usize p : progress) {
+		y_test_assert(p == chain_len);
+	}
+}
+
+y_test_func("StaticThreadPool dependency DAG") {
+	static constexpr usize layer_count = 1000;
+	static constexpr usize layer_width = 100;
+
+	StaticThreadPool pool(4);
+
+	std::atomic<usize> done = 0;
+	std::atomic<bool> ordered = true;
+
+	DependencyGroup previous;
+	for(usize l = 0; l != layer_count; ++l) {
+		DependencyGroup layer;
+		for(usize i = 0; i != layer_width; ++i) {
+			// Every task of a layer depends on every task of the previous layer
+			pool.schedule([&, l] {
+				if(done.fetch_add(1) < l * layer_width) {
+					ordered = false;
+				}
+			}, &layer, previous);
+		}
+		previous = layer;
+	}
+
+	pool.schedule_with_future([] {}, nullptr, previous).wait();
+
+	y_test_assert(ordered);
+	y_test_assert(done == layer_count * layer_width);
+	y_test_assert(pool.pending_tasks() == 0);
+}
+
+y_test_func("StaticThreadPool no threads") {
+	StaticThreadPool pool(0);
+	y_test_assert(pool.concurency() == 0);
+
+	usize counter = 0;
+	DependencyGroup group;
+	pool.schedule([&] { ++counter; }, &group);
+	y_test_assert(counter == 1);
+
+	auto future = pool.schedule_with_future([&] { return counter; }, nullptr, group);
+	y_test_assert(future.get() == 1);
+	y_test_assert(pool.pending_tasks() == 0);
+}
+
+y_test_func("StaticThreadPool destroyed with parked tasks") {
+	std::atomic<bool> release = false;
+	std::atomic<bool> ran = false;
+
+	StaticThreadPool producer(1);
+	DependencyGroup group;
+	producer.schedule([&] {
+		while(!release) {
+			std::this_thread::yield();
+		}
+	}, &group);
+
+	{
+		StaticThreadPool pool(2);
+		pool.schedule([&] { ran = true; }, nullptr, group);
+		y_test_assert(pool.pending_tasks() == 1);
+	}
+
+	// Solving the group after the pool is gone drops the task
+	release = true;
+	producer.process_until_complete(group);
+	y_test_assert(!ran);
+}
+
+}
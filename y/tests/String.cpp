@@ -28,6 +28,7 @@ SOFTWARE.
 #include <y/math/Vec.h>
 #include <memory>
 #include <cstring>
+#include <limits>
 
 namespace {
 using namespace y;
@@ -193,6 +194,35 @@ y_test_func("fmt long") {
 	}
 }
 
+y_test_func("fmt numbers") {
+	y_test_assert(fmt("% % %", 0, -7, 1234567890) == "0 -7 1234567890");
+	y_test_assert(fmt("%", std::numeric_limits<i64>::min()) == "-9223372036854775808");
+	y_test_assert(fmt("%", std::numeric_limits<u64>::max()) == "18446744073709551615");
+	y_test_assert(fmt("% %", u8('a'), true) == "a 1");
+	y_test_assert(fmt("% % %", 1.5f, 0.1, -2.0) == "1.5 0.1 -2");
+	y_test_assert(fmt("%", 0.1f) == "0.1");
+	y_test_assert(fmt("%", reinterpret_cast<const void*>(usize(0xbeef))) == "0xbeef");
+}
+
+y_test_func("fmt placeholders") {
+	static constexpr FmtString fmt_str = "a%b%c";
+	static_assert(fmt_str.size() == 5);
+	y_test_assert(fmt(fmt_str, 1, 2) == "a1b2c");
+
+	// More placeholders than FmtString keeps offsets for
+	y_test_assert(fmt("%%%%%%%%%%%%%%%%%%", 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 0, 1, 2, 3, 4, 5, 6) == "01234567890123456%");
+	y_test_assert(fmt("% %", 1, 2, 3) == "1 2");
+}
+
+y_test_func("fmt_to") {
+	char buffer[8];
+	y_test_assert(fmt_to(buffer, "% %", 12, "ab") == "12 ab");
+	y_test_assert(!std::strcmp(buffer, "12 ab"));
+
+	y_test_assert(fmt_to(buffer, "%-%", 123456, 789) == "123456-");
+	y_test_assert(!std::strcmp(buffer, "123456-"));
+}
+
 y_test_func("fmt_into simple") {
 	String s = "some core::String";
 	const char* f = fmt_into(s, " % % %", 1, "more str", -7).data();
@@ -87,7 +87,7 @@ struct FakeAllocator {
 
 
 template<typename T, usize Size = 8>
-using SmallVec = SmallVector<T, Size, DefaultVectorResizePolicy/*, FakeAllocator<T>*/>;
+using SmallVec = SmallVector<T, Size, DefaultVectorResizePolicy, FakeAllocator<T>>;
 
 static_assert(std::is_same_v<std::common_type<MoreDerived, Derived>::type, Derived>, "std::common_type failure");
 static_assert(std::is_polymorphic_v<Polymorphic>, "std::is_polymorphic failure");
@@ -271,8 +271,53 @@ y_test_func("Vector dtors") {
 
 y_test_func("SmallVector allocation") {
 	SmallVec<int, 4> vec = Vector({1, 2, 3, 4});
-	//y_test_assert(vec.capacity() == 4);
+	y_test_assert(vec.capacity() == 4);
 	y_test_assert(vec == Vector({1, 2, 3, 4}));
+
+	SmallVec<int, 4> moved = std::move(vec);
+	y_test_assert(moved == Vector({1, 2, 3, 4}));
+	y_test_assert(vec.is_empty());
+
+	moved.pop();
+	moved << 7;
+	y_test_assert(moved == Vector({1, 2, 3, 7}));
+}
+
+y_test_func("SmallVector spill") {
+	SmallVector<int, 4> vec = {1, 2, 3};
+	const int* inline_data = vec.data();
+
+	vec << 4 << 5;
+	y_test_assert(vec.capacity() > 4);
+	y_test_assert(vec.data() != inline_data);
+	y_test_assert(vec == Vector({1, 2, 3, 4, 5}));
+
+	vec.pop();
+	vec.squeeze();
+	y_test_assert(vec.data() == inline_data);
+	y_test_assert(vec == Vector({1, 2, 3, 4}));
+
+	vec.clear();
+	vec << 9;
+	y_test_assert(vec.data() == inline_data);
+}
+
+y_test_func("SmallVector swap") {
+	SmallVector<core::Vector<int>, 2> small = {Vector({1}), Vector({2})};
+	SmallVector<core::Vector<int>, 2> big = {Vector({3}), Vector({4}), Vector({5})};
+
+	small.swap(big);
+	y_test_assert(small.size() == 3 && small[2] == Vector({5}));
+	y_test_assert(big.size() == 2 && big[0] == Vector({1}));
+
+	small.swap(big);
+	y_test_assert(small.size() == 2 && small[1] == Vector({2}));
+	y_test_assert(big.size() == 3 && big[0] == Vector({3}));
+
+	SmallVector<core::Vector<int>, 2> other = {Vector({6})};
+	small.swap(other);
+	y_test_assert(small.size() == 1 && small[0] == Vector({6}));
+	y_test_assert(other.size() == 2 && other[0] == Vector({1}));
 }
 
 y_test_func("SmallVector size") {
@@ -21,12 +21,189 @@ SOFTWARE.
 **********************************/
 #include <y/test/test.h>
 #include <y/mem/allocators.h>
+#include <y/mem/ThreadCachingAllocator.h>
+#include <y/mem/ChunkAllocator.h>
 #include <y/core/Vector.h>
+#include <y/math/random.h>
+
+#include <thread>
+#include <atomic>
 
 namespace {
 using namespace y;
 using namespace memory;
 
+static bool check_and_fill(void* ptr, usize size, u8 expected, u8 value) {
+	u8* bytes = static_cast<u8*>(ptr);
+	const bool ok = std::all_of(bytes, bytes + size, [=](u8 b) { return b == expected; });
+	std::fill_n(bytes, size, value);
+	return ok;
+}
+
+y_test_func("ThreadCachingAllocator sizes") {
+	const usize live = ThreadCachingAllocator::stats().live_bytes;
+
+	ThreadCachingAllocator allocator;
+	for(const usize size : {0, 1, 15, 16, 17, 100, 128, 129, 1000, 4096, 32767, 32768, 32769, 100000}) {
+		core::Vector<void*> ptrs;
+		for(usize i = 0; i != 200; ++i) {
+			void* ptr = allocator.allocate(size);
+			y_test_assert(ptr);
+			y_test_assert(reinterpret_cast<usize>(ptr) % max_alignment == 0);
+			check_and_fill(ptr, size, 0, u8(i + 1));
+			ptrs << ptr;
+		}
+
+		y_test_assert(ThreadCachingAllocator::stats().live_bytes == live + size * ptrs.size());
+
+		for(usize i = 0; i != ptrs.size(); ++i) {
+			y_test_assert(check_and_fill(ptrs[i], size, u8(i + 1), 0));
+			allocator.deallocate(ptrs[i], size);
+		}
+	}
+
+	allocator.deallocate(nullptr, 16);
+	y_test_assert(ThreadCachingAllocator::stats().live_bytes == live);
+}
+
+y_test_func("ThreadCachingAllocator threads") {
+	static constexpr usize thread_count = 4;
+	static constexpr usize alloc_count = 20000;
+
+	const usize live = ThreadCachingAllocator::stats().live_bytes;
+
+	// Every thread frees the allocations of the previous one to exercise the central pool
+	core::Vector<std::pair<void*, usize>> allocations[thread_count];
+	const auto allocate = [&](usize index) {
+		ThreadCachingAllocator allocator;
+		math::FastRandom rng(static_cast<u32>(index));
+		for(usize i = 0; i != alloc_count; ++i) {
+			const usize size = rng() % (i % 16 ? 512 : 40000);
+			void* ptr = allocator.allocate(size);
+			std::fill_n(static_cast<u8*>(ptr), size, u8(index));
+			allocations[index] << std::pair{ptr, size};
+		}
+	};
+
+	std::atomic<bool> ok = true;
+	const auto deallocate = [&](usize index) {
+		ThreadCachingAllocator allocator;
+		for(const auto& [ptr, size] : allocations[index]) {
+			const u8* bytes = static_cast<const u8*>(ptr);
+			if(!std::all_of(bytes, bytes + size, [=](u8 b) { return b == index; })) {
+				ok = false;
+			}
+			allocator.deallocate(ptr, size);
+		}
+	};
+
+	{
+		core::Vector<std::thread> threads;
+		for(usize i = 0; i != thread_count; ++i) {
+			threads.emplace_back(allocate, i);
+		}
+		for(auto& t : threads) {
+			t.join();
+		}
+	}
+	{
+		core::Vector<std::thread> threads;
+		for(usize i = 0; i != thread_count; ++i) {
+			threads.emplace_back(deallocate, (i + 1) % thread_count);
+		}
+		for(auto& t : threads) {
+			t.join();
+		}
+	}
+
+	y_test_assert(ok);
+	y_test_assert(ThreadCachingAllocator::stats().live_bytes == live);
+}
+
+y_test_func("ChunkAllocator alignment and reuse") {
+	static constexpr usize block_size = 64 * 1024;
+	ChunkAllocator allocator(block_size, false);
+
+	for(const usize size : {1, 64, 100, 1000, 4096, 20000}) {
+		core::Vector<void*> ptrs;
+		for(usize i = 0; i != 50; ++i) {
+			void* ptr = allocator.allocate(size);
+			y_test_assert(ptr);
+			y_test_assert(reinterpret_cast<usize>(ptr) % ChunkAllocator::chunk_alignment == 0);
+			check_and_fill(ptr, size, 0, u8(i + 1));
+			ptrs << ptr;
+		}
+
+		for(usize i = 0; i != ptrs.size(); ++i) {
+			y_test_assert(check_and_fill(ptrs[i], size, u8(i + 1), 0));
+		}
+
+		void* last = ptrs.pop();
+		allocator.deallocate(last, size);
+		y_test_assert(allocator.allocate(size) == last);
+		ptrs << last;
+
+		for(void* ptr : ptrs) {
+			allocator.deallocate(ptr, size);
+		}
+	}
+
+	y_test_assert(allocator.stats().used_bytes == 0);
+	allocator.shrink();
+	y_test_assert(allocator.stats().reserved_bytes == 0);
+}
+
+y_test_func("ChunkAllocator shrink") {
+	static constexpr usize block_size = 64 * 1024;
+	static constexpr usize chunk_size = 16 * 1024;
+	ChunkAllocator allocator(block_size, false);
+
+	// 3 chunks per block (the block header takes the first cache line)
+	core::Vector<void*> ptrs;
+	for(usize i = 0; i != 9; ++i) {
+		ptrs << allocator.allocate(chunk_size);
+	}
+	y_test_assert(allocator.stats().block_count == 3);
+	y_test_assert(allocator.stats().used_bytes == 9 * chunk_size);
+
+	for(void* ptr : ptrs) {
+		allocator.deallocate(ptr, chunk_size);
+	}
+
+	// One empty block is kept around
+	y_test_assert(allocator.stats().block_count == 1);
+	y_test_assert(allocator.stats().reserved_bytes == block_size);
+
+	void* ptr = allocator.allocate(chunk_size);
+	y_test_assert(allocator.stats().block_count == 1);
+	allocator.deallocate(ptr, chunk_size);
+
+	allocator.shrink();
+	y_test_assert(allocator.stats().block_count == 0);
+	y_test_assert(allocator.stats().reserved_bytes == 0);
+}
+
+y_test_func("ChunkAllocator dedicated") {
+	static constexpr usize block_size = 64 * 1024;
+	static constexpr usize chunk_size = 40 * 1024;
+	ChunkAllocator allocator(block_size, false);
+
+	void* a = allocator.allocate(chunk_size);
+	void* b = allocator.allocate(chunk_size);
+	y_test_assert(a && b);
+	y_test_assert(reinterpret_cast<usize>(a) % ChunkAllocator::chunk_alignment == 0);
+	y_test_assert(allocator.stats().dedicated_count == 2);
+	y_test_assert(allocator.stats().block_count == 0);
+	check_and_fill(a, chunk_size, 0, 1);
+	check_and_fill(b, chunk_size, 0, 2);
+
+	allocator.deallocate(a, chunk_size);
+	y_test_assert(check_and_fill(b, chunk_size, 2, 0));
+	allocator.deallocate(b, chunk_size);
+	y_test_assert(allocator.stats().dedicated_count == 0);
+	y_test_assert(allocator.stats().reserved_bytes == 0);
+}
+
 /*y_test_func("StackBlockAllocator basic") {
 	static constexpr usize size = align_up_to_max(1024);
 	StackBlockAllocator<size, Mallocator> allocator;
@@ -0,0 +1,111 @@
+/*******************************
+Copyright (c) 2016-2020 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+
+
+#include <y/test/test.h>
+#include <y/bench/bench.h>
+
+namespace {
+using namespace y;
+
+y_test_func("bench state repetitions") {
+	bench::State state(7, 2, 5);
+	y_test_assert(state.param() == 7);
+
+	usize runs = 0;
+	while(state.run()) {
+		++runs;
+	}
+	y_test_assert(runs == 7);
+	y_test_assert(state.samples_ns().size() == 5);
+}
+
+y_test_func("bench summary") {
+	bench::State state(0, 0, 4);
+	while(state.run()) {
+	}
+	state.set_items_per_run(10);
+
+	const bench::BenchResult result = bench::summarize("summary", 3, state);
+	y_test_assert(result.name == "summary");
+	y_test_assert(result.param == 3);
+	y_test_assert(result.repetitions == 4);
+	y_test_assert(result.min_ns <= result.median_ns);
+	y_test_assert(result.median_ns <= result.max_ns);
+	y_test_assert(result.min_ns <= result.mean_ns && result.mean_ns <= result.max_ns);
+	y_test_assert(result.stddev_ns >= 0.0);
+}
+
+y_test_func("bench json") {
+	core::Vector<bench::BenchResult> results;
+	for(usize i = 0; i != 3; ++i) {
+		bench::BenchResult& result = results.emplace_back();
+		result.name = "json test";
+		result.param = i * 1024;
+		result.repetitions = 10;
+		result.min_ns = 1.0 + i;
+		result.median_ns = 2.5 + i;
+		result.mean_ns = 2.75 + i;
+		result.stddev_ns = 0.5;
+		result.max_ns = 4.0 + i;
+		result.allocations = 0.25 * i;
+	}
+
+	const core::String json = bench::to_json(results);
+	const auto parsed = bench::from_json(json);
+	y_test_assert(parsed);
+
+	const core::Vector<bench::BenchResult>& read = parsed.unwrap();
+	y_test_assert(read.size() == results.size());
+	for(usize i = 0; i != read.size(); ++i) {
+		y_test_assert(read[i].name == results[i].name);
+		y_test_assert(read[i].param == results[i].param);
+		y_test_assert(read[i].repetitions == results[i].repetitions);
+		y_test_assert(read[i].median_ns == results[i].median_ns);
+		y_test_assert(read[i].max_ns == results[i].max_ns);
+		y_test_assert(read[i].allocations == results[i].allocations);
+	}
+
+	y_test_assert(!bench::from_json(R"({"benchmarks":[{"name":"broken","param":1}]})"));
+}
+
+y_test_func("bench compare") {
+	core::Vector<bench::BenchResult> baseline;
+	baseline.emplace_back().name = "a";
+	baseline.last().median_ns = 10.0;
+	baseline.emplace_back().name = "b";
+	baseline.last().median_ns = 10.0;
+
+	core::Vector<bench::BenchResult> results;
+	results.emplace_back().name = "a";
+	results.last().median_ns = 15.0;
+	results.emplace_back().name = "c";
+	results.last().median_ns = 1.0;
+
+	const auto comparisons = bench::compare(results, baseline);
+	y_test_assert(comparisons.size() == 1);
+	y_test_assert(comparisons[0].result == &results[0]);
+	y_test_assert(comparisons[0].baseline == &baseline[0]);
+	y_test_assert(comparisons[0].ratio == 1.5);
+}
+
+}
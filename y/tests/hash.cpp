@@ -0,0 +1,85 @@
+/*******************************
+Copyright (c) 2016-2020 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+
+
+#include <y/utils/hash.h>
+#include <y/core/Vector.h>
+#include <y/test/test.h>
+
+#include <cstring>
+
+namespace {
+using namespace y;
+
+y_test_func("hash_bytes wyhash vectors") {
+	const char* inputs[] = {
+		"",
+		"a",
+		"abc",
+		"message digest",
+		"abcdefghijklmnopqrstuvwxyz",
+		"ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789",
+		"12345678901234567890123456789012345678901234567890123456789012345678901234567890"
+	};
+	const u64 expected[] = {
+		0x93228a4de0eec5a2, 0xc5bac3db178713c4, 0xa97f2f7b1d9b3314, 0x786d1f1df3801df4,
+		0xdca5a8138ad37c87, 0xb9e734f117cfaf70, 0x6cc5eab49a92d617
+	};
+
+	for(usize i = 0; i != std::size(inputs); ++i) {
+		y_test_assert(hash_bytes(inputs[i], std::strlen(inputs[i]), i) == expected[i]);
+	}
+}
+
+y_test_func("BytesHasher matches hash_bytes") {
+	core::Vector<u8> bytes;
+	for(usize i = 0; i != 300; ++i) {
+		bytes << u8(i * 7 + 3);
+	}
+
+	for(usize size = 0; size != bytes.size(); ++size) {
+		const u64 expected = hash_bytes(bytes.data(), size, 17);
+		for(usize piece : {usize(1), usize(5), usize(16), usize(48), usize(49), usize(100)}) {
+			BytesHasher hasher(17);
+			for(usize i = 0; i < size; i += piece) {
+				hasher.add(bytes.data() + i, std::min(piece, size - i));
+			}
+			y_test_assert(hasher.hash() == expected);
+		}
+	}
+}
+
+y_test_func("hash_range bytes path") {
+	const core::Vector<u32> ints = {1, 2, 3, 4, 5};
+	y_test_assert(hash_range(ints) == usize(hash_bytes(ints.data(), ints.size() * sizeof(u32))));
+
+	core::Vector<u32> other = ints;
+	other[4] = 6;
+	y_test_assert(hash_range(ints) != hash_range(other));
+
+	// Floats can be equal with different bytes, they are hashed one by one
+	const core::Vector<float> floats = {0.0f, 1.0f};
+	const core::Vector<float> neg_floats = {-0.0f, 1.0f};
+	y_test_assert(hash_range(floats) == hash_range(neg_floats));
+}
+
+}
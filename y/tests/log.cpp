@@ -0,0 +1,173 @@
+/*******************************
+Copyright (c) 2016-2020 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+
+
+#include <y/test/test.h>
+#include <y/utils/log.h>
+#include <y/utils/format.h>
+#include <y/core/Vector.h>
+#include <y/core/String.h>
+
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <array>
+#include <cstdio>
+
+namespace {
+using namespace y;
+
+struct Sink {
+	std::mutex lock;
+	core::Vector<core::String> messages;
+	core::Vector<u64> times;
+	std::atomic<bool> blocked = false;
+
+	static bool callback(std::string_view msg, Log type, void* user_data) {
+		Sink* sink = static_cast<Sink*>(user_data);
+		while(sink->blocked) {
+			std::this_thread::yield();
+		}
+		if(type == Log::Debug) {
+			const std::unique_lock lock(sink->lock);
+			sink->messages << msg;
+			sink->times << log_time_ns();
+		}
+		return true;
+	}
+};
+
+y_test_func("async log per thread ordering") {
+	Sink sink;
+	set_log_callback(&Sink::callback, &sink);
+	start_async_logging();
+
+	static constexpr usize thread_count = 4;
+	static constexpr usize message_count = 1000;
+
+	std::array<std::thread, thread_count> threads;
+	for(usize t = 0; t != thread_count; ++t) {
+		threads[t] = std::thread([t] {
+			for(usize i = 0; i != message_count; ++i) {
+				log_msg(fmt("% %", t, i), Log::Debug);
+			}
+			flush_log();
+		});
+	}
+	for(auto& thread : threads) {
+		thread.join();
+	}
+
+	const u64 dropped = dropped_log_count();
+	flush_log();
+	stop_async_logging();
+	set_log_callback(nullptr);
+
+	y_test_assert(sink.messages.size() + dropped >= thread_count * message_count);
+
+	std::array<usize, thread_count> next = {};
+	for(const core::String& msg : sink.messages) {
+		usize t = 0;
+		usize i = 0;
+		y_test_assert(std::sscanf(msg.data(), "%zu %zu", &t, &i) == 2);
+		y_test_assert(t < thread_count);
+		y_test_assert(i >= next[t]);
+		next[t] = i + 1;
+	}
+}
+
+y_test_func("async log flush") {
+	Sink sink;
+	set_log_callback(&Sink::callback, &sink);
+	start_async_logging();
+	y_test_assert(is_async_logging());
+
+	for(usize i = 0; i != 10; ++i) {
+		log_msg(fmt("%", i), Log::Debug);
+	}
+	flush_log();
+
+	{
+		const std::unique_lock lock(sink.lock);
+		y_test_assert(sink.messages.size() == 10);
+		for(usize i = 1; i != sink.times.size(); ++i) {
+			y_test_assert(sink.times[i - 1] <= sink.times[i]);
+		}
+	}
+
+	stop_async_logging();
+	set_log_callback(nullptr);
+	y_test_assert(!is_async_logging());
+}
+
+y_test_func("async log drop") {
+	Sink sink;
+	set_log_callback(&Sink::callback, &sink);
+
+	AsyncLogSettings settings;
+	settings.ring_size = 1024;
+	settings.overflow = LogOverflow::Drop;
+	start_async_logging(settings);
+
+	// The drain thread gets stuck on the first message
+	sink.blocked = true;
+	const u64 dropped = dropped_log_count();
+	static constexpr usize message_count = 1000;
+	for(usize i = 0; i != message_count; ++i) {
+		log_msg("some message that should not fit", Log::Debug);
+	}
+	sink.blocked = false;
+	flush_log();
+
+	const u64 new_drops = dropped_log_count() - dropped;
+	y_test_assert(new_drops > 0);
+	y_test_assert(sink.messages.size() + new_drops == message_count);
+
+	stop_async_logging();
+	set_log_callback(nullptr);
+}
+
+y_test_func("async log block") {
+	Sink sink;
+	set_log_callback(&Sink::callback, &sink);
+
+	AsyncLogSettings settings;
+	settings.ring_size = 1024;
+	settings.overflow = LogOverflow::Block;
+	start_async_logging(settings);
+
+	const u64 dropped = dropped_log_count();
+	static constexpr usize message_count = 1000;
+	for(usize i = 0; i != message_count; ++i) {
+		log_msg(fmt("%", i), Log::Debug);
+	}
+	stop_async_logging();
+	set_log_callback(nullptr);
+
+	y_test_assert(dropped_log_count() == dropped);
+	y_test_assert(sink.messages.size() == message_count);
+	for(usize i = 0; i != message_count; ++i) {
+		y_test_assert(sink.messages[i] == core::String(fmt("%", i)));
+	}
+}
+
+}
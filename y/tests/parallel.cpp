@@ -0,0 +1,202 @@
+/*******************************
+Copyright (c) 2016-2020 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+
+
+#include <y/concurrent/parallel.h>
+#include <y/core/Range.h>
+#include <y/core/FixedArray.h>
+#include <y/math/random.h>
+#include <y/test/test.h>
+
+#include <numeric>
+
+namespace {
+using namespace y;
+using namespace y::concurrent;
+
+static core::Vector<u64> iota_vector(usize size) {
+	core::Vector<u64> values(size, 0);
+	std::iota(values.begin(), values.end(), u64(0));
+	return values;
+}
+
+y_test_func("parallel_for") {
+	StaticThreadPool pool(4);
+	core::Vector<u64> values = iota_vector(100000);
+
+	parallel_for(values, 1, [](u64& v) { v *= 3; }, pool);
+
+	for(usize i = 0; i != values.size(); ++i) {
+		y_test_assert(values[i] == i * 3);
+	}
+}
+
+y_test_func("parallel_for chunks") {
+	StaticThreadPool pool(4);
+	core::FixedArray<std::atomic<u32>> hits(12345);
+
+	for(usize grain : {usize(0), usize(1), usize(7), usize(1000), usize(100000)}) {
+		parallel_for_chunks(hits.size(), grain, [&](usize begin, usize end) {
+			y_test_assert(begin < end);
+			y_test_assert(end - begin >= std::min(grain, hits.size() - begin));
+			for(usize i = begin; i != end; ++i) {
+				++hits[i];
+			}
+		}, pool);
+	}
+
+	for(const auto& h : hits) {
+		y_test_assert(h == 5);
+	}
+
+	parallel_for_chunks(0, 1, [&](usize, usize) { y_test_assert(false); }, pool);
+}
+
+y_test_func("parallel_reduce") {
+	StaticThreadPool pool(4);
+	const core::Vector<u64> values = iota_vector(100000);
+
+	const u64 sum = parallel_reduce(core::Range(values), 16, u64(0), [](u64 acc, u64 v) { return acc + v; }, std::plus<u64>(), pool);
+	y_test_assert(sum == (values.size() * (values.size() - 1)) / 2);
+
+	// Chunks have to be combined in order
+	const core::Vector<u64> ordered = parallel_reduce(core::Span<u64>(values), 1, core::Vector<u64>(),
+		[](core::Vector<u64> acc, u64 v) { acc << v; return acc; },
+		[](core::Vector<u64> a, const core::Vector<u64>& b) { a.push_back(b.begin(), b.end()); return a; },
+		pool);
+	y_test_assert(ordered == values);
+
+	y_test_assert(parallel_reduce(core::Vector<u64>(), 1, u64(7), std::plus<u64>(), std::plus<u64>(), pool) == 7);
+}
+
+y_test_func("parallel_for nested") {
+	StaticThreadPool pool(2);
+	core::Vector<core::Vector<u64>> values(64, core::Vector<u64>());
+	for(auto& v : values) {
+		v = iota_vector(1000);
+	}
+
+	// Inner loops run inside pool tasks, waiting threads must help or this deadlocks
+	parallel_for(values, 1, [&](core::Vector<u64>& inner) {
+		parallel_for(inner, 1, [](u64& v) { ++v; }, pool);
+	}, pool);
+
+	for(const auto& inner : values) {
+		for(usize i = 0; i != inner.size(); ++i) {
+			y_test_assert(inner[i] == i + 1);
+		}
+	}
+}
+
+y_test_func("parallel_for no threads") {
+	StaticThreadPool pool(0);
+	core::Vector<u64> values = iota_vector(10000);
+
+	parallel_for(values, 1, [](u64& v) { v += 1; }, pool);
+	const u64 sum = parallel_reduce(values, 1, u64(0), std::plus<u64>(), std::plus<u64>(), pool);
+	y_test_assert(sum == (values.size() * (values.size() + 1)) / 2);
+}
+
+
+y_test_func("parallel_sort") {
+	StaticThreadPool pool(4);
+	math::FastRandom rng(7);
+
+	core::Vector<u32> values;
+	for(usize i = 0; i != 1000003; ++i) {
+		values << u32(rng());
+	}
+	core::Vector<u32> expected = values;
+	std::sort(expected.begin(), expected.end());
+
+	parallel_sort(values.begin(), values.end(), pool);
+	y_test_assert(values == expected);
+}
+
+y_test_func("parallel_sort comparator and key") {
+	StaticThreadPool pool(4);
+	math::FastRandom rng(11);
+
+	core::Vector<std::pair<u32, u32>> values;
+	for(u32 i = 0; i != 300000; ++i) {
+		values << std::pair<u32, u32>(rng() % 100, i);
+	}
+
+	parallel_sort(values.begin(), values.end(), [](const auto& a, const auto& b) { return a.first < b.first; }, pool);
+	for(usize i = 1; i != values.size(); ++i) {
+		y_test_assert(values[i - 1].first <= values[i].first);
+	}
+
+	parallel_sort(values.begin(), values.end(), [](const auto& p) { return p.second; }, pool);
+	for(usize i = 0; i != values.size(); ++i) {
+		y_test_assert(values[i].second == i);
+	}
+}
+
+y_test_func("parallel_sort without default constructor") {
+	struct Item {
+		Item(u32 k, u32 i) : key(k), index(i) {
+		}
+
+		u32 key;
+		u32 index;
+	};
+
+	// Not trivially copyable, the scratch buffer has to move construct and destroy it
+	struct OwningItem {
+		OwningItem(u32 k) : key(k), data(core::Vector<u32>(1, k)) {
+		}
+
+		u32 key;
+		core::Vector<u32> data;
+	};
+
+	static_assert(!std::is_default_constructible_v<Item> && !std::is_default_constructible_v<OwningItem>);
+
+	StaticThreadPool pool(4);
+	math::FastRandom rng(13);
+
+	core::Vector<Item> items;
+	core::Vector<OwningItem> owning;
+	for(u32 i = 0; i != 300000; ++i) {
+		items << Item(rng() % 1000, i);
+		owning << OwningItem(rng());
+	}
+
+	parallel_sort(items.begin(), items.end(), [](const Item& item) { return item.key; }, pool);
+	for(usize i = 1; i != items.size(); ++i) {
+		y_test_assert(items[i - 1].key < items[i].key || (items[i - 1].key == items[i].key && items[i - 1].index < items[i].index));
+	}
+
+	parallel_sort(items.begin(), items.end(), [](const Item& a, const Item& b) { return a.index < b.index; }, pool);
+	for(usize i = 0; i != items.size(); ++i) {
+		y_test_assert(items[i].index == i);
+	}
+
+	parallel_sort(owning.begin(), owning.end(), [](const OwningItem& a, const OwningItem& b) { return a.key < b.key; }, pool);
+	for(usize i = 0; i != owning.size(); ++i) {
+		y_test_assert(owning[i].data.size() == 1 && owning[i].data[0] == owning[i].key);
+		y_test_assert(!i || owning[i - 1].key <= owning[i].key);
+	}
+}
+
+}
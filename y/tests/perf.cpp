@@ -0,0 +1,232 @@
+/*******************************
+Copyright (c) 2016-2020 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+
+
+#include <y/test/test.h>
+#include <y/utils/perf.h>
+#include <y/io2/File.h>
+#include <y/utils/format.h>
+
+#include <thread>
+#include <chrono>
+#include <cstdio>
+#include <string_view>
+
+namespace {
+using namespace y;
+
+static usize count_occurrences(std::string_view str, std::string_view pattern) {
+	usize count = 0;
+	for(usize pos = str.find(pattern); pos != std::string_view::npos; pos = str.find(pattern, pos + 1)) {
+		++count;
+	}
+	return count;
+}
+
+y_test_func("perf zone ids") {
+	const perf::ZoneId a = perf::zone_id("perf test zone a");
+	const perf::ZoneId b = perf::zone_id("perf test zone b");
+	y_test_assert(a != b);
+	y_test_assert(perf::zone_id("perf test zone a") == a);
+	y_test_assert(perf::zone_id("perf test zone b(int)") == b);
+}
+
+static const perf::ZoneStats* find_stats(const perf::ZoneStatsSnapshot& snapshot, perf::ZoneId zone) {
+	for(const perf::ZoneStats& stats : snapshot.zones) {
+		if(stats.zone == zone) {
+			return &stats;
+		}
+	}
+	return nullptr;
+}
+
+y_test_func("perf zone stats") {
+	const bool enabled = perf::zone_stats_enabled();
+	perf::set_zone_stats_enabled(true);
+
+	const perf::ZoneId fast = perf::zone_id("perf test fast zone");
+	const perf::ZoneId slow = perf::zone_id("perf test slow zone");
+
+	perf::end_frame();
+
+	const auto record = [=] {
+		for(usize i = 0; i != 100; ++i) {
+			const perf::ScopedZone z(fast);
+		}
+		{
+			const perf::ScopedZone z(slow);
+			std::this_thread::sleep_for(std::chrono::milliseconds(2));
+		}
+	};
+
+	std::thread thread(record);
+	record();
+	thread.join();
+
+	perf::end_frame();
+
+	{
+		const perf::ZoneStatsSnapshot snapshot = perf::zone_stats();
+		y_test_assert(snapshot.frame_us > 0.0);
+
+		const perf::ZoneStats* fast_stats = find_stats(snapshot, fast);
+		const perf::ZoneStats* slow_stats = find_stats(snapshot, slow);
+		y_test_assert(fast_stats && slow_stats);
+
+		y_test_assert(fast_stats->count == 200);
+		y_test_assert(slow_stats->count == 2);
+		y_test_assert(fast_stats->name == "perf test fast zone");
+
+		y_test_assert(slow_stats->min_us >= 1000.0);
+		y_test_assert(slow_stats->min_us <= slow_stats->p50_us);
+		y_test_assert(slow_stats->p50_us <= slow_stats->p99_us);
+		y_test_assert(slow_stats->p99_us <= slow_stats->max_us);
+		y_test_assert(slow_stats->total_us >= slow_stats->max_us);
+		y_test_assert(fast_stats->max_us < slow_stats->min_us);
+
+		// Hottest first
+		y_test_assert(slow_stats < fast_stats);
+	}
+
+	// Stats are reset at the frame boundary
+	perf::end_frame();
+	y_test_assert(!find_stats(perf::zone_stats(), slow));
+
+	perf::set_zone_stats_enabled(false);
+	{
+		const perf::ScopedZone z(slow);
+	}
+	perf::end_frame();
+	y_test_assert(!find_stats(perf::zone_stats(), slow));
+
+	perf::set_zone_stats_enabled(enabled);
+}
+
+static std::string_view read_file(const core::String& filename, core::Vector<u8>& data) {
+	auto file = io2::File::open(filename);
+	if(!file || !file.unwrap().read_all(data)) {
+		return std::string_view();
+	}
+	return std::string_view(reinterpret_cast<const char*>(data.data()), data.size());
+}
+
+y_test_func("perf flight recorder") {
+	const perf::ZoneId frame_zone = perf::zone_id("perf test frame");
+	const perf::ZoneId spike_zone = perf::zone_id("perf test spike");
+
+	y_test_assert(perf::dump_recent().is_empty());
+
+	perf::FlightRecorderSettings settings;
+	settings.frame_count = 4;
+	settings.spike_threshold_ms = 50.0;
+	settings.output_prefix = "y_perf_test_flight";
+	perf::start_flight_recorder(settings);
+	y_test_assert(perf::is_flight_recording());
+
+	// Only the last frames are kept
+	for(usize i = 0; i != 10; ++i) {
+		const perf::ScopedZone z(frame_zone);
+		perf::end_frame();
+	}
+
+	{
+		const core::String filename = perf::dump_recent();
+		y_test_assert(!filename.is_empty());
+
+		core::Vector<u8> data;
+		const std::string_view json = read_file(filename, data);
+		y_test_assert(!json.empty());
+		y_test_assert(count_occurrences(json, R"("name":"perf test frame","cat":"","ph":"B")") == 3);
+		y_test_assert(count_occurrences(json, R"("name":"perf test frame","cat":"","ph":"E")") == 3);
+		std::remove(filename.data());
+	}
+
+	// Long frames are dumped automatically
+	{
+		const perf::ScopedZone z(spike_zone);
+		std::this_thread::sleep_for(std::chrono::milliseconds(100));
+	}
+	perf::end_frame();
+	const u64 spike_frame = perf::zone_stats().frame;
+
+	perf::stop_flight_recorder();
+	y_test_assert(!perf::is_flight_recording());
+	y_test_assert(perf::dump_recent().is_empty());
+
+	{
+		const core::String filename = core::String("y_perf_test_flight_") + core::String(fmt("%", spike_frame)) + ".json";
+		core::Vector<u8> data;
+		const std::string_view json = read_file(filename, data);
+		y_test_assert(!json.empty());
+		y_test_assert(count_occurrences(json, R"("name":"perf test spike","cat":"","ph":"B")") == 1);
+		y_test_assert(count_occurrences(json, R"("name":"perf test spike","cat":"","ph":"E")") == 1);
+		std::remove(filename.data());
+	}
+}
+
+y_test_func("perf capture") {
+	static constexpr usize zone_count = 1000;
+	const char* filename = "y_perf_test_capture.json";
+
+	perf::start_capture(filename);
+	y_test_assert(perf::is_capturing());
+
+	const auto record = [] {
+		const perf::ZoneId outer = perf::zone_id("perf test outer");
+		const perf::ZoneId inner = perf::zone_id("perf test \"inner\"");
+		for(usize i = 0; i != zone_count; ++i) {
+			const perf::ScopedZone o(outer);
+			const perf::ScopedZone n(inner);
+		}
+		perf::event("perf test event");
+		perf::counter("perf test counter", 42.5);
+	};
+
+	std::thread thread(record);
+	record();
+	thread.join();
+
+	perf::end_capture();
+	y_test_assert(!perf::is_capturing());
+
+	core::Vector<u8> data;
+	{
+		auto file = io2::File::open(filename);
+		y_test_assert(file);
+		y_test_assert(file.unwrap().read_all(data));
+	}
+	const std::string_view json(reinterpret_cast<const char*>(data.data()), data.size());
+
+	y_test_assert(json.substr(0, 16) == R"({"traceEvents":[)");
+	y_test_assert(json.substr(json.size() - 2) == "]}");
+	y_test_assert(count_occurrences(json, R"("name":"perf test outer","cat":"","ph":"B")") == 2 * zone_count);
+	y_test_assert(count_occurrences(json, R"("name":"perf test outer","cat":"","ph":"E")") == 2 * zone_count);
+	y_test_assert(count_occurrences(json, R"("name":"perf test 'inner'","cat":"","ph":"B")") == 2 * zone_count);
+	y_test_assert(count_occurrences(json, R"("name":"perf test event","cat":"","ph":"I")") == 2);
+	y_test_assert(count_occurrences(json, R"("name":"perf test counter","cat":"","ph":"C")") == 2);
+	y_test_assert(count_occurrences(json, R"("args":{"value":42.5}})") == 2);
+
+	std::remove(filename);
+	std::remove((core::String(filename) + ".bin").data());
+}
+
+}
@@ -0,0 +1,110 @@
+/*******************************
+Copyright (c) 2016-2020 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+
+
+#include <y/utils/sort.h>
+#include <y/core/Vector.h>
+#include <y/math/random.h>
+#include <y/test/test.h>
+
+namespace {
+using namespace y;
+
+enum class SortEnum : i16 {
+	A = -300,
+	B = 0,
+	C = 1024
+};
+
+template<typename T>
+static core::Vector<T> random_values(usize count, u32 seed) {
+	math::FastRandom rng(seed);
+	core::Vector<T> values;
+	for(usize i = 0; i != count; ++i) {
+		values << T(u64(rng()) << 32 | rng());
+	}
+	return values;
+}
+
+template<typename T>
+static bool check_sort(usize count) {
+	core::Vector<T> values = random_values<T>(count, u32(count));
+	core::Vector<T> expected = values;
+	std::sort(expected.begin(), expected.end());
+
+	core::Vector<T> radix = values;
+	radix_sort(radix.begin(), radix.end());
+	y::sort(values.begin(), values.end());
+
+	return radix == expected && values == expected;
+}
+
+y_test_func("radix_sort integers") {
+	for(usize count : {usize(0), usize(1), usize(17), usize(5000)}) {
+		y_test_assert(check_sort<u8>(count));
+		y_test_assert(check_sort<i16>(count));
+		y_test_assert(check_sort<u32>(count));
+		y_test_assert(check_sort<i32>(count));
+		y_test_assert(check_sort<u64>(count));
+		y_test_assert(check_sort<i64>(count));
+	}
+}
+
+y_test_func("radix_sort enums") {
+	core::Vector<SortEnum> values;
+	for(usize i = 0; i != 1000; ++i) {
+		values << (i % 3 == 0 ? SortEnum::C : i % 3 == 1 ? SortEnum::A : SortEnum::B);
+	}
+
+	radix_sort(values.begin(), values.end());
+	y_test_assert(values[0] == SortEnum::A);
+	y_test_assert(values[500] == SortEnum::B);
+	y_test_assert(values.last() == SortEnum::C);
+	y_test_assert(std::is_sorted(values.begin(), values.end()));
+}
+
+y_test_func("radix_sort key is stable") {
+	struct Item {
+		u32 key;
+		u32 index;
+	};
+
+	math::FastRandom rng(3);
+	core::Vector<Item> items;
+	for(u32 i = 0; i != 10000; ++i) {
+		items << Item{rng() % 64, i};
+	}
+
+	y::sort(items.begin(), items.end(), [](const Item& item) { return item.key; });
+	for(usize i = 1; i != items.size(); ++i) {
+		y_test_assert(items[i - 1].key <= items[i].key);
+		y_test_assert(items[i - 1].key != items[i].key || items[i - 1].index < items[i].index);
+	}
+
+	// Comparators still work
+	y::sort(items.begin(), items.end(), [](const Item& a, const Item& b) { return a.index < b.index; });
+	for(usize i = 0; i != items.size(); ++i) {
+		y_test_assert(items[i].index == i);
+	}
+}
+
+}
@@ -0,0 +1,291 @@
+/*******************************
+Copyright (c) 2016-2020 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+
+
+#include "bench.h"
+
+#include <y/utils/log.h>
+#include <y/utils/format.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+namespace y {
+namespace bench {
+namespace detail {
+
+static std::atomic<usize> allocations = 0;
+
+static BenchItem* first_bench = nullptr;
+static BenchItem* last_bench = nullptr;
+
+// Benchmarks run in declaration order
+void register_bench(BenchItem* bench) {
+	if(last_bench) {
+		last_bench->next = bench;
+	} else {
+		first_bench = bench;
+	}
+	last_bench = bench;
+}
+
+void count_allocation() {
+	allocations.fetch_add(1, std::memory_order_relaxed);
+}
+
+}
+
+
+usize allocation_count() {
+	return detail::allocations.load(std::memory_order_relaxed);
+}
+
+
+State::State(usize param, usize warmup, usize repetitions) : _param(param), _warmup(warmup), _repetitions(std::max(repetitions, usize(1))) {
+	_samples.set_min_capacity(_repetitions);
+}
+
+usize State::param() const {
+	return _param;
+}
+
+bool State::run() {
+	if(_running) {
+		stop_repetition();
+	}
+
+	if(_run_index == _warmup + _repetitions) {
+		return false;
+	}
+
+	_running = true;
+	_paused = false;
+	_elapsed_ns = 0.0;
+	_repetition_allocations = 0;
+	_allocation_start = allocation_count();
+	_chrono.reset();
+	return true;
+}
+
+void State::pause() {
+	y_debug_assert(_running && !_paused);
+	_elapsed_ns += double(_chrono.elapsed().to_nanos());
+	_repetition_allocations += allocation_count() - _allocation_start;
+	_paused = true;
+}
+
+void State::resume() {
+	y_debug_assert(_running && _paused);
+	_paused = false;
+	_allocation_start = allocation_count();
+	_chrono.reset();
+}
+
+void State::stop_repetition() {
+	if(!_paused) {
+		_elapsed_ns += double(_chrono.elapsed().to_nanos());
+		_repetition_allocations += allocation_count() - _allocation_start;
+	}
+	if(_run_index >= _warmup) {
+		_samples << _elapsed_ns;
+		_allocations += _repetition_allocations;
+	}
+	_running = false;
+	++_run_index;
+}
+
+void State::set_items_per_run(usize items) {
+	_items = std::max(items, usize(1));
+}
+
+usize State::items_per_run() const {
+	return _items;
+}
+
+core::Span<double> State::samples_ns() const {
+	return _samples;
+}
+
+usize State::allocations() const {
+	return _allocations;
+}
+
+
+BenchResult summarize(std::string_view name, usize param, const State& state) {
+	core::Vector<double> samples;
+	for(const double sample : state.samples_ns()) {
+		samples << sample / double(state.items_per_run());
+	}
+	std::sort(samples.begin(), samples.end());
+
+	BenchResult result;
+	result.name = name;
+	result.param = param;
+	result.repetitions = samples.size();
+	if(samples.is_empty()) {
+		return result;
+	}
+
+	result.allocations = double(state.allocations()) / double(samples.size() * state.items_per_run());
+
+	const usize count = samples.size();
+	result.min_ns = samples.first();
+	result.max_ns = samples.last();
+	result.median_ns = count % 2 ? samples[count / 2] : (samples[count / 2 - 1] + samples[count / 2]) * 0.5;
+
+	double total = 0.0;
+	for(const double sample : samples) {
+		total += sample;
+	}
+	result.mean_ns = total / double(count);
+
+	double variance = 0.0;
+	for(const double sample : samples) {
+		variance += (sample - result.mean_ns) * (sample - result.mean_ns);
+	}
+	result.stddev_ns = count > 1 ? std::sqrt(variance / double(count - 1)) : 0.0;
+
+	return result;
+}
+
+core::Vector<BenchResult> run_benches(const BenchSettings& settings) {
+	core::Vector<BenchResult> results;
+	for(const detail::BenchItem* bench = detail::first_bench; bench; bench = bench->next) {
+		const std::string_view name = bench->name;
+		if(!settings.filter.is_empty() && name.find(settings.filter.data()) == std::string_view::npos) {
+			continue;
+		}
+
+		const auto run_one = [&](usize param) {
+			State state(param, settings.warmup, settings.repetitions);
+			bench->bench_func(state);
+			y_always_assert(state.samples_ns().size() == settings.repetitions, "Benchmark did not loop on State::run()");
+
+			const BenchResult& result = results.emplace_back(summarize(name, param, state));
+			log_msg(fmt("%[%]: median %ns, min %ns, max %ns, stddev %ns, % allocations", result.name, result.param, result.median_ns, result.min_ns, result.max_ns, result.stddev_ns, result.allocations), Log::Perf);
+		};
+
+		if(bench->params.size()) {
+			for(const usize param : bench->params) {
+				run_one(param);
+			}
+		} else {
+			run_one(0);
+		}
+	}
+	return results;
+}
+
+
+// Names are written without escaping, keep quotes and backslashes out of them
+core::String to_json(core::Span<BenchResult> results) {
+	core::String json = "{\"benchmarks\":[\n";
+	char b[512] = {};
+	for(usize i = 0; i != results.size(); ++i) {
+		const BenchResult& r = results[i];
+		const int len = std::snprintf(b, sizeof(b), R"({"name":"%s","param":%llu,"repetitions":%llu,"min_ns":%.3f,"median_ns":%.3f,"mean_ns":%.3f,"stddev_ns":%.3f,"max_ns":%.3f,"allocations":%.3f}%s)",
+			r.name.data(), static_cast<unsigned long long>(r.param), static_cast<unsigned long long>(r.repetitions),
+			r.min_ns, r.median_ns, r.mean_ns, r.stddev_ns, r.max_ns, r.allocations, i + 1 == results.size() ? "\n" : ",\n");
+		json += std::string_view(b, std::min(usize(std::max(len, 0)), sizeof(b) - 1));
+	}
+	json += "]}\n";
+	return json;
+}
+
+core::Result<core::Vector<BenchResult>> from_json(std::string_view json) {
+	static constexpr std::string_view name_key = R"({"name":")";
+
+	const auto read_number = [](std::string_view object, std::string_view key, double& value) {
+		const usize pos = object.find(key);
+		if(pos == std::string_view::npos) {
+			return false;
+		}
+		const core::String number = object.substr(pos + key.size());
+		char* end = nullptr;
+		value = std::strtod(number.data(), &end);
+		return end != number.data();
+	};
+
+	core::Vector<BenchResult> results;
+	for(usize pos = json.find(name_key); pos != std::string_view::npos; pos = json.find(name_key, pos)) {
+		const usize end = json.find('}', pos);
+		if(end == std::string_view::npos) {
+			return core::Err();
+		}
+
+		const std::string_view object = json.substr(pos, end - pos);
+		const usize name_end = object.find('"', name_key.size());
+		if(name_end == std::string_view::npos) {
+			return core::Err();
+		}
+
+		BenchResult& result = results.emplace_back();
+		result.name = object.substr(name_key.size(), name_end - name_key.size());
+
+		double param = 0.0;
+		double repetitions = 0.0;
+		const bool ok =
+			read_number(object, R"("param":)", param) &&
+			read_number(object, R"("repetitions":)", repetitions) &&
+			read_number(object, R"("min_ns":)", result.min_ns) &&
+			read_number(object, R"("median_ns":)", result.median_ns) &&
+			read_number(object, R"("mean_ns":)", result.mean_ns) &&
+			read_number(object, R"("stddev_ns":)", result.stddev_ns) &&
+			read_number(object, R"("max_ns":)", result.max_ns);
+		if(!ok) {
+			return core::Err();
+		}
+
+		// Older baselines don't have it
+		read_number(object, R"("allocations":)", result.allocations);
+
+		result.param = usize(param);
+		result.repetitions = usize(repetitions);
+
+		pos = end;
+	}
+	return core::Ok(std::move(results));
+}
+
+core::Vector<BenchComparison> compare(core::Span<BenchResult> results, core::Span<BenchResult> baseline) {
+	core::Vector<BenchComparison> comparisons;
+	for(const BenchResult& result : results) {
+		const auto it = std::find_if(baseline.begin(), baseline.end(), [&](const BenchResult& b) {
+			return b.param == result.param && b.name == result.name;
+		});
+		if(it == baseline.end()) {
+			continue;
+		}
+
+		BenchComparison& comparison = comparisons.emplace_back();
+		comparison.result = &result;
+		comparison.baseline = it;
+		comparison.ratio = it->median_ns > 0.0 ? result.median_ns / it->median_ns : 1.0;
+	}
+	return comparisons;
+}
+
+}
+}
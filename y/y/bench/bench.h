@@ -0,0 +1,196 @@
+/*******************************
+Copyright (c) 2016-2020 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+
+#ifndef Y_BENCH_BENCH_H
+#define Y_BENCH_BENCH_H
+
+#include <y/core/Chrono.h>
+#include <y/core/Vector.h>
+#include <y/core/Result.h>
+
+#include <initializer_list>
+#include <string_view>
+
+#ifdef Y_MSVC
+#include <intrin.h>
+#endif
+
+namespace y {
+namespace bench {
+
+// Benchmarks loop on State::run(), every iteration is one timed repetition:
+//
+// y_bench_func("Vector push_back", 16, 1024) {
+//     while(state.run()) {
+//         ...
+//     }
+//     state.set_items_per_run(state.param());
+// }
+//
+// The first repetitions are warmups and are not part of the results
+class State : NonMovable {
+	public:
+		State(usize param, usize warmup, usize repetitions);
+
+		usize param() const;
+
+		bool run();
+
+		// Excludes setup code from the current repetition
+		void pause();
+		void resume();
+
+		// Results are reported per item
+		void set_items_per_run(usize items);
+		usize items_per_run() const;
+
+		core::Span<double> samples_ns() const;
+
+		// Over all timed repetitions, excluding warmups and paused sections
+		usize allocations() const;
+
+	private:
+		void stop_repetition();
+
+		usize _param = 0;
+		usize _warmup = 0;
+		usize _repetitions = 0;
+		usize _items = 1;
+
+		usize _run_index = 0;
+		bool _running = false;
+		bool _paused = false;
+		double _elapsed_ns = 0.0;
+		core::Chrono _chrono;
+
+		usize _allocations = 0;
+		usize _repetition_allocations = 0;
+		usize _allocation_start = 0;
+
+		core::Vector<double> _samples;
+};
+
+struct BenchResult {
+	core::String name;
+	usize param = 0;
+	usize repetitions = 0;
+
+	// Per item
+	double min_ns = 0.0;
+	double median_ns = 0.0;
+	double mean_ns = 0.0;
+	double stddev_ns = 0.0;
+	double max_ns = 0.0;
+
+	// Global allocations per item, 0 if the executable doesn't count them
+	double allocations = 0.0;
+};
+
+struct BenchSettings {
+	usize warmup = 2;
+	usize repetitions = 10;
+
+	// Only runs benchmarks whose name contains the filter
+	core::String filter;
+};
+
+struct BenchComparison {
+	const BenchResult* result = nullptr;
+	const BenchResult* baseline = nullptr;
+
+	// Of the median, > 1.0 is slower
+	double ratio = 0.0;
+};
+
+// Number of global allocations so far.
+// Only y_bench counts them (in its operator new), it is always 0 in other executables
+usize allocation_count();
+
+BenchResult summarize(std::string_view name, usize param, const State& state);
+
+core::Vector<BenchResult> run_benches(const BenchSettings& settings);
+
+// Only parses what to_json writes
+core::String to_json(core::Span<BenchResult> results);
+core::Result<core::Vector<BenchResult>> from_json(std::string_view json);
+
+// Results without a baseline are skipped
+core::Vector<BenchComparison> compare(core::Span<BenchResult> results, core::Span<BenchResult> baseline);
+
+
+template<typename T>
+inline void do_not_optimize(const T& value) {
+#ifdef Y_MSVC
+	static const volatile void* sink = nullptr;
+	sink = &value;
+	_ReadWriteBarrier();
+#else
+	asm volatile("" : : "r,m"(value) : "memory");
+#endif
+}
+
+
+namespace detail {
+struct BenchItem {
+	const char* name = "Unknown bench";
+	void (*bench_func)(State&) = nullptr;
+	std::initializer_list<usize> params;
+	BenchItem* next = nullptr;
+};
+
+void register_bench(BenchItem* bench);
+
+void count_allocation();
+}
+
+}
+}
+
+#define Y_BENCH_FUNC y_create_name_with_prefix(func)
+#define Y_BENCH_RUNNER y_create_name_with_prefix(runner)
+
+#ifdef Y_BUILD_BENCH
+
+// Extra arguments are the parameters the benchmark is run with, State::param() returns 0 if there are none
+#define y_bench_func(name, ...)																			\
+static void Y_BENCH_FUNC(y::bench::State&);																\
+namespace {																								\
+	class Y_BENCH_RUNNER {																				\
+		Y_BENCH_RUNNER() : bench_item({name, &Y_BENCH_FUNC, params, nullptr}) {							\
+			y::bench::detail::register_bench(&bench_item);												\
+		}																								\
+		y::bench::detail::BenchItem bench_item;															\
+		static constexpr std::initializer_list<usize> params = {__VA_ARGS__};							\
+		static Y_BENCH_RUNNER runner;																	\
+	};																									\
+	Y_BENCH_RUNNER Y_BENCH_RUNNER::runner = Y_BENCH_RUNNER();											\
+}																										\
+void Y_BENCH_FUNC(y::bench::State& state)
+
+#else
+
+#define y_bench_func(name, ...)																			\
+[[maybe_unused]] static void Y_BENCH_FUNC(y::bench::State& state)
+
+#endif
+
+#endif // Y_BENCH_BENCH_H
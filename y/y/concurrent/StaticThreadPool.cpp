@@ -30,55 +30,132 @@ namespace y {
 namespace concurrent {
 
 
+struct DependencyGroup::SharedData : NonMovable {
+	std::atomic<u32> counter = 1;
+
+	SpinLock lock;
+	core::Vector<std::pair<std::shared_ptr<StaticThreadPool::ParkHandle>, StaticThreadPool::FuncData>> parked;
+};
+
+
 bool DependencyGroup::is_ready() const {
 	return dependency_count() == 0;
 }
 
 bool DependencyGroup::is_expired() const {
-	return _counter != nullptr && (*_counter) == 0;
+	return _data != nullptr && _data->counter == 0;
 }
 
 u32 DependencyGroup::dependency_count() const {
-	return !_counter ? u32(0) : u32(*_counter);
+	return !_data ? u32(0) : u32(_data->counter);
 }
 
 void DependencyGroup::add_dependency() {
-	if(!_counter) {
-		_counter = std::make_shared<std::atomic<u32>>(1);
+	if(!_data) {
+		_data = std::make_shared<SharedData>();
 	} else {
-		++(*_counter);
+		++_data->counter;
 	}
 }
 
 void DependencyGroup::solve_dependency() {
-	if(_counter) {
-		y_debug_assert(*_counter != 0); // not 100% thread safe but we don't care
-		--(*_counter);
+	if(_data) {
+		y_debug_assert(_data->counter != 0); // not 100% thread safe but we don't care
+		if(--_data->counter == 0) {
+			decltype(_data->parked) ready;
+			{
+				const std::unique_lock lock(_data->lock);
+				ready.swap(_data->parked);
+			}
+			for(auto& [handle, task] : ready) {
+				StaticThreadPool::unpark(*handle, std::move(task));
+			}
+		}
 	}
 }
 
 
+static thread_local const StaticThreadPool* worker_pool = nullptr;
+static thread_local usize worker_index = 0;
+
+static constexpr usize idle_spin_count = 16;
+static constexpr usize injected_batch_size = 16;
+
+
 StaticThreadPool::FuncData::FuncData(Func func, DependencyGroup wait, DependencyGroup done) :
 		function(std::move(func)),
 		wait_for(std::move(wait)),
 		on_done(std::move(done)) {
 }
 
-StaticThreadPool::StaticThreadPool(usize thread_count, const char* thread_names) {
+
+void StaticThreadPool::WorkQueue::push_back(FuncData&& task) {
+	const std::unique_lock l(lock);
+	tasks.emplace_back(std::move(task));
+	size.store(tasks.size(), std::memory_order_relaxed);
+}
+
+bool StaticThreadPool::WorkQueue::pop_back(FuncData& task) {
+	if(!size.load(std::memory_order_relaxed)) {
+		return false;
+	}
+
+	const std::unique_lock l(lock);
+	if(tasks.empty()) {
+		return false;
+	}
+
+	task = std::move(tasks.back());
+	tasks.pop_back();
+	size.store(tasks.size(), std::memory_order_relaxed);
+	return true;
+}
+
+bool StaticThreadPool::WorkQueue::pop_front(FuncData& task) {
+	if(!size.load(std::memory_order_relaxed)) {
+		return false;
+	}
+
+	const std::unique_lock l(lock);
+	if(tasks.empty()) {
+		return false;
+	}
+
+	task = std::move(tasks.front());
+	tasks.pop_front();
+	size.store(tasks.size(), std::memory_order_relaxed);
+	return true;
+}
+
+
+StaticThreadPool::StaticThreadPool(usize thread_count, const char* thread_names) :
+		_park_handle(std::make_shared<ParkHandle>()),
+		_queues(thread_count),
+		_idle_spins(thread_count <= std::thread::hardware_concurrency() ? idle_spin_count : 0) {
+
+	_park_handle->pool = this;
+
 	for(usize i = 0; i != thread_count; ++i) {
-		_threads.emplace_back([thread_names, this] {
+		_threads.emplace_back([thread_names, i, this] {
 			concurrent::set_thread_name(thread_names);
-			worker();
+			worker(i);
 		});
 	}
 }
 
 StaticThreadPool::~StaticThreadPool() {
-	_shared_data.run = false;
+	{
+		const std::unique_lock lock(_shared_data.lock);
+		_shared_data.run = false;
+	}
 	_shared_data.condition.notify_all();
 	for(auto& thread : _threads) {
 		thread.join();
 	}
+
+	// Tasks still parked stay with their group, which drops them when solved
+	const std::unique_lock lock(_park_handle->lock);
+	_park_handle->pool = nullptr;
 }
 
 usize StaticThreadPool::concurency() const {
@@ -86,68 +163,201 @@ usize StaticThreadPool::concurency() const {
 }
 
 usize StaticThreadPool::pending_tasks() const {
-	const std::unique_lock lock(_shared_data.lock);
-	return _shared_data.queue.size();
+	return _shared_data.pending + _shared_data.waiting_count;
 }
 
 void StaticThreadPool::process_until_empty() {
-	while(true) {
-		std::unique_lock<std::mutex> lock(_shared_data.lock);
-		if(!process_one(std::move(lock))) {
-			break;
-		}
+	WorkQueue* local = local_queue();
+	while(process_one(local)) {
 		// Nothing
 	}
 }
 
-void StaticThreadPool::schedule(Func&& func, DependencyGroup* on_done, DependencyGroup wait_for) {
-	{
-		const std::unique_lock lock(_shared_data.lock);
-		if(on_done) {
-			on_done->add_dependency();
-			_shared_data.queue.emplace_back(std::move(func), std::move(wait_for), *on_done);
-		} else {
-			_shared_data.queue.emplace_back(std::move(func), std::move(wait_for));
+void StaticThreadPool::process_until_complete(const DependencyGroup& group) {
+	WorkQueue* local = local_queue();
+	while(!group.is_ready()) {
+		if(!process_one(local)) {
+			std::this_thread::yield();
 		}
 	}
+}
 
-	if(concurency()) {
-		_shared_data.condition.notify_one();
-	} else {
+void StaticThreadPool::schedule(Func&& func, DependencyGroup* on_done, DependencyGroup wait_for) {
+	FuncData task = on_done
+		? (on_done->add_dependency(), FuncData(std::move(func), std::move(wait_for), *on_done))
+		: FuncData(std::move(func), std::move(wait_for));
+
+	if(!park(task)) {
+		push(std::move(task));
+	}
+
+	if(!concurency()) {
 		process_until_empty();
 	}
 }
 
-bool StaticThreadPool::process_one(std::unique_lock<std::mutex> lock) {
-	y_profile();
-	for(auto it = _shared_data.queue.begin(); it != _shared_data.queue.end(); ++it) {
-		if(it->wait_for.is_ready()) {
-			auto f = std::move(*it);
-			_shared_data.queue.erase(it);
-			lock.unlock();
+StaticThreadPool::WorkQueue* StaticThreadPool::local_queue() {
+	return worker_pool == this ? &_queues[worker_index] : nullptr;
+}
 
-			{
-				y_profile_zone("exec");
-				f.function();
-			}
-			{
-				f.on_done.solve_dependency();
-				if(f.on_done.is_ready()) {
-					_shared_data.condition.notify_one();
+void StaticThreadPool::push(FuncData&& task) {
+	++_shared_data.pending;
+
+	if(WorkQueue* local = local_queue()) {
+		local->push_back(std::move(task));
+	} else {
+		_shared_data.injected.push_back(std::move(task));
+	}
+
+	wake_one();
+}
+
+bool StaticThreadPool::park(FuncData& task) {
+	if(task.wait_for.is_ready()) {
+		return false;
+	}
+
+	// The group doesn't need to be kept alive by the task: it owns it while parked
+	const DependencyGroup wait_for = std::move(task.wait_for);
+	DependencyGroup::SharedData& data = *wait_for._data;
+
+	const std::unique_lock lock(data.lock);
+	// The last dependency might have been solved before we took the lock
+	if(data.counter == 0) {
+		return false;
+	}
+
+	++_shared_data.waiting_count;
+	data.parked.emplace_back(_park_handle, std::move(task));
+	return true;
+}
+
+void StaticThreadPool::unpark(ParkHandle& handle, FuncData&& task) {
+	const std::unique_lock lock(handle.lock);
+	if(StaticThreadPool* pool = handle.pool) {
+		--pool->_shared_data.waiting_count;
+		pool->push(std::move(task));
+	}
+}
+
+bool StaticThreadPool::pop(WorkQueue* local, FuncData& task) {
+	if(local && local->pop_back(task)) {
+		return true;
+	}
+	return pop_injected(local, task) || steal(local, task);
+}
+
+bool StaticThreadPool::pop_injected(WorkQueue* local, FuncData& task) {
+	WorkQueue& injected = _shared_data.injected;
+	if(!injected.size.load(std::memory_order_relaxed)) {
+		return false;
+	}
+
+	usize batch = 0;
+	{
+		const std::unique_lock lock(injected.lock);
+		if(injected.tasks.empty()) {
+			return false;
+		}
+
+		task = std::move(injected.tasks.front());
+		injected.tasks.pop_front();
+
+		// Grab a fair share of the injected tasks to avoid hammering the shared queue
+		if(local) {
+			batch = std::min(injected.tasks.size() / _queues.size(), injected_batch_size);
+			if(batch) {
+				const std::unique_lock local_lock(local->lock);
+				for(usize i = 0; i != batch; ++i) {
+					// Push at the front so the owner still processes them in FIFO order
+					local->tasks.emplace_front(std::move(injected.tasks.front()));
+					injected.tasks.pop_front();
 				}
+				local->size.store(local->tasks.size(), std::memory_order_relaxed);
 			}
+		}
+
+		injected.size.store(injected.tasks.size(), std::memory_order_relaxed);
+	}
+
+	if(batch) {
+		wake_one();
+	}
+
+	return true;
+}
+
+bool StaticThreadPool::steal(WorkQueue* local, FuncData& task) {
+	const usize queue_count = _queues.size();
+	const usize start = local ? usize(local - _queues.data()) + 1 : 0;
+	for(usize i = 0; i != queue_count; ++i) {
+		WorkQueue& victim = _queues[(start + i) % queue_count];
+		if(&victim != local && victim.pop_front(task)) {
 			return true;
 		}
 	}
+	return false;
+}
 
+bool StaticThreadPool::process_one(WorkQueue* local) {
+	FuncData task(Func{}, DependencyGroup{});
+	if(pop(local, task)) {
+		execute(task);
+		return true;
+	}
 	return false;
 }
 
-void StaticThreadPool::worker() {
+void StaticThreadPool::execute(FuncData& task) {
+	y_profile();
+	--_shared_data.pending;
+
+	{
+		y_profile_zone("exec");
+		task.function();
+	}
+
+	task.on_done.solve_dependency();
+}
+
+void StaticThreadPool::wake_one() {
+	++_shared_data.epoch;
+	if(_shared_data.sleeping) {
+		// Locking guarantees that the sleeping thread is actually waiting
+		const std::unique_lock lock(_shared_data.lock);
+		_shared_data.condition.notify_one();
+	}
+}
+
+void StaticThreadPool::worker(usize index) {
+	worker_pool = this;
+	worker_index = index;
+
+	WorkQueue* local = &_queues[index];
 	while(_shared_data.run) {
-		std::unique_lock<std::mutex> lock(_shared_data.lock);
-		_shared_data.condition.wait(lock, [&] { return !_shared_data.queue.empty() || !_shared_data.run; });
-		process_one(std::move(lock));
+		const u64 epoch = _shared_data.epoch;
+
+		if(process_one(local)) {
+			continue;
+		}
+
+		// Stay awake for a little while before parking: tasks usually come in bursts
+		bool found = false;
+		for(usize i = 0; i != _idle_spins && !found; ++i) {
+			std::this_thread::yield();
+			found = process_one(local);
+		}
+
+		if(found) {
+			continue;
+		}
+
+		{
+			std::unique_lock lock(_shared_data.lock);
+			++_shared_data.sleeping;
+			_shared_data.condition.wait(lock, [&] { return epoch != _shared_data.epoch || !_shared_data.run; });
+			--_shared_data.sleeping;
+		}
 	}
 }
 
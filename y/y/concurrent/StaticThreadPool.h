@@ -24,10 +24,12 @@ SOFTWARE.
 
 #include <y/core/Functor.h>
 #include <y/core/Vector.h>
+#include <y/core/FixedArray.h>
 
 #include "concurrent.h"
+#include "SpinLock.h"
 
-#include <list>
+#include <deque>
 #include <thread>
 #include <mutex>
 #include <atomic>
@@ -50,16 +52,23 @@ class DependencyGroup {
 	private:
 		friend class StaticThreadPool;
 
+		// Holds the counter and the tasks parked until it reaches zero
+		struct SharedData;
+
 		void add_dependency();
 		void solve_dependency();
 
-		std::shared_ptr<std::atomic<u32>> _counter;
+		std::shared_ptr<SharedData> _data;
 };
 
 class StaticThreadPool : NonMovable {
 	private:
+		friend class DependencyGroup;
+
 		using Func = core::Function<void()>;
 
+		static constexpr usize cache_line_size = 64;
+
 		struct FuncData {
 			FuncData(Func func, DependencyGroup wait, DependencyGroup done = DependencyGroup());
 
@@ -68,19 +77,46 @@ class StaticThreadPool : NonMovable {
 			DependencyGroup on_done;
 		};
 
+		// Owner pushes and pops at the back, thieves steal from the front
+		struct alignas(cache_line_size) WorkQueue : NonMovable {
+			SpinLock lock;
+			std::deque<FuncData> tasks;
+			std::atomic<usize> size = 0;
+
+			void push_back(FuncData&& task);
+			bool pop_back(FuncData& task);
+			bool pop_front(FuncData& task);
+		};
+
 		struct SharedData {
-			mutable std::mutex lock;
+			std::mutex lock;
 			std::condition_variable condition;
 
-			std::list<FuncData> queue;
+			std::atomic<u64> epoch = 0;
+			std::atomic<u32> sleeping = 0;
+			std::atomic<usize> pending = 0;
+
+			// Tasks scheduled from outside the pool, in FIFO order
+			WorkQueue injected;
+
+			// Tasks parked on a DependencyGroup
+			std::atomic<usize> waiting_count = 0;
 
 			std::atomic<bool> run = true;
 		};
 
+		// Parked tasks reach their pool through this, it is reset when the pool is destroyed so that late unparks drop the task
+		struct ParkHandle : NonMovable {
+			SpinLock lock;
+			StaticThreadPool* pool = nullptr;
+		};
+
 	public:
 
 		// Thread names must have static storage
 		StaticThreadPool(usize thread_count = std::max(4u, std::thread::hardware_concurrency()), const char* thread_names = nullptr);
+
+		// Pending tasks are dropped, as are tasks still parked on a DependencyGroup once it is solved
 		~StaticThreadPool();
 
 		usize concurency() const;
@@ -89,22 +125,48 @@ class StaticThreadPool : NonMovable {
 		// Empty means all tasks are scheduled, not done!
 		void process_until_empty();
 
+		// Runs other tasks while waiting, so it is safe to call from inside a task
+		void process_until_complete(const DependencyGroup& group);
+
 		void schedule(Func&& func, DependencyGroup* on_done = nullptr, DependencyGroup wait_for = DependencyGroup());
 
 		template<typename F, typename R = decltype(std::declval<F>()())>
 		std::future<R> schedule_with_future(F&& func, DependencyGroup* on_done = nullptr, DependencyGroup wait_for = DependencyGroup()) {
-			struct { mutable std::promise<R> promise; } box;
-			auto future = box.promise.get_future();
-			schedule([b = std::move(box), f = y_fwd(func)]() { b.promise.set_value(f()); }, on_done, wait_for);
+			std::promise<R> promise;
+			auto future = promise.get_future();
+			schedule([p = std::move(promise), f = y_fwd(func)]() mutable {
+				if constexpr(std::is_void_v<R>) {
+					f();
+					p.set_value();
+				} else {
+					p.set_value(f());
+				}
+			}, on_done, wait_for);
 			return future;
 		}
 
 	private:
-		bool process_one(std::unique_lock<std::mutex> lock);
-		void worker();
+		WorkQueue* local_queue();
+
+		void push(FuncData&& task);
+		bool park(FuncData& task);
+		static void unpark(ParkHandle& handle, FuncData&& task);
+
+		bool pop(WorkQueue* local, FuncData& task);
+		bool pop_injected(WorkQueue* local, FuncData& task);
+		bool steal(WorkQueue* local, FuncData& task);
+
+		bool process_one(WorkQueue* local);
+		void execute(FuncData& task);
+
+		void wake_one();
+		void worker(usize index);
 
 		SharedData _shared_data;
+		std::shared_ptr<ParkHandle> _park_handle;
+		core::FixedArray<WorkQueue> _queues;
 		core::Vector<std::thread> _threads;
+		usize _idle_spins = 0;
 };
 
 class WorkerThread : public StaticThreadPool {
@@ -0,0 +1,302 @@
+/*******************************
+Copyright (c) 2016-2020 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+
+#ifndef Y_CONCURRENT_PARALLEL_H
+#define Y_CONCURRENT_PARALLEL_H
+
+#include "StaticThreadPool.h"
+
+#include <y/utils/sort.h>
+
+namespace y {
+namespace concurrent {
+
+namespace detail {
+// Aim for a few chunks per participating thread so that uneven chunks can be balanced out
+static constexpr usize parallel_chunks_per_thread = 4;
+
+struct ParallelSplit {
+	usize chunk_size = 0;
+	usize chunk_count = 0;
+};
+
+inline ParallelSplit parallel_split(usize size, usize grain, usize concurency) {
+	const usize target_count = (concurency + 1) * parallel_chunks_per_thread;
+	const usize chunk_size = std::max({usize(1), grain, (size + target_count - 1) / target_count});
+	return {chunk_size, (size + chunk_size - 1) / chunk_size};
+}
+
+// Calls func(chunk_index, begin, end) for every chunk, the calling thread takes part in the work
+template<typename F>
+void parallel_chunks(StaticThreadPool& pool, usize size, ParallelSplit split, F&& func) {
+	if(!pool.concurency() || split.chunk_count <= 1) {
+		for(usize c = 0; c != split.chunk_count; ++c) {
+			const usize begin = c * split.chunk_size;
+			func(c, begin, std::min(begin + split.chunk_size, size));
+		}
+		return;
+	}
+
+	std::atomic<usize> next_chunk = 0;
+	const auto process_chunks = [&] {
+		for(usize c = next_chunk++; c < split.chunk_count; c = next_chunk++) {
+			const usize begin = c * split.chunk_size;
+			func(c, begin, std::min(begin + split.chunk_size, size));
+		}
+	};
+
+	DependencyGroup group;
+	// Helpers reference our stack, we must wait for them even if func throws
+	y_defer(pool.process_until_complete(group));
+
+	const usize helper_count = std::min(pool.concurency(), split.chunk_count - 1);
+	for(usize i = 0; i != helper_count; ++i) {
+		pool.schedule([&process_chunks] { process_chunks(); }, &group);
+	}
+
+	process_chunks();
+}
+}
+
+
+// Calls func(begin, end) on disjoint sub-ranges of [0, size) of at least grain elements
+template<typename F>
+void parallel_for_chunks(usize size, usize grain, F&& func, StaticThreadPool& pool = default_thread_pool()) {
+	if(!size) {
+		return;
+	}
+	const detail::ParallelSplit split = detail::parallel_split(size, grain, pool.concurency());
+	detail::parallel_chunks(pool, size, split, [&](usize, usize begin, usize end) { func(begin, end); });
+}
+
+// Range must be random access: Span, Vector, or any core::Range (like ecs::ComponentView)
+template<typename R, typename F>
+void parallel_for(R&& range, usize grain, F&& func, StaticThreadPool& pool = default_thread_pool()) {
+	const auto beg = range.begin();
+	const usize size = usize(range.end() - beg);
+
+	parallel_for_chunks(size, grain, [&](usize begin, usize end) {
+		auto it = beg + begin;
+		for(usize i = begin; i != end; ++i, ++it) {
+			func(*it);
+		}
+	}, pool);
+}
+
+// func(T, element) -> T folds a chunk, combine(T, T) -> T merges chunks results in order
+template<typename R, typename T, typename F, typename C>
+T parallel_reduce(R&& range, usize grain, T init, F&& func, C&& combine, StaticThreadPool& pool = default_thread_pool()) {
+	const auto beg = range.begin();
+	const usize size = usize(range.end() - beg);
+	if(!size) {
+		return init;
+	}
+
+	const detail::ParallelSplit split = detail::parallel_split(size, grain, pool.concurency());
+	core::Vector<T> partials(split.chunk_count, init);
+
+	detail::parallel_chunks(pool, size, split, [&](usize chunk, usize begin, usize end) {
+		T acc = partials[chunk];
+		auto it = beg + begin;
+		for(usize i = begin; i != end; ++i, ++it) {
+			acc = func(std::move(acc), *it);
+		}
+		partials[chunk] = std::move(acc);
+	});
+
+	T result = std::move(partials[0]);
+	for(usize i = 1; i != partials.size(); ++i) {
+		result = combine(std::move(result), std::move(partials[i]));
+	}
+	return result;
+}
+
+
+namespace detail {
+// Below this, sorting on a single thread is faster than splitting the work
+static constexpr usize parallel_sort_threshold = 64 * 1024;
+
+// Number of elements of a that come before the k-th element of merge(a, b), ties go to a like std::merge
+template<typename T, typename Compare>
+usize merge_split(const T* a, usize a_size, const T* b, usize b_size, usize k, Compare& comp) {
+	usize lo = k > b_size ? k - b_size : 0;
+	usize hi = std::min(k, a_size);
+	while(lo < hi) {
+		const usize i = (lo + hi) / 2;
+		if(!comp(b[k - i - 1], a[i])) {
+			lo = i + 1;
+		} else {
+			hi = i;
+		}
+	}
+	return lo;
+}
+
+// Writes elements [out_begin, out_end) of merge(a, b) into out
+template<typename T, typename Compare>
+void merge_slice(T* a, usize a_size, T* b, usize b_size, T* out, usize out_begin, usize out_end, Compare& comp) {
+	const usize a_begin = merge_split(a, a_size, b, b_size, out_begin, comp);
+	const usize a_end = merge_split(a, a_size, b, b_size, out_end, comp);
+	std::merge(std::make_move_iterator(a + a_begin), std::make_move_iterator(a + a_end),
+			   std::make_move_iterator(b + (out_begin - a_begin)), std::make_move_iterator(b + (out_end - a_end)),
+			   out + out_begin, comp);
+}
+
+// Every pass builds one histogram per chunk, then each chunk scatters its elements in parallel
+// Chunks are laid out in order within each bucket which keeps the sort stable
+template<typename T, typename Key>
+void parallel_radix_sort(T* data, usize size, Key& key, StaticThreadPool& pool) {
+	using key_type = decltype(y::detail::radix_key(key(*data)));
+
+	const ParallelSplit split = parallel_split(size, parallel_sort_threshold / 4, pool.concurency());
+	core::Vector<std::array<usize, 256>> histograms(split.chunk_count, std::array<usize, 256>{});
+
+	const y::detail::SortScratch<T> scratch(data, size);
+	T* src = data;
+	T* dst = scratch.data();
+
+	for(usize shift = 0; shift != sizeof(key_type) * 8; shift += 8) {
+		const auto digit = [&](const T& t) {
+			return usize(y::detail::radix_key(key(t)) >> shift) & 0xFF;
+		};
+
+		parallel_chunks(pool, size, split, [&](usize chunk, usize begin, usize end) {
+			std::array<usize, 256>& histogram = histograms[chunk];
+			histogram.fill(0);
+			for(usize i = begin; i != end; ++i) {
+				++histogram[digit(src[i])];
+			}
+		});
+
+		usize first_digit_count = 0;
+		const usize first_digit = digit(*src);
+		for(const auto& histogram : histograms) {
+			first_digit_count += histogram[first_digit];
+		}
+		if(first_digit_count == size) {
+			continue;
+		}
+
+		usize offset = 0;
+		for(usize b = 0; b != 256; ++b) {
+			for(auto& histogram : histograms) {
+				const usize count = histogram[b];
+				histogram[b] = offset;
+				offset += count;
+			}
+		}
+
+		parallel_chunks(pool, size, split, [&](usize chunk, usize begin, usize end) {
+			std::array<usize, 256>& offsets = histograms[chunk];
+			for(usize i = begin; i != end; ++i) {
+				dst[offsets[digit(src[i])]++] = src[i];
+			}
+		});
+		std::swap(src, dst);
+	}
+
+	if(src != data) {
+		parallel_chunks(pool, size, split, [&](usize, usize begin, usize end) {
+			std::copy(src + begin, src + end, data + begin);
+		});
+	}
+}
+}
+
+// Sorting by an integral key uses a parallel radix sort
+// Otherwise chunks are sorted with y::sort then merged in parallel, merges are split along their output
+// so every round keeps all threads busy. It must be contiguous.
+// f is either a comparator or a key extractor, like for y::sort
+template<typename It, typename F>
+void parallel_sort(It begin, It end, F&& f, StaticThreadPool& pool = default_thread_pool()) {
+	using value_type = remove_cvref_t<decltype(*begin)>;
+	const usize size = usize(end - begin);
+	if(size < detail::parallel_sort_threshold || !pool.concurency()) {
+		y::sort(begin, end, f);
+		return;
+	}
+
+	value_type* data = y::detail::contiguous_data(begin);
+
+	if constexpr(std::is_invocable_v<F&, const value_type&>) {
+		using key_type = remove_cvref_t<std::invoke_result_t<F&, const value_type&>>;
+		if constexpr(y::detail::is_radix_sortable_v<value_type, key_type>) {
+			detail::parallel_radix_sort(data, size, f, pool);
+			return;
+		}
+	}
+
+	auto comp = [&](const value_type& a, const value_type& b) {
+		if constexpr(std::is_invocable_v<F&, const value_type&>) {
+			return f(a) < f(b);
+		} else {
+			return f(a, b);
+		}
+	};
+
+	const detail::ParallelSplit split = detail::parallel_split(size, detail::parallel_sort_threshold / 4, pool.concurency());
+	detail::parallel_chunks(pool, size, split, [&](usize, usize chunk_begin, usize chunk_end) {
+		y::sort(data + chunk_begin, data + chunk_end, f);
+	});
+
+	if(split.chunk_count <= 1) {
+		return;
+	}
+
+	const y::detail::SortScratch<value_type> scratch(data, size);
+	value_type* src = scratch.holds_elements ? scratch.data() : data;
+	value_type* dst = scratch.holds_elements ? data : scratch.data();
+
+	const usize merge_grain = split.chunk_size / 2;
+	for(usize width = split.chunk_size; width < size; width *= 2) {
+		parallel_for_chunks(size, merge_grain, [&](usize slice_begin, usize slice_end) {
+			while(slice_begin != slice_end) {
+				const usize pair_begin = slice_begin / (2 * width) * (2 * width);
+				const usize mid = std::min(pair_begin + width, size);
+				const usize pair_end = std::min(pair_begin + 2 * width, size);
+				const usize merge_end = std::min(slice_end, pair_end);
+
+				detail::merge_slice(src + pair_begin, mid - pair_begin, src + mid, pair_end - mid,
+									dst + pair_begin, slice_begin - pair_begin, merge_end - pair_begin, comp);
+
+				slice_begin = merge_end;
+			}
+		}, pool);
+		std::swap(src, dst);
+	}
+
+	if(src != data) {
+		parallel_for_chunks(size, merge_grain, [&](usize copy_begin, usize copy_end) {
+			std::move(src + copy_begin, src + copy_end, data + copy_begin);
+		}, pool);
+	}
+}
+
+template<typename It>
+void parallel_sort(It begin, It end, StaticThreadPool& pool = default_thread_pool()) {
+	parallel_sort(begin, end, [](const auto& v) -> const auto& { return v; }, pool);
+}
+
+}
+}
+
+#endif // Y_CONCURRENT_PARALLEL_H
@@ -26,14 +26,81 @@ SOFTWARE.
 #include <y/utils/traits.h>
 
 #include <memory>
+#include <new>
+#include <cstddef>
 
 #define Y_NON_CONST_FUNCTORS
 
 namespace y {
 namespace core {
 
+// Function is exactly one cache line with the default inline size
+static constexpr usize function_inline_size = 64 - sizeof(void*);
+
 namespace detail {
 
+template<typename Ret, typename... Args>
+struct FunctionVTable {
+	Ret (*invoke)(void*, Args...);
+	void (*relocate)(void*, void*);
+	void (*destroy)(void*);
+};
+
+template<typename T, usize Size>
+inline constexpr bool is_function_inline_v =
+	sizeof(T) <= Size &&
+	alignof(T) <= alignof(std::max_align_t) &&
+	std::is_nothrow_move_constructible_v<T>;
+
+// Inline storage holds the callable, heap storage holds a pointer to it
+template<typename T, bool Inline, typename Ret, typename... Args>
+struct FunctionStorage {
+	static T* get(void* storage) {
+		if constexpr(Inline) {
+			return static_cast<T*>(storage);
+		} else {
+			return *static_cast<T**>(storage);
+		}
+	}
+
+	template<typename F>
+	static void create(void* storage, F&& func) {
+		if constexpr(Inline) {
+			::new(storage) T(y_fwd(func));
+		} else {
+			::new(storage) T*(new T(y_fwd(func)));
+		}
+	}
+
+	static Ret invoke(void* storage, Args... args) {
+		if constexpr(std::is_void_v<Ret>) {
+			(*get(storage))(y_fwd(args)...);
+		} else {
+			return (*get(storage))(y_fwd(args)...);
+		}
+	}
+
+	static void relocate(void* dst, void* src) {
+		if constexpr(Inline) {
+			T* src_func = get(src);
+			::new(dst) T(std::move(*src_func));
+			src_func->~T();
+		} else {
+			::new(dst) T*(get(src));
+		}
+	}
+
+	static void destroy(void* storage) {
+		if constexpr(Inline) {
+			get(storage)->~T();
+		} else {
+			delete get(storage);
+		}
+	}
+
+	static constexpr FunctionVTable<Ret, Args...> vtable = {&invoke, &relocate, &destroy};
+};
+
 template<typename Ret, typename... Args>
 struct FunctionBase : NonCopyable {
 	FunctionBase() {
@@ -151,8 +218,79 @@ class Functor<Container, Ret(Args...)> {
 
 
 
-template<typename Ret, typename... Args>
-using Function = detail::Functor<std::unique_ptr, Ret, Args...>;
+// Move only, callables that fit in InlineSize bytes are stored in place without allocating
+template<typename Signature, usize InlineSize = function_inline_size>
+class Function {};
+
+template<typename Ret, typename... Args, usize InlineSize>
+class Function<Ret(Args...), InlineSize> : NonCopyable {
+
+	template<typename T>
+	using storage_type = detail::FunctionStorage<T, detail::is_function_inline_v<T, InlineSize>, Ret, Args...>;
+
+	static_assert(InlineSize >= sizeof(void*), "Function needs room for at least a pointer");
+
+	public:
+		static constexpr usize inline_size = InlineSize;
+
+		template<typename T>
+		static constexpr bool is_inline = detail::is_function_inline_v<std::decay_t<T>, InlineSize>;
+
+		Function() = default;
+
+		template<typename T,
+				 typename = std::enable_if_t<!std::is_same_v<std::decay_t<T>, Function>>>
+		Function(T&& func) {
+			using storage = storage_type<std::decay_t<T>>;
+			storage::create(_storage, y_fwd(func));
+			_vtable = &storage::vtable;
+		}
+
+		Function(Function&& other) {
+			move_from(other);
+		}
+
+		Function& operator=(Function&& other) {
+			if(&other != this) {
+				reset();
+				move_from(other);
+			}
+			return *this;
+		}
+
+		~Function() {
+			reset();
+		}
+
+		bool is_empty() const {
+			return !_vtable;
+		}
+
+		// Like std::function, calling a const Function may mutate the callable
+		Ret operator()(Args... args) const {
+			y_debug_assert(_vtable);
+			return _vtable->invoke(_storage, y_fwd(args)...);
+		}
+
+	private:
+		void move_from(Function& other) {
+			if(other._vtable) {
+				other._vtable->relocate(_storage, other._storage);
+				_vtable = other._vtable;
+				other._vtable = nullptr;
+			}
+		}
+
+		void reset() {
+			if(_vtable) {
+				_vtable->destroy(_storage);
+				_vtable = nullptr;
+			}
+		}
+
+		alignas(std::max_align_t) mutable u8 _storage[InlineSize];
+		const detail::FunctionVTable<Ret, Args...>* _vtable = nullptr;
+};
 
 template<typename Ret, typename... Args>
 using Functor = detail::Functor<std::shared_ptr, Ret, Args...>;
@@ -0,0 +1,186 @@
+/*******************************
+Copyright (c) 2016-2020 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+
+
+#include "Name.h"
+#include "String.h"
+#include "Vector.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <cstring>
+
+namespace y {
+namespace core {
+
+using detail::NameEntry;
+
+// Open addressing table of entries.
+// Lookups never lock: a table is immutable once it has been replaced and replaced tables are kept alive.
+// Inserting into the current table only fills empty slots, a lookup that misses the new entry falls back on the locked path.
+class NameTable : NonMovable {
+	static constexpr usize min_slot_count = 1024;
+	static constexpr usize page_size = 64 * 1024;
+
+	struct Slots {
+		Slots(usize size) : mask(size - 1), entries(std::make_unique<std::atomic<const NameEntry*>[]>(size)) {
+			y_debug_assert(size && !(size & mask));
+		}
+
+		usize size() const {
+			return mask + 1;
+		}
+
+		const usize mask;
+		std::unique_ptr<std::atomic<const NameEntry*>[]> entries;
+	};
+
+	public:
+		NameTable() {
+			auto& slots = _tables.emplace_back(std::make_unique<Slots>(min_slot_count));
+			_slots.store(slots.get(), std::memory_order_release);
+			_empty = intern(std::string_view());
+		}
+
+		const NameEntry* empty() const {
+			return _empty;
+		}
+
+		const NameEntry* find(std::string_view str, usize hash) const {
+			const Slots* slots = _slots.load(std::memory_order_acquire);
+			for(usize i = hash & slots->mask;; i = (i + 1) & slots->mask) {
+				const NameEntry* entry = slots->entries[i].load(std::memory_order_acquire);
+				if(!entry) {
+					return nullptr;
+				}
+				if(entry->hash == hash && entry->size == str.size() && std::string_view(entry->data(), entry->size) == str) {
+					return entry;
+				}
+			}
+		}
+
+		const NameEntry* intern(std::string_view str) {
+			const usize hash = std::hash<std::string_view>()(str);
+			if(const NameEntry* entry = find(str, hash)) {
+				return entry;
+			}
+
+			const std::unique_lock lock(_lock);
+			if(const NameEntry* entry = find(str, hash)) {
+				return entry;
+			}
+
+			Slots* slots = _slots.load(std::memory_order_relaxed);
+			if((_count + 1) * 2 > slots->size()) {
+				slots = grow(slots);
+			}
+
+			const NameEntry* entry = create_entry(str, hash);
+			insert(*slots, entry);
+			++_count;
+			return entry;
+		}
+
+	private:
+		static void insert(Slots& slots, const NameEntry* entry) {
+			for(usize i = entry->hash & slots.mask;; i = (i + 1) & slots.mask) {
+				if(!slots.entries[i].load(std::memory_order_relaxed)) {
+					slots.entries[i].store(entry, std::memory_order_release);
+					return;
+				}
+			}
+		}
+
+		Slots* grow(const Slots* old) {
+			auto& slots = _tables.emplace_back(std::make_unique<Slots>(old->size() * 2));
+			for(usize i = 0; i != old->size(); ++i) {
+				if(const NameEntry* entry = old->entries[i].load(std::memory_order_relaxed)) {
+					insert(*slots, entry);
+				}
+			}
+			_slots.store(slots.get(), std::memory_order_release);
+			return slots.get();
+		}
+
+		const NameEntry* create_entry(std::string_view str, usize hash) {
+			const usize size = (sizeof(NameEntry) + str.size() + 1 + alignof(NameEntry) - 1) & ~(alignof(NameEntry) - 1);
+			if(_page_offset + size > _page_size) {
+				_page_size = std::max(page_size, size);
+				_pages.emplace_back(std::make_unique<u8[]>(_page_size));
+				_page_offset = 0;
+			}
+
+			u8* ptr = _pages.last().get() + _page_offset;
+			_page_offset += size;
+
+			NameEntry* entry = ::new(ptr) NameEntry{hash, str.size()};
+			char* data = reinterpret_cast<char*>(entry + 1);
+			if(!str.empty()) {
+				std::memcpy(data, str.data(), str.size());
+			}
+			data[str.size()] = 0;
+			return entry;
+		}
+
+		std::atomic<Slots*> _slots = nullptr;
+		const NameEntry* _empty = nullptr;
+
+		std::mutex _lock;
+		usize _count = 0;
+		core::Vector<std::unique_ptr<Slots>> _tables;
+
+		core::Vector<std::unique_ptr<u8[]>> _pages;
+		usize _page_size = 0;
+		usize _page_offset = 0;
+};
+
+static NameTable& name_table() {
+	static NameTable* table = new NameTable();
+	return *table;
+}
+
+
+Name::Name() : _entry(name_table().empty()) {
+}
+
+Name::Name(std::string_view str) : _entry(name_table().intern(str)) {
+}
+
+Name::Name(const char* str) : Name(std::string_view(str)) {
+}
+
+Name::Name(const String& str) : Name(std::string_view(str)) {
+}
+
+Name::Name(const detail::NameEntry* entry) : _entry(entry) {
+}
+
+std::optional<Name> Name::find(std::string_view str) {
+	if(const NameEntry* entry = name_table().find(str, std::hash<std::string_view>()(str))) {
+		return Name(entry);
+	}
+	return std::nullopt;
+}
+
+}
+}
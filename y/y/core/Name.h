@@ -0,0 +1,122 @@
+/*******************************
+Copyright (c) 2016-2020 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+
+#ifndef Y_CORE_NAME_H
+#define Y_CORE_NAME_H
+
+#include <y/utils.h>
+
+#include <optional>
+#include <string_view>
+
+namespace y {
+namespace core {
+
+class String;
+
+namespace detail {
+struct NameEntry {
+	usize hash;
+	usize size;
+
+	// The characters follow the entry and are null terminated
+	const char* data() const {
+		return reinterpret_cast<const char*>(this + 1);
+	}
+};
+}
+
+// Interned string: equal names share the same entry, so copies are a pointer and comparisons are a pointer compare.
+// Interning takes a lock only when the string is new, lookups and everything else are lock free.
+// Entries are never released: names and the views they return stay valid until the program exits.
+class Name {
+	public:
+		Name();
+
+		explicit Name(std::string_view str);
+		explicit Name(const char* str);
+		explicit Name(const String& str);
+
+		// Doesn't intern anything, returns nothing if the string was never interned
+		static std::optional<Name> find(std::string_view str);
+
+		std::string_view view() const {
+			return std::string_view(_entry->data(), _entry->size);
+		}
+
+		// Null terminated
+		const char* data() const {
+			return _entry->data();
+		}
+
+		usize size() const {
+			return _entry->size;
+		}
+
+		bool is_empty() const {
+			return !_entry->size;
+		}
+
+		// Same as std::hash<std::string_view> of the string
+		usize hash() const {
+			return _entry->hash;
+		}
+
+		operator std::string_view() const {
+			return view();
+		}
+
+		bool operator==(const Name& other) const {
+			return _entry == other._entry;
+		}
+
+		bool operator!=(const Name& other) const {
+			return _entry != other._entry;
+		}
+
+		// Compares the strings so that the order doesn't depend on interning order
+		bool operator<(const Name& other) const {
+			return _entry != other._entry && view() < other.view();
+		}
+
+	private:
+		explicit Name(const detail::NameEntry* entry);
+
+		const detail::NameEntry* _entry = nullptr;
+};
+
+static_assert(sizeof(Name) == sizeof(void*));
+static_assert(std::is_trivially_copyable_v<Name>);
+
+}
+}
+
+namespace std {
+template<>
+struct hash<y::core::Name> {
+	auto operator()(const y::core::Name& name) const {
+		return name.hash();
+	}
+};
+}
+
+#endif // Y_CORE_NAME_H
@@ -25,6 +25,8 @@ SOFTWARE.
 #include "Vector.h"
 #include "Range.h"
 
+#include <y/mem/MemoryTags.h>
+
 
 namespace y {
 namespace core {
@@ -166,7 +168,11 @@ class SparseVector final {
 		static constexpr page_index_type page_invalid_index = page_index_type(-1);
 		using page_type = std::array<page_index_type, page_size>;
 
-		using value_container = std::conditional_t<is_void_v, EmptyVec, core::Vector<non_void>>;
+		// Pages, indexes and values are all accounted as container memory
+		template<typename T>
+		using tagged_vector = memory::TaggedVector<T, memory::MemoryTag::Containers>;
+
+		using value_container = std::conditional_t<is_void_v, EmptyVec, tagged_vector<non_void>>;
 
 	public:
 		//using iterator = typename Vector<non_void>::iterator;
@@ -367,8 +373,8 @@ class SparseVector final {
 		}*/
 
 		value_container _values;
-		Vector<index_type> _dense;
-		Vector<page_type> _sparse;
+		tagged_vector<index_type> _dense;
+		tagged_vector<page_type> _sparse;
 };
 
 }
@@ -0,0 +1,660 @@
+/*******************************
+Copyright (c) 2016-2020 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+
+#ifndef Y_CORE_SWISSHASHMAP_H
+#define Y_CORE_SWISSHASHMAP_H
+
+#include "HashMap.h"
+
+#include <cstring>
+
+#if !defined(Y_HASHMAP_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define Y_HASHMAP_SSE2
+#include <emmintrin.h>
+#endif
+
+#ifdef Y_MSVC
+#include <intrin.h>
+#endif
+
+namespace y {
+namespace core {
+
+// https://abseil.io/about/design/swisstables
+// Every bucket has a control byte: empty, deleted or the 7 low bits of the hash.
+// Lookups compare the control bytes of 16 buckets at a time and only touch entries whose bits match.
+
+namespace detail {
+class SwissGroup {
+	public:
+		static constexpr usize width = 16;
+
+		static constexpr i8 empty = -128;
+		static constexpr i8 deleted = -2;
+
+		explicit SwissGroup(const i8* ctrl) {
+#ifdef Y_HASHMAP_SSE2
+			_ctrl = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl));
+#else
+			std::memcpy(_ctrl, ctrl, width);
+#endif
+		}
+
+		u32 match(i8 h2) const {
+#ifdef Y_HASHMAP_SSE2
+			return u32(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), _ctrl)));
+#else
+			u32 mask = 0;
+			for(usize i = 0; i != width; ++i) {
+				mask |= u32(_ctrl[i] == h2) << i;
+			}
+			return mask;
+#endif
+		}
+
+		u32 match_empty() const {
+			return match(empty);
+		}
+
+		// Full buckets are the only ones with the sign bit cleared
+		u32 match_empty_or_deleted() const {
+#ifdef Y_HASHMAP_SSE2
+			return u32(_mm_movemask_epi8(_ctrl));
+#else
+			u32 mask = 0;
+			for(usize i = 0; i != width; ++i) {
+				mask |= u32(_ctrl[i] < 0) << i;
+			}
+			return mask;
+#endif
+		}
+
+		static u32 first_bit(u32 mask) {
+			y_debug_assert(mask);
+#ifdef Y_MSVC
+			unsigned long index = 0;
+			_BitScanForward(&index, mask);
+			return u32(index);
+#else
+			return u32(__builtin_ctz(mask));
+#endif
+		}
+
+	private:
+#ifdef Y_HASHMAP_SSE2
+		__m128i _ctrl;
+#else
+		i8 _ctrl[width];
+#endif
+};
+}
+
+
+namespace swiss {
+template<typename Key, typename Value, typename Hasher = std::hash<Key>>
+class SwissHashMap : Hasher {
+	public:
+		using key_type = remove_cvref_t<Key>;
+		using mapped_type = remove_cvref_t<Value>;
+		using value_type = std::pair<const key_type, mapped_type>;
+
+		static constexpr double max_load_factor = 7.0 / 8.0;
+		static constexpr usize min_capacity = detail::SwissGroup::width;
+
+	private:
+		using pair_type = std::pair<key_type, mapped_type>;
+		using Group = detail::SwissGroup;
+
+		static constexpr usize invalid_index = usize(-1);
+
+		struct Bucket {
+			usize index;
+			i8 h2;
+			bool exists;
+		};
+
+		struct Entry : NonMovable {
+			union {
+				pair_type key_value;
+			};
+
+			Entry() {
+			}
+
+			~Entry() {
+			}
+
+			void set_empty(const key_type& k) {
+				::new(&key_value) pair_type{k, mapped_type{}};
+			}
+
+			void set(pair_type&& kv) {
+				::new(&key_value) pair_type{std::move(kv)};
+			}
+
+			void clear() {
+				key_value.~pair_type();
+			}
+
+			const key_type& key() const {
+				return key_value.first;
+			}
+		};
+
+		struct KeyValueIt {
+			using type = value_type;
+
+			value_type& operator()(Entry& entry) const {
+				return detail::map_entry_to_value_type(entry.key_value);
+			}
+
+			const value_type& operator()(const Entry& entry) const {
+				return detail::map_entry_to_value_type(entry.key_value);
+			}
+		};
+
+		struct KeyIt {
+			using type = key_type;
+
+			const key_type& operator()(const Entry& entry) const {
+				return entry.key();
+			}
+		};
+
+		struct ValueIt {
+			using type = mapped_type;
+
+			mapped_type& operator()(Entry& entry) const {
+				return entry.key_value.second;
+			}
+
+			const mapped_type& operator()(const Entry& entry) const {
+				return entry.key_value.second;
+			}
+		};
+
+		template<bool Const, typename Transform>
+		class IteratorBase : Transform {
+
+			using parent_type = const_type_t<Const, SwissHashMap>;
+
+			public:
+				IteratorBase() = default;
+				IteratorBase(const IteratorBase&) = default;
+				IteratorBase& operator=(const IteratorBase&) = default;
+
+				template<bool C, typename T, typename = std::enable_if_t<(Const > C)>>
+				IteratorBase(const IteratorBase<C, T>& other) {
+					operator=(other);
+				}
+
+				template<bool C, typename T, typename = std::enable_if_t<(Const > C)>>
+				IteratorBase& operator=(const IteratorBase<C, T>& other) {
+					_index = other._index;
+					_parent = other._parent;
+					return *this;
+				}
+
+				auto& operator*() const {
+					return Transform::operator()(_parent->_entries[_index]);
+				}
+
+				auto* operator->() const {
+					return &(operator*());
+				}
+
+				IteratorBase& operator++() {
+					++_index;
+					find_next();
+					return *this;
+				}
+
+				IteratorBase operator++(int) {
+					auto it = *this;
+					++(*this);
+					return it;
+				}
+
+				bool at_end() const {
+					return _index == _parent->bucket_count();
+				}
+
+				template<bool C, typename T>
+				bool operator==(const IteratorBase<C, T>& other) const {
+					return _index == other._index;
+				}
+
+				template<bool C, typename T>
+				bool operator!=(const IteratorBase<C, T>& other) const {
+					return !operator==(other);
+				}
+
+			private:
+				template<bool C, typename T>
+				friend class IteratorBase;
+
+				friend class SwissHashMap;
+
+				IteratorBase(parent_type* parent, usize index) : _index(index), _parent(parent) {
+					find_next();
+				}
+
+				void find_next() {
+					for(;_index < _parent->bucket_count() && !_parent->is_full(_index); ++_index) {
+						// nothing
+					}
+					y_debug_assert(_index <= _parent->bucket_count());
+				}
+
+				usize _index = invalid_index;
+				parent_type* _parent = nullptr;
+
+			public:
+				using iterator_category = std::forward_iterator_tag;
+				using difference_type = usize;
+
+				using value_type = const_type_t<Const, typename Transform::type>;
+				using reference = value_type&;
+				using pointer = value_type*;
+		};
+
+		static usize max_size_for(usize buckets) {
+			return buckets - buckets / 8;
+		}
+
+		static usize buckets_for(usize size) {
+			usize buckets = min_capacity;
+			while(max_size_for(buckets) < size) {
+				buckets *= 2;
+			}
+			return buckets;
+		}
+
+		// Identity hashes (std::hash of integers) would put consecutive keys in the same group with the same control bits
+		usize hash(const key_type& key) const {
+			const u64 h = u64(Hasher::operator()(key)) * 0x9E3779B97F4A7C15;
+			return usize(h ^ (h >> 32));
+		}
+
+		static i8 control_bits(usize h) {
+			return i8(h & 0x7F);
+		}
+
+		usize first_group(usize h) const {
+			return (h >> 7) & (group_count() - 1);
+		}
+
+		usize group_count() const {
+			return _bucket_count / Group::width;
+		}
+
+		bool is_full(usize index) const {
+			return _ctrl[index] >= 0;
+		}
+
+		// Groups are visited in triangular steps which reach every group since the group count is a power of 2
+		usize find_bucket(const key_type& key) const {
+			if(is_empty()) {
+				return invalid_index;
+			}
+
+			const usize h = hash(key);
+			const i8 h2 = control_bits(h);
+			const usize group_mask = group_count() - 1;
+
+			usize group = first_group(h);
+			for(usize probes = 0; probes <= group_mask; ++probes) {
+				const usize offset = group * Group::width;
+				const Group g(&_ctrl[offset]);
+				for(u32 mask = g.match(h2); mask; mask &= mask - 1) {
+					const usize index = offset + Group::first_bit(mask);
+					if(_entries[index].key() == key) {
+						return index;
+					}
+				}
+				if(g.match_empty()) {
+					return invalid_index;
+				}
+				group = (group + probes + 1) & group_mask;
+			}
+			return invalid_index;
+		}
+
+		Bucket find_bucket_for_insert(const key_type& key) {
+			const usize h = hash(key);
+			const i8 h2 = control_bits(h);
+			const usize group_mask = group_count() - 1;
+
+			usize free_index = invalid_index;
+			usize group = first_group(h);
+			for(usize probes = 0; probes <= group_mask; ++probes) {
+				const usize offset = group * Group::width;
+				const Group g(&_ctrl[offset]);
+				for(u32 mask = g.match(h2); mask; mask &= mask - 1) {
+					const usize index = offset + Group::first_bit(mask);
+					if(_entries[index].key() == key) {
+						return {index, h2, true};
+					}
+				}
+				if(free_index == invalid_index) {
+					if(const u32 mask = g.match_empty_or_deleted()) {
+						free_index = offset + Group::first_bit(mask);
+					}
+				}
+				if(g.match_empty()) {
+					break;
+				}
+				group = (group + probes + 1) & group_mask;
+			}
+
+			y_always_assert(free_index != invalid_index, "Internal error: unable to find empty bucket");
+			return {free_index, h2, false};
+		}
+
+		// Only used when rehashing: all keys are known to be unique and there are no tombstones
+		usize find_free_bucket(usize h) const {
+			const usize group_mask = group_count() - 1;
+			usize group = first_group(h);
+			for(usize probes = 0; probes <= group_mask; ++probes) {
+				const usize offset = group * Group::width;
+				if(const u32 mask = Group(&_ctrl[offset]).match_empty_or_deleted()) {
+					return offset + Group::first_bit(mask);
+				}
+				group = (group + probes + 1) & group_mask;
+			}
+			y_fatal("Internal error: unable to find empty bucket");
+		}
+
+		void set_ctrl(usize index, i8 ctrl) {
+			if(ctrl >= 0) {
+				y_debug_assert(!is_full(index));
+				if(_ctrl[index] == Group::empty) {
+					--_growth_left;
+				}
+			}
+			_ctrl[index] = ctrl;
+		}
+
+		void rehash_to(usize new_bucket_count) {
+			y_debug_assert(new_bucket_count >= _size);
+			y_debug_assert(max_size_for(new_bucket_count) >= _size);
+
+			const usize old_bucket_count = std::exchange(_bucket_count, new_bucket_count);
+			auto old_ctrl = std::exchange(_ctrl, std::make_unique<i8[]>(new_bucket_count));
+			auto old_entries = std::exchange(_entries, std::make_unique<Entry[]>(new_bucket_count));
+
+			std::memset(_ctrl.get(), Group::empty, new_bucket_count);
+			_growth_left = max_size_for(new_bucket_count) - _size;
+
+			for(usize i = 0; i != old_bucket_count; ++i) {
+				if(old_ctrl[i] >= 0) {
+					const usize h = hash(old_entries[i].key());
+					const usize index = find_free_bucket(h);
+					_ctrl[index] = control_bits(h);
+					_entries[index].set(std::move(old_entries[i].key_value));
+					old_entries[i].clear();
+				}
+			}
+		}
+
+		// Tombstones count against the growth budget: if they make up most of it, rehashing in place is enough
+		void make_room() {
+			if(_growth_left) {
+				return;
+			}
+			if(!_bucket_count) {
+				rehash_to(min_capacity);
+			} else if(_size <= max_size_for(_bucket_count) / 2) {
+				rehash_to(_bucket_count);
+			} else {
+				rehash_to(_bucket_count * 2);
+			}
+		}
+
+		std::unique_ptr<i8[]> _ctrl;
+		std::unique_ptr<Entry[]> _entries;
+		usize _bucket_count = 0;
+		usize _size = 0;
+		usize _growth_left = 0;
+
+	public:
+		using iterator			= IteratorBase<false, KeyValueIt>;
+		using const_iterator	= IteratorBase<true,  KeyValueIt>;
+
+		static_assert(std::is_copy_assignable_v<const_iterator>);
+		static_assert(std::is_copy_constructible_v<const_iterator>);
+		static_assert(std::is_constructible_v<const_iterator, iterator>);
+		static_assert(!std::is_constructible_v<iterator, const_iterator>);
+
+		SwissHashMap() = default;
+		SwissHashMap(SwissHashMap&& other) {
+			swap(other);
+		}
+
+		SwissHashMap& operator=(SwissHashMap&& other) {
+			swap(other);
+			return *this;
+		}
+
+		void swap(SwissHashMap& other) {
+			if(&other != this) {
+				std::swap(_ctrl, other._ctrl);
+				std::swap(_entries, other._entries);
+				std::swap(_bucket_count, other._bucket_count);
+				std::swap(_size, other._size);
+				std::swap(_growth_left, other._growth_left);
+			}
+		}
+
+		~SwissHashMap() {
+			make_empty();
+		}
+
+		void make_empty() {
+			for(usize i = 0; i != _bucket_count && _size; ++i) {
+				if(is_full(i)) {
+					_entries[i].clear();
+					--_size;
+				}
+			}
+			y_debug_assert(_size == 0);
+
+			if(_bucket_count) {
+				std::memset(_ctrl.get(), Group::empty, _bucket_count);
+			}
+			_growth_left = max_size_for(_bucket_count);
+		}
+
+		void clear() {
+			make_empty();
+			_ctrl = nullptr;
+			_entries = nullptr;
+			_bucket_count = 0;
+			_growth_left = 0;
+		}
+
+		iterator begin() {
+			return iterator(this, 0);
+		}
+
+		const_iterator begin() const {
+			return const_iterator(this, 0);
+		}
+
+		iterator end() {
+			return iterator(this, bucket_count());
+		}
+
+		const_iterator end() const {
+			return const_iterator(this, bucket_count());
+		}
+
+		auto key_values() {
+			return core::Range(begin(), end());
+		}
+
+		auto key_values() const {
+			return core::Range(begin(), end());
+		}
+
+		auto keys() const {
+			return core::Range(
+				IteratorBase<true, KeyIt>(this, 0),
+				IteratorBase<true, KeyIt>(this, bucket_count())
+			);
+		}
+
+		auto values() {
+			return core::Range(
+				IteratorBase<false, ValueIt>(this, 0),
+				IteratorBase<false, ValueIt>(this, bucket_count())
+			);
+		}
+
+		auto values() const {
+			return core::Range(
+				IteratorBase<true, ValueIt>(this, 0),
+				IteratorBase<true, ValueIt>(this, bucket_count())
+			);
+		}
+
+
+		bool is_empty() const {
+			return !_size;
+		}
+
+		usize bucket_count() const {
+			return _bucket_count;
+		}
+
+		usize size() const {
+			return _size;
+		}
+
+		double load_factor() const {
+			return _bucket_count ? double(_size) / double(_bucket_count) : 0.0;
+		}
+
+		bool contains(const key_type& key) const {
+			return find_bucket(key) != invalid_index;
+		}
+
+		iterator find(const key_type& key) {
+			const usize index = find_bucket(key);
+			if(index != invalid_index) {
+				return iterator(this, index);
+			}
+			return end();
+		}
+
+		const_iterator find(const key_type& key) const {
+			const usize index = find_bucket(key);
+			if(index != invalid_index) {
+				return const_iterator(this, index);
+			}
+			return end();
+		}
+
+		void rehash() {
+			if(_bucket_count) {
+				rehash_to(_bucket_count);
+			}
+		}
+
+		void set_min_capacity(usize cap) {
+			const usize buckets = buckets_for(cap);
+			if(_bucket_count < buckets) {
+				rehash_to(buckets);
+			}
+		}
+
+		void reserve(usize cap) {
+			set_min_capacity(cap);
+		}
+
+		// Buckets can only go back to empty if no probe sequence ever went past their group
+		void erase(const iterator& it) {
+			const usize index = it._index;
+
+			y_debug_assert(index < bucket_count());
+			y_debug_assert(it._parent == this);
+			y_debug_assert(is_full(index));
+
+			_entries[index].clear();
+
+			const usize offset = index - index % Group::width;
+			if(Group(&_ctrl[offset]).match_empty()) {
+				_ctrl[index] = Group::empty;
+				++_growth_left;
+			} else {
+				_ctrl[index] = Group::deleted;
+			}
+
+			--_size;
+		}
+
+		template<typename... Args>
+		std::pair<iterator, bool> emplace(const key_type& key, Args&&... args) {
+			return insert(pair_type{key, mapped_type{y_fwd(args)...}});
+		}
+
+		std::pair<iterator, bool> insert(pair_type p) {
+			make_room();
+
+			const Bucket bucket = find_bucket_for_insert(p.first);
+			if(!bucket.exists) {
+				_entries[bucket.index].set(std::move(p));
+				set_ctrl(bucket.index, bucket.h2);
+				++_size;
+			}
+
+			return {iterator(this, bucket.index), !bucket.exists};
+		}
+
+		template<typename It>
+		void insert(It beg, It en) {
+			for(; beg != en; ++beg) {
+				insert(*beg);
+			}
+		}
+
+		mapped_type& operator[](const key_type& key) {
+			make_room();
+
+			const Bucket bucket = find_bucket_for_insert(key);
+			if(!bucket.exists) {
+				_entries[bucket.index].set_empty(key);
+				set_ctrl(bucket.index, bucket.h2);
+				++_size;
+			}
+
+			return _entries[bucket.index].key_value.second;
+		}
+};
+}
+
+using namespace swiss;
+
+}
+}
+
+#endif // Y_CORE_SWISSHASHMAP_H
@@ -26,6 +26,7 @@ SOFTWARE.
 
 #include <cstring>
 #include <algorithm>
+#include <memory>
 
 #ifdef Y_DEBUG
 #define Y_VECTOR_ELECTRIC
@@ -64,6 +65,80 @@ struct DefaultVectorResizePolicy {
 	}
 };
 
+template<usize Size, typename ResizePolicy = DefaultVectorResizePolicy>
+struct SmallVectorResizePolicy : ResizePolicy {
+	static usize ideal_capacity(usize size) {
+		if(size && size <= Size) {
+			return Size;
+		}
+		return ResizePolicy::ideal_capacity(size);
+	}
+};
+
+
+namespace detail {
+struct InlineStorageTag {
+};
+}
+
+// Hands out its inline storage first and falls back on Allocator when it is too small or already in use.
+// The storage belongs to the allocator (and thus to the vector), copies and moves never share it.
+template<typename Elem, usize Size, typename Allocator = std::allocator<Elem>>
+class InlineStorageAllocator : public detail::InlineStorageTag, Allocator {
+
+	using data_type = typename std::remove_const<Elem>::type;
+
+	static_assert(Size, "InlineStorageAllocator needs a non zero size");
+
+	public:
+		using value_type = Elem;
+
+		using propagate_on_container_copy_assignment = std::false_type;
+		using propagate_on_container_move_assignment = std::false_type;
+
+		InlineStorageAllocator() = default;
+
+		InlineStorageAllocator(const InlineStorageAllocator&) {
+		}
+
+		InlineStorageAllocator& operator=(const InlineStorageAllocator&) {
+			return *this;
+		}
+
+		data_type* allocate(usize n) {
+			if(n <= Size && !_inline_used) {
+				_inline_used = true;
+				return inline_data();
+			}
+			return Allocator::allocate(n);
+		}
+
+		void deallocate(data_type* ptr, usize n) {
+			if(ptr == inline_data()) {
+				y_debug_assert(_inline_used);
+				_inline_used = false;
+			} else {
+				Allocator::deallocate(ptr, n);
+			}
+		}
+
+		bool is_inline(const data_type* ptr) const {
+			return ptr == inline_data();
+		}
+
+	private:
+		data_type* inline_data() {
+			return reinterpret_cast<data_type*>(_storage);
+		}
+
+		const data_type* inline_data() const {
+			return reinterpret_cast<const data_type*>(_storage);
+		}
+
+		alignas(data_type) u8 _storage[Size * sizeof(data_type)];
+		bool _inline_used = false;
+};
+
 
 template<typename Elem, typename ResizePolicy = DefaultVectorResizePolicy, typename Allocator = std::allocator<Elem>>
 class Vector : ResizePolicy, Allocator {
@@ -85,6 +160,10 @@ class Vector : ResizePolicy, Allocator {
 
 		Vector() = default;
 
+		// For stateful allocators, copies use a default constructed allocator
+		explicit Vector(Allocator&& allocator) : Allocator(std::move(allocator)) {
+		}
+
 		Vector(const Vector& other) : Vector(other.begin(), other.end()) {
 		}
 
@@ -176,6 +255,12 @@ class Vector : ResizePolicy, Allocator {
 
 		void swap(Vector& v) {
 			if(&v != this) {
+				if constexpr(has_inline_storage) {
+					if(Allocator::is_inline(_data) || v.Allocator::is_inline(v._data)) {
+						swap_elements(v);
+						return;
+					}
+				}
 				if constexpr(std::allocator_traits<Allocator>::propagate_on_container_move_assignment::value) {
 					std::swap<Allocator>(*this, v);
 				}
@@ -365,6 +450,24 @@ class Vector : ResizePolicy, Allocator {
 		static constexpr bool is_data_trivial = std::is_trivial_v<data_type>;
 #endif
 
+		static constexpr bool has_inline_storage = std::is_base_of_v<detail::InlineStorageTag, Allocator>;
+
+		// Inline storage can not change owner, so elements are moved instead
+		void swap_elements(Vector& v) {
+			if(is_empty()) {
+				emplace_back(v.begin(), v.end());
+				v.make_empty();
+				return;
+			}
+
+			Vector tmp;
+			tmp.emplace_back(v.begin(), v.end());
+			v.make_empty();
+			v.emplace_back(begin(), end());
+			make_empty();
+			emplace_back(tmp.begin(), tmp.end());
+		}
+
 		bool contains_it(const_iterator it) const {
 			return it >= _data && it < _data_end;
 		}
@@ -463,8 +566,9 @@ inline Vector<Args...> operator+(Vector<Args...> vec, T&& t) {
 	return vec;
 }
 
-template<typename T, usize = 0, typename... Args>
-using SmallVector = Vector<T, Args...>; // for now...
+// Stores up to Size elements inline before spilling to the heap
+template<typename Elem, usize Size = 8, typename ResizePolicy = DefaultVectorResizePolicy, typename Allocator = std::allocator<Elem>>
+using SmallVector = Vector<Elem, SmallVectorResizePolicy<Size, ResizePolicy>, InlineStorageAllocator<Elem, Size, Allocator>>;
 
 }
 }
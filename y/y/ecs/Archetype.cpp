@@ -27,24 +27,21 @@ SOFTWARE.
 #include <y/utils/log.h>
 #include <y/utils/format.h>
 
+#include <algorithm>
+
 namespace y {
 namespace ecs {
 
 Archetype::Archetype(usize component_count, memory::PolymorphicAllocatorBase* allocator) :
         _component_count(component_count),
         _component_infos(std::make_unique<ComponentRuntimeInfo[]>(component_count)),
-		_allocator(allocator) {
+		_allocator(memory::PolymorphicAllocatorContainer(allocator)) {
 }
 
 Archetype::~Archetype() {
 	if(_component_infos) {
-		log_msg(fmt("destroying arch with % components % entities", _component_count, entity_count()));
-		/*for(usize i = 0; i != _component_count; ++i) {
-			log_msg(_component_infos[i].type_name);
-		}*/
-
-
-		y_debug_assert(_chunk_data.is_empty() == !_last_chunk_size);
+		// The last chunk can be empty: remove_entity only releases it on the next removal
+		y_debug_assert(!_chunk_data.is_empty() || !_last_chunk_size);
 		if(!_chunk_data.is_empty()) {
 			for(usize i = 0; i != _component_count; ++i) {
 				_component_infos[i].destroy_indexed(_chunk_data.last(), 0, _last_chunk_size);
@@ -88,58 +85,226 @@ void Archetype::add_entities(core::MutableSpan<EntityData> entities) {
 }
 
 void Archetype::add_entities(core::MutableSpan<EntityData> entities, bool update_data) {
-	add_chunk_if_needed();
-
-	const usize left_in_chunk = entities_per_chunk - _last_chunk_size;
-	const usize first = std::min(left_in_chunk, entities.size());
+	const usize start = entity_count();
+	add_slots(entities.size());
 
+	// Deserialization adds entities without any data
+	if(!entities.data()) {
+		for(usize i = 0; i != entities.size(); ++i) {
+			_entity_ids << EntityID();
+		}
+		return;
+	}
 
-	if(update_data) {
-		const usize start = entity_count();
-		for(usize i = 0; i != first; ++i) {
+	for(usize i = 0; i != entities.size(); ++i) {
+		_entity_ids << entities[i].id;
+		if(update_data) {
 			entities[i].archetype = this;
 			entities[i].archetype_index = start + i;
 		}
 	}
+}
 
-	void* chunk_data = _chunk_data.last();
-	for(usize i = 0; i != _component_count; ++i) {
-		_component_infos[i].create_indexed(chunk_data, _last_chunk_size, first);
+usize Archetype::create_slots(core::Span<EntityData*> entities) {
+	const usize start = entity_count();
+	add_slots(entities.size());
+	for(usize i = entities.size(); i != 0; --i) {
+		_entity_ids << entities[i - 1]->id;
 	}
-	_last_chunk_size += first;
+	return start;
+}
 
-	if(first != entities.size()) {
-		add_entities(core::MutableSpan(entities.begin() + first, entities.size() - first));
+usize Archetype::migrate_to(Archetype* other, core::Span<EntityData*> entities) {
+	const usize start = other->reserve_slots(entities.size());
+
+	// Components we don't have are default constructed in place, the others are relocated below
+	for(usize i = 0, self_index = 0; i != other->_component_count; ++i) {
+		const ComponentRuntimeInfo& info = other->_component_infos[i];
+		while(self_index != _component_count && _component_infos[self_index].type_id < info.type_id) {
+			++self_index;
+		}
+		if(self_index == _component_count || _component_infos[self_index].type_id != info.type_id) {
+			for_each_run(start, entities.size(), [&](usize chunk_index, usize item_index, usize run) {
+				info.create_indexed(other->_chunk_data[chunk_index], item_index, run);
+			});
+		}
 	}
+
+	// Walk the entities by increasing index so that runs of neighbours map to runs of destination slots
+	for(usize e = entities.size(); e != 0;) {
+		const usize src_index = entities[e - 1]->archetype_index;
+		const usize dst_index = start + entities.size() - e;
+
+		usize run = 1;
+		while(run != e && entities[e - run - 1]->archetype_index == src_index + run) {
+			++run;
+		}
+
+		usize other_index = 0;
+		for(usize i = 0; i != _component_count; ++i) {
+			const ComponentRuntimeInfo& info = _component_infos[i];
+
+			// Both info lists are sorted: components missing from other are skipped without losing our place
+			while(other_index != other->_component_count && other->_component_infos[other_index].type_id < info.type_id) {
+				++other_index;
+			}
+
+			if(other_index != other->_component_count && other->_component_infos[other_index].type_id == info.type_id) {
+				relocate(info, other->_component_infos[other_index], other->_chunk_data.data(), dst_index, _chunk_data.data(), src_index, run);
+			} else {
+				destroy(info, _chunk_data.data(), src_index, run);
+			}
+		}
+
+		for(usize r = 0; r != run; ++r) {
+			other->_entity_ids << entities[e - r - 1]->id;
+		}
+
+		e -= run;
+	}
+
+	compact(entities);
+	return start;
+}
+
+void Archetype::remove_slots(core::Span<EntityData*> entities) {
+	for(usize e = entities.size(); e != 0;) {
+		const usize index = entities[e - 1]->archetype_index;
+		usize run = 1;
+		while(run != e && entities[e - run - 1]->archetype_index == index + run) {
+			++run;
+		}
+
+		for(usize i = 0; i != _component_count; ++i) {
+			destroy(_component_infos[i], _chunk_data.data(), index, run);
+		}
+
+		e -= run;
+	}
+
+	compact(entities);
 }
 
-void Archetype::remove_entity(EntityData& data) {
-	y_debug_assert(data.archetype == this);
+usize Archetype::reserve_slots(usize count) {
+	const usize start = entity_count();
+	const usize chunk_count = (start + count + entities_per_chunk - 1) / entities_per_chunk;
+	_chunk_data.set_min_capacity(chunk_count);
+	_entity_ids.set_min_capacity(start + count);
+
+	while(count) {
+		add_chunk_if_needed();
+
+		const usize added = std::min(entities_per_chunk - _last_chunk_size, count);
+		_last_chunk_size += added;
+		count -= added;
+	}
+
+	return start;
+}
 
-	if(!_last_chunk_size) {
+void Archetype::add_slots(usize count) {
+	const usize start = reserve_slots(count);
+	for(usize i = 0; i != _component_count; ++i) {
+		for_each_run(start, count, [&](usize chunk_index, usize item_index, usize run) {
+			_component_infos[i].create_indexed(_chunk_data[chunk_index], item_index, run);
+		});
+	}
+}
+
+// The slots of entities have already been destroyed or relocated.
+// Slots past the new end that are still alive are relocated into the holes below it, in order, so that runs stay runs.
+void Archetype::compact(core::Span<EntityData*> entities) {
+	const usize count = entity_count();
+	const usize new_count = count - entities.size();
+
+	// entities are sorted by decreasing index: the ones past the new end come first
+	usize tail_dead = 0;
+	while(tail_dead != entities.size() && entities[tail_dead]->archetype_index >= new_count) {
+		++tail_dead;
+	}
+
+	const auto is_dead = [&](usize dead, usize slot) {
+		return dead && entities[dead - 1]->archetype_index == slot;
+	};
+
+	usize hole = entities.size();
+	usize dead = tail_dead;
+	usize src_index = new_count;
+	while(hole != tail_dead) {
+		while(is_dead(dead, src_index)) {
+			--dead;
+			++src_index;
+		}
+
+		const usize dst_index = entities[hole - 1]->archetype_index;
+		usize run = 1;
+		while(hole - run != tail_dead && entities[hole - run - 1]->archetype_index == dst_index + run && !is_dead(dead, src_index + run)) {
+			++run;
+		}
+
+		for(usize i = 0; i != _component_count; ++i) {
+			relocate(_component_infos[i], _component_infos[i], _chunk_data.data(), dst_index, _chunk_data.data(), src_index, run);
+		}
+		for(usize r = 0; r != run; ++r) {
+			_entity_ids[dst_index + r] = _entity_ids[src_index + r];
+		}
+
+		hole -= run;
+		src_index += run;
+	}
+
+	while(_entity_ids.size() != new_count) {
+		_entity_ids.pop();
+	}
+
+	// Keep an empty last chunk around, it gets released on the next removal
+	usize chunk_count = new_count / entities_per_chunk + 1;
+	if(chunk_count > _chunk_data.size()) {
+		y_debug_assert(chunk_count == _chunk_data.size() + 1);
+		--chunk_count;
+	}
+	while(_chunk_data.size() > chunk_count) {
 		if(_chunk_data.last()) {
 			_allocator.deallocate(_chunk_data.last(), _chunk_byte_size);
 		}
 		_chunk_data.pop();
-		_last_chunk_size = entities_per_chunk;
 	}
+	_last_chunk_size = new_count - (chunk_count - 1) * entities_per_chunk;
+	y_debug_assert(entity_count() == new_count);
+}
 
-	y_debug_assert(_last_chunk_size != 0);
-	y_debug_assert(!_chunk_data.is_empty());
-	const usize last_index = _last_chunk_size - 1;
-	if(data.archetype_index + 1 != entity_count()) {
-		const usize chunk_index = data.archetype_index / entities_per_chunk;
-		const usize item_index = data.archetype_index % entities_per_chunk;
-		for(usize i = 0; i != _component_count; ++i) {
-			_component_infos[i].move_indexed(_chunk_data[chunk_index], item_index, _chunk_data.last(), last_index, 1);
-		}
+template<typename F>
+void Archetype::for_each_run(usize index, usize count, F&& func) {
+	while(count) {
+		const usize item_index = index % entities_per_chunk;
+		const usize run = std::min(count, entities_per_chunk - item_index);
+		func(index / entities_per_chunk, item_index, run);
+		index += run;
+		count -= run;
 	}
+}
 
-	for(usize i = 0; i != _component_count; ++i) {
-		_component_infos[i].destroy_indexed(_chunk_data.last(), last_index, 1);
+void Archetype::relocate(const ComponentRuntimeInfo& src_info, const ComponentRuntimeInfo& dst_info, void* const* dst_chunks, usize dst_index, void* const* src_chunks, usize src_index, usize count) {
+	y_debug_assert(src_info.type_id == dst_info.type_id);
+	while(count) {
+		const usize src_item = src_index % entities_per_chunk;
+		const usize dst_item = dst_index % entities_per_chunk;
+		const usize run = std::min({count, entities_per_chunk - src_item, entities_per_chunk - dst_item});
+
+		void* dst = dst_info.index_ptr(dst_chunks[dst_index / entities_per_chunk], dst_item);
+		void* src = src_info.index_ptr(src_chunks[src_index / entities_per_chunk], src_item);
+		src_info.relocate(dst, src, run);
+
+		src_index += run;
+		dst_index += run;
+		count -= run;
 	}
-	--_last_chunk_size;
-	data.invalidate();
+}
+
+void Archetype::destroy(const ComponentRuntimeInfo& info, void* const* chunks, usize index, usize count) {
+	for_each_run(index, count, [&](usize chunk_index, usize item_index, usize run) {
+		info.destroy_indexed(chunks[chunk_index], item_index, run);
+	});
 }
 
 void Archetype::sort_component_infos() {
@@ -148,11 +313,10 @@ void Archetype::sort_component_infos() {
 
 	y_debug_assert(_chunk_byte_size == 0);
 	for(usize i = 0; i != _component_count; ++i) {
+		// Every component array starts on its own cache line
+		_chunk_byte_size = memory::align_up_to(_chunk_byte_size, memory::ChunkAllocator::chunk_alignment);
 		_component_infos[i].chunk_offset = _chunk_byte_size;
-
-		const usize size = _component_infos[i].component_size;
-		_chunk_byte_size = memory::align_up_to(_chunk_byte_size, size);
-		_chunk_byte_size += size * entities_per_chunk;
+		_chunk_byte_size += _component_infos[i].component_size * entities_per_chunk;
 
 		if(i && _component_infos[i - 1].type_id == _component_infos[i].type_id) {
 			y_fatal("Duplicated component type: %.", _component_infos[i].type_name);
@@ -160,48 +324,30 @@ void Archetype::sort_component_infos() {
 	}
 }
 
-void Archetype::transfer_to(Archetype* other, core::MutableSpan<EntityData> entities) {
-	Y_TODO(We create empty entities just to move into them)
-	const usize start = other->entity_count();
-	other->add_entities(entities, false);
+std::unique_ptr<Archetype> Archetype::archetype_without(core::Span<u32> type_indexes) const {
+	y_debug_assert(std::is_sorted(type_indexes.begin(), type_indexes.end()));
 
-	usize other_index = 0;
+	usize count = 0;
 	for(usize i = 0; i != _component_count; ++i) {
-		const ComponentRuntimeInfo& info = _component_infos[i];
-		ComponentRuntimeInfo* other_info = nullptr;
-		for(; other_index != other->_component_count; ++other_index) {
-			if(other->_component_infos[other_index].type_id == info.type_id) {
-				other_info = &other->_component_infos[other_index];
-				break;
-			}
-		}
-		if(other_info) {
-			y_debug_assert(other_info->type_id == info.type_id);
-			for(usize e = 0; e != entities.size(); ++e) {
-				EntityData& data = entities[e];
-				const usize src_chunk_index = data.archetype_index / entities_per_chunk;
-				const usize src_item_index = data.archetype_index % entities_per_chunk;
-
-				const usize dst_index = start + e;
-				const usize dst_chunk_index = dst_index / entities_per_chunk;
-				const usize dst_item_index = dst_index % entities_per_chunk;
+		count += !std::binary_search(type_indexes.begin(), type_indexes.end(), _component_infos[i].type_id);
+	}
 
-				void* dst = other_info->index_ptr(other->_chunk_data[dst_chunk_index], dst_item_index);
-				info.move_indexed(dst, _chunk_data[src_chunk_index], src_item_index, 1);
-			}
+	auto arc = std::make_unique<Archetype>(count);
+	ComponentRuntimeInfo* infos = arc->_component_infos.get();
+	for(usize i = 0; i != _component_count; ++i) {
+		if(!std::binary_search(type_indexes.begin(), type_indexes.end(), _component_infos[i].type_id)) {
+			*infos++ = _component_infos[i];
 		}
 	}
+	arc->sort_component_infos();
+	return arc;
+}
 
-	Y_TODO(optimize this with create_from)
-	for(usize e = 0; e != entities.size(); ++e) {
-		EntityData& data = entities[e];
-		const EntityID id = data.id;
-		remove_entity(data);
-
-		data.id = id;
-		data.archetype = other;
-		data.archetype_index = start + e;
-	}
+const ComponentRuntimeInfo* Archetype::info_or_null(u32 type_id) const {
+	const ComponentRuntimeInfo* begin = _component_infos.get();
+	const ComponentRuntimeInfo* end = begin + _component_count;
+	const ComponentRuntimeInfo* info = std::lower_bound(begin, end, type_id, [](const ComponentRuntimeInfo& i, u32 id) { return i.type_id < id; });
+	return info != end && info->type_id == type_id ? info : nullptr;
 }
 
 bool Archetype::matches_type_indexes(core::Span<u32> type_indexes) const {
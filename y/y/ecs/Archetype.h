@@ -27,7 +27,9 @@ SOFTWARE.
 
 #include <y/core/Range.h>
 #include <y/core/Vector.h>
-#include <y/mem/allocators.h>
+#include <y/core/SwissHashMap.h>
+#include <y/mem/ChunkAllocator.h>
+#include <y/mem/MemoryTags.h>
 
 #include <y/serde3/serde.h>
 
@@ -58,15 +60,43 @@ class Archetype : NonMovable {
 		template<typename... Args>
 		ComponentView<Args...> view() {
 			ComponentIterator<Args...> begin;
-			if(!build_iterator<0>(begin)) {
+			if(!build_iterator(begin)) {
 				return ComponentView<Args...>();
 			}
 			return ComponentView<Args...>(begin, entity_count());
 		}
 
+		// Offsets of the Args component arrays inside a chunk, false if a component is missing
+		template<typename... Args>
+		[[nodiscard]] bool component_offsets(std::array<usize, sizeof...(Args)>& offsets) const {
+			return build_offsets<0, Args...>(offsets);
+		}
+
+		// Number of non empty chunks
+		usize chunk_count() const {
+			return (entity_count() + entities_per_chunk - 1) / entities_per_chunk;
+		}
+
+		// Calls func(ComponentChunk<Args...>) once per non empty chunk, offsets come from component_offsets
+		template<typename... Args, typename F>
+		void for_each_chunk(const std::array<usize, sizeof...(Args)>& offsets, F&& func) const {
+			for_each_chunk<Args...>(offsets, 0, chunk_count(), func);
+		}
+
+		// Same as above for the chunks in [begin, end)
+		template<typename... Args, typename F>
+		void for_each_chunk(const std::array<usize, sizeof...(Args)>& offsets, usize begin, usize end, F&& func) const {
+			y_debug_assert(begin <= end && end <= chunk_count());
+			const usize count = entity_count();
+			for(usize c = begin; c != end; ++c) {
+				const usize first = c * entities_per_chunk;
+				func(ComponentChunk<Args...>(_chunk_data[c], offsets, std::min(entities_per_chunk, count - first)));
+			}
+		}
+
 	public:
 		// This can not be private because of make_unique
-		Archetype(usize component_count = 0, memory::PolymorphicAllocatorBase* allocator = memory::global_allocator());
+		Archetype(usize component_count = 0, memory::PolymorphicAllocatorBase* allocator = memory::chunk_allocator());
 
 		/*y_serde3(serde3::property(this, &Archetype::create_serializers, &Archetype::set_serializers),
 				 serde3::property(this, &Archetype::entity_count,		&Archetype::set_entity_count),
@@ -78,11 +108,27 @@ class Archetype : NonMovable {
 		void add_entities(core::MutableSpan<EntityData> entities, bool update_data);
 
 		void sort_component_infos();
-		void transfer_to(Archetype* other, core::MutableSpan<EntityData> entities);
 		bool matches_type_indexes(core::Span<u32> type_indexes) const;
 		void add_chunk_if_needed();
 		void add_chunk();
-		void remove_entity(EntityData& data);
+
+		// Slot functions leave the EntityData untouched, EntityWorld updates them once the whole batch is done.
+		// Entities must be sorted by decreasing index, entities[i] ends up in slot first + entities.size() - 1 - i.
+		usize create_slots(core::Span<EntityData*> entities);
+		usize migrate_to(Archetype* other, core::Span<EntityData*> entities);
+		void remove_slots(core::Span<EntityData*> entities);
+
+		usize reserve_slots(usize count);
+		void add_slots(usize count);
+		void compact(core::Span<EntityData*> entities);
+
+		template<typename F>
+		static void for_each_run(usize index, usize count, F&& func);
+
+		static void relocate(const ComponentRuntimeInfo& src_info, const ComponentRuntimeInfo& dst_info, void* const* dst_chunks, usize dst_index, void* const* src_chunks, usize src_index, usize count);
+		static void destroy(const ComponentRuntimeInfo& info, void* const* chunks, usize index, usize count);
+
+		std::unique_ptr<Archetype> archetype_without(core::Span<u32> type_indexes) const;
 
 
 
@@ -103,16 +149,11 @@ class Archetype : NonMovable {
 
 		template<typename T>
 		const ComponentRuntimeInfo* info_or_null() const {
-			const u32 index = type_index<T>();
-			Y_TODO(binary search?)
-			for(usize i = 0; i != _component_count; ++i) {
-				if(_component_infos[i].type_id == index) {
-					return &_component_infos[i];
-				}
-			}
-			return nullptr;
+			return info_or_null(type_index<T>());
 		}
 
+		const ComponentRuntimeInfo* info_or_null(u32 type_id) const;
+
 		template<typename T>
 		const ComponentRuntimeInfo* info() {
 			if(const ComponentRuntimeInfo* i = info_or_null<T>()) {
@@ -122,20 +163,26 @@ class Archetype : NonMovable {
 		}
 
 		template<usize I, typename... Args>
-		[[nodiscard]] bool build_iterator(ComponentIterator<Args...>& it) {
+		[[nodiscard]] bool build_offsets(std::array<usize, sizeof...(Args)>& offsets) const {
 			static_assert(sizeof...(Args));
 			if constexpr(I < sizeof...(Args)) {
-				using reference = typename ComponentIterator<Args...>::reference;
-				using type = remove_cvref_t<std::tuple_element_t<I, reference>>;
+				using type = remove_cvref_t<std::tuple_element_t<I, std::tuple<Args...>>>;
 				const ComponentRuntimeInfo* type_info =  info_or_null<type>();
 				if(!type_info) {
 					return false;
 				}
-				it._offsets[I] = type_info->chunk_offset;
-				return build_iterator<I + 1>(it);
-			} else {
-				it._chunks = _chunk_data.begin();
+				offsets[I] = type_info->chunk_offset;
+				return build_offsets<I + 1, Args...>(offsets);
+			}
+			return true;
+		}
+
+		template<typename... Args>
+		[[nodiscard]] bool build_iterator(ComponentIterator<Args...>& it) {
+			if(!build_offsets<0, Args...>(it._offsets)) {
+				return false;
 			}
+			it._chunks = _chunk_data.begin();
 			return true;
 		}
 
@@ -190,7 +237,17 @@ class Archetype : NonMovable {
 		core::Vector<void*> _chunk_data;
 		usize _last_chunk_size = 0;
 
-		memory::PolymorphicAllocatorContainer _allocator;
+		// Entity stored in each slot, so that swap and pop can update the moved entity
+		core::Vector<EntityID> _entity_ids;
+
+		// Archetype reached by adding or removing a list of components, keyed by type_list_index
+		core::SwissHashMap<u32, Archetype*> _add_edges;
+		core::SwissHashMap<u32, Archetype*> _remove_edges;
+
+		// Next archetype in the EntityWorld index with the same signature hash
+		Archetype* _next_with_same_hash = nullptr;
+
+		memory::TaggedAllocator<memory::MemoryTag::Ecs, memory::PolymorphicAllocatorContainer> _allocator;
 		usize _chunk_byte_size = 0;
 };
 
@@ -41,7 +41,7 @@ ComponentSerializerWrapper create_component_serializer(Archetype*);
 
 template<typename T>
 void create_component(void* dst, usize count) {
-	y_debug_assert(usize(dst) % sizeof(T) == 0);
+	y_debug_assert(usize(dst) % alignof(T) == 0);
 	T* it = static_cast<T*>(dst);
 	const T* end = it + count;
 	for(; it != end; ++it) {
@@ -51,13 +51,13 @@ void create_component(void* dst, usize count) {
 
 template<typename T>
 void create_component_from(void* dst, void* from) {
-	y_debug_assert(usize(dst) % sizeof(T) == 0);
+	y_debug_assert(usize(dst) % alignof(T) == 0);
 	::new(dst) T(std::move(*static_cast<T*>(from)));
 }
 
 template<typename T>
 void destroy_component(void* ptr, usize count) {
-	y_debug_assert(usize(ptr) % sizeof(T) == 0);
+	y_debug_assert(usize(ptr) % alignof(T) == 0);
 	T* it = static_cast<T*>(ptr);
 	const T* end = it + count;
 	for(; it != end; ++it) {
@@ -68,9 +68,26 @@ void destroy_component(void* ptr, usize count) {
 #endif
 }
 
+// Move constructs into uninitialized memory and destroys the source, trivially copyable components are copied as a whole run
+template<typename T>
+void relocate_component(void* dst, void* src, usize count) {
+	y_debug_assert(usize(dst) % alignof(T) == 0);
+	if constexpr(std::is_trivially_copyable_v<T>) {
+		std::memcpy(dst, src, count * sizeof(T));
+	} else {
+		T* it = static_cast<T*>(src);
+		const T* end = it + count;
+		T* out = static_cast<T*>(dst);
+		for(; it != end; ++it, ++out) {
+			::new(out) T(std::move(*it));
+			it->~T();
+		}
+	}
+}
+
 template<typename T>
 void move_component(void* dst, void* src, usize count) {
-	y_debug_assert(usize(dst) % sizeof(T) == 0);
+	y_debug_assert(usize(dst) % alignof(T) == 0);
 	T* it = static_cast<T*>(src);
 	const T* end = it + count;
 	T* out = static_cast<T*>(dst);
@@ -90,6 +107,7 @@ struct ComponentRuntimeInfo {
 	void (*create_from)(void* dst, void* from) = nullptr;
 	void (*destroy)(void* ptr, usize count) = nullptr;
 	void (*move)(void* dst, void* src, usize count) = nullptr;
+	void (*relocate)(void* dst, void* src, usize count) = nullptr;
 
 	std::unique_ptr<ComponentInfoSerializerBase> (*create_info_serializer)() = nullptr;
 	ComponentSerializerWrapper (*create_component_serializer)(Archetype*) = nullptr;
@@ -108,6 +126,7 @@ struct ComponentRuntimeInfo {
 			detail::create_component_from<T>,
 			detail::destroy_component<T>,
 			detail::move_component<T>,
+			detail::relocate_component<T>,
 			detail::create_info_serializer<T>,
 			detail::create_component_serializer<T>,
 			type_index<T>(),
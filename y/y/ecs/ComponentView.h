@@ -27,7 +27,9 @@ SOFTWARE.
 #include <y/core/Range.h>
 
 #include <tuple>
+#include <array>
 #include <type_traits>
+#include <utility>
 
 namespace y {
 namespace ecs {
@@ -210,6 +212,56 @@ bool ComponentEndIterator::operator!=(const ComponentIterator<Args...>& other) c
 }
 
 
+// Typed component arrays of a single archetype chunk: get<I>()[i] is the I-th component of the i-th entity
+template<typename... Args>
+class ComponentChunk {
+	public:
+		static constexpr usize component_count = sizeof...(Args);
+
+		using pointers = std::tuple<Args*...>;
+
+		ComponentChunk() = default;
+
+		ComponentChunk(void* chunk, const std::array<usize, component_count>& offsets, usize size) :
+				_components(make_pointers(static_cast<u8*>(chunk), offsets, std::index_sequence_for<Args...>())),
+				_size(size) {
+		}
+
+		usize size() const {
+			return _size;
+		}
+
+		const pointers& components() const {
+			return _components;
+		}
+
+		template<usize I>
+		auto* get() const {
+			return std::get<I>(_components);
+		}
+
+		// Calls func(Args&...) for every entity, as a plain walk over the arrays so it can be vectorized
+		template<typename F>
+		void for_each(F&& func) const {
+			std::apply([&](Args*... components) {
+				for(usize i = 0; i != _size; ++i) {
+					func(components[i]...);
+				}
+			}, _components);
+		}
+
+	private:
+		template<usize... I>
+		static pointers make_pointers(u8* chunk, const std::array<usize, component_count>& offsets, std::index_sequence<I...>) {
+			unused(chunk, offsets);
+			return pointers(reinterpret_cast<Args*>(chunk + offsets[I])...);
+		}
+
+		pointers _components;
+		usize _size = 0;
+};
+
+
 template<typename... Args>
 using ComponentViewRange = core::Range<ComponentIterator<Args...>, ComponentEndIterator>;
 
@@ -221,6 +273,9 @@ struct ComponentView : ComponentViewRange<Args...> {
 	ComponentView(ComponentIterator<Args...> beg, usize size) : ComponentViewRange<Args...>(std::move(beg), ComponentEndIterator(size)) {
 	}
 
+	ComponentView(ComponentIterator<Args...> beg, ComponentEndIterator end) : ComponentViewRange<Args...>(std::move(beg), end) {
+	}
+
 	decltype(auto) operator[](usize index) const {
 		y_debug_assert(index < this->size());
 		return *(this->begin() + index);
@@ -24,6 +24,7 @@ SOFTWARE.
 
 #include "Archetype.h"
 
+#include <y/concurrent/parallel.h>
 #include <y/utils/iter.h>
 
 namespace y {
@@ -55,7 +56,7 @@ class EntityIterator {
 
 		void advance() {
 			y_debug_assert(!_components.is_empty());
-			_components = core::Range(_components.begin() + 1, _components.end());
+			_components = ComponentView<Args...>(_components.begin() + 1, _components.end());
 			if(_components.is_empty()) {
 				advance_archetype();
 			}
@@ -94,7 +95,7 @@ class EntityIterator {
 		}
 
 		bool operator==(const EntityIterator& other) const {
-			return _archetypes == other._archetype && _archetype_index == other._archetype_index && _components.size() == other._components.size();
+			return _archetypes.data() == other._archetypes.data() && _archetype_index == other._archetype_index && _components.size() == other._components.size();
 		}
 
 		bool operator!=(const EntityIterator& other) const {
@@ -130,12 +131,77 @@ template<typename... Args>
 using EntityViewRange = core::Range<EntityIterator<Args...>, EndIterator>;
 
 template<typename... Args>
-struct EntityView : EntityViewRange<Args...> {
-	EntityView() : EntityView(EntityIterator<Args...>({})) {
-	}
+class EntityView : public EntityViewRange<Args...> {
+	public:
+		EntityView() : EntityView(core::Span<std::unique_ptr<Archetype>>()) {
+		}
+
+		EntityView(core::Span<std::unique_ptr<Archetype>> archetypes) : EntityViewRange<Args...>(EntityIterator<Args...>(archetypes), EndIterator()), _archetypes(archetypes) {
+		}
+
+		usize chunk_count() const {
+			usize count = 0;
+			for_each_match([&](const Archetype* archetype, const auto&) { count += archetype->chunk_count(); });
+			return count;
+		}
+
+		// Calls func(const ComponentChunk<Args...>&) once per non empty chunk
+		template<typename F>
+		void for_each_chunk(F&& func) const {
+			for_each_match([&](const Archetype* archetype, const auto& offsets) { archetype->template for_each_chunk<Args...>(offsets, func); });
+		}
+
+		// Calls func(const ComponentChunk<Args...>&) once per chunk, chunks are spread over the pool.
+		// Every entity is visited by exactly one thread, so func can write to the components it was given
+		// but the world must not be structurally modified (no entity or component added or removed) until it returns.
+		template<typename F>
+		void for_each_chunk_parallel(F&& func, concurrent::StaticThreadPool& pool = concurrent::default_thread_pool()) const {
+			// Chunks are numbered across the matching archetypes, each work unit looks up where its range starts
+			core::SmallVector<MatchRange, 16> matches;
+			usize chunk_count = 0;
+			for_each_match([&](const Archetype* archetype, const auto& offsets) {
+				if(const usize count = archetype->chunk_count()) {
+					matches.emplace_back(MatchRange{archetype, offsets, chunk_count, count});
+					chunk_count += count;
+				}
+			});
+
+			concurrent::parallel_for_chunks(chunk_count, 1, [&](usize begin, usize end) {
+				auto match = std::upper_bound(matches.begin(), matches.end(), begin, [](usize chunk, const MatchRange& m) { return chunk < m.first_chunk; }) - 1;
+				for(; begin != end; ++match) {
+					const usize match_end = std::min(end, match->first_chunk + match->chunk_count);
+					match->archetype->template for_each_chunk<Args...>(match->offsets, begin - match->first_chunk, match_end - match->first_chunk, func);
+					begin = match_end;
+				}
+			}, pool);
+		}
+
+		// Calls func(Args&...) for every entity, with the same guarantees as for_each_chunk_parallel
+		template<typename F>
+		void par_each(F&& func, concurrent::StaticThreadPool& pool = concurrent::default_thread_pool()) const {
+			for_each_chunk_parallel([&](const ComponentChunk<Args...>& chunk) { chunk.for_each(func); }, pool);
+		}
+
+	private:
+		struct MatchRange {
+			const Archetype* archetype = nullptr;
+			std::array<usize, sizeof...(Args)> offsets;
+			usize first_chunk = 0;
+			usize chunk_count = 0;
+		};
+
+		// Calls func(archetype, offsets) for every archetype that has all the components
+		template<typename F>
+		void for_each_match(F&& func) const {
+			for(const auto& archetype : _archetypes) {
+				std::array<usize, sizeof...(Args)> offsets;
+				if(archetype->template component_offsets<Args...>(offsets)) {
+					func(archetype.get(), offsets);
+				}
+			}
+		}
 
-	EntityView(EntityIterator<Args...> beg) : EntityViewRange<Args...>(std::move(beg), EndIterator()) {
-	}
+		core::Span<std::unique_ptr<Archetype>> _archetypes;
 };
 
 }
@@ -22,6 +22,8 @@ SOFTWARE.
 
 #include "EntityWorld.h"
 
+#include <y/utils/hash.h>
+
 namespace y {
 namespace ecs {
 
@@ -29,7 +31,9 @@ bool EntityWorld::exists(EntityID id) const {
 	if(id.index() >= _entities.size()) {
 		return false;
 	}
-	return _entities[id.index()].id.version() == id.version();
+	// Removed entities keep their version but lose their index
+	const EntityID& stored = _entities[id.index()].id;
+	return stored.is_valid() && stored.version() == id.version();
 }
 
 EntityID EntityWorld::create_entity() {
@@ -38,17 +42,39 @@ EntityID EntityWorld::create_entity() {
 	return data.id = EntityID(_entities.size() - 1);
 }
 
+core::Vector<EntityID> EntityWorld::create_entities(usize count) {
+	_entities.set_min_capacity(_entities.size() + count);
+	auto ids = core::vector_with_capacity<EntityID>(count);
+	for(usize i = 0; i != count; ++i) {
+		ids << create_entity();
+	}
+	return ids;
+}
+
 void EntityWorld::remove_entity(EntityID id) {
 	check_exists(id);
 
 	EntityData& data = _entities[id.index()];
-	if(!data.archetype) {
-		data.invalidate();
-	} else {
-		data.archetype->remove_entity(data);
+	if(data.archetype) {
+		EntityData* ptr = &data;
+		remove_from_archetype(core::Span<EntityData*>(ptr));
+	}
+	data.invalidate();
+}
+
+void EntityWorld::remove_entities(core::Span<EntityID> ids) {
+	const core::Vector<EntityData*> batch = sorted_batch(ids);
+	for(usize begin = 0; begin != batch.size();) {
+		const usize end = batch_group_end(batch, begin);
+		if(batch[begin]->archetype) {
+			remove_from_archetype(core::Span<EntityData*>(batch.data() + begin, end - begin));
+		}
+		begin = end;
+	}
+
+	for(EntityData* data : batch) {
+		data->invalidate();
 	}
-	y_debug_assert(!data.archetype);
-	y_debug_assert(!data.is_valid());
 }
 
 
@@ -56,18 +82,178 @@ core::Span<std::unique_ptr<Archetype>> EntityWorld::archetypes() const {
 	return _archetypes;
 }
 
+u64 EntityWorld::structural_version() const {
+	return _structural_version;
+}
+
+u64 EntityWorld::archetype_generation() const {
+	return _archetype_generation;
+}
+
+void EntityWorld::post_deserialize() {
+	_archetype_index.clear();
+	_root_edges.clear();
+
+	for(const auto& arc : _archetypes) {
+		arc->_add_edges.clear();
+		arc->_remove_edges.clear();
+		index_archetype(arc.get());
+	}
+
+	++_structural_version;
+	++_archetype_generation;
+}
+
 void EntityWorld::transfer(EntityData& data, Archetype* to) {
-	y_debug_assert(exists(data.id));
-	y_debug_assert(data.archetype != to);
+	EntityData* ptr = &data;
+	transfer(core::MutableSpan<EntityData*>(ptr), to);
+}
 
-	if(data.archetype) {
-		data.archetype->transfer_to(to, data);
-	} else {
-		to->add_entity(data);
+void EntityWorld::transfer(core::MutableSpan<EntityData*> group, Archetype* to) {
+	Archetype* from = group[0]->archetype;
+	y_debug_assert(from != to);
+
+	const usize first = from ? from->migrate_to(to, group) : to->create_slots(group);
+	if(from) {
+		update_moved(from, group);
+	}
+
+	for(usize i = 0; i != group.size(); ++i) {
+		y_debug_assert(exists(group[i]->id));
+		y_debug_assert(group[i]->archetype == from);
+		group[i]->archetype = to;
+		group[i]->archetype_index = first + group.size() - 1 - i;
+	}
+}
+
+void EntityWorld::remove_from_archetype(core::Span<EntityData*> group) {
+	Archetype* from = group[0]->archetype;
+	from->remove_slots(group);
+	update_moved(from, group);
+}
+
+void EntityWorld::update_moved(Archetype* from, core::Span<EntityData*> group) {
+	// Every freed slot that is still in use was filled with an entity from the end of the archetype
+	const usize entity_count = from->entity_count();
+	for(const EntityData* data : group) {
+		const usize index = data->archetype_index;
+		if(index < entity_count) {
+			_entities[from->_entity_ids[index].index()].archetype_index = index;
+		}
 	}
+}
+
+void EntityWorld::add_new_entities(core::Span<EntityID> ids, Archetype* to) {
+	// Reversed so that entities are laid out in creation order
+	auto group = core::vector_with_capacity<EntityData*>(ids.size());
+	for(usize i = ids.size(); i != 0; --i) {
+		group << &_entities[ids[i - 1].index()];
+	}
+	transfer(group, to);
+}
+
+core::Vector<EntityData*> EntityWorld::sorted_batch(core::Span<EntityID> ids) {
+	auto batch = core::vector_with_capacity<EntityData*>(ids.size());
+	for(const EntityID id : ids) {
+		check_exists(id);
+		batch << &_entities[id.index()];
+	}
+
+	sort(batch.begin(), batch.end(), [](const EntityData* a, const EntityData* b) {
+		if(a->archetype != b->archetype) {
+			return std::less<Archetype*>()(a->archetype, b->archetype);
+		}
+		if(a->archetype_index != b->archetype_index) {
+			return a->archetype_index > b->archetype_index;
+		}
+		return std::less<const EntityData*>()(a, b);
+	});
+
+	// An id given more than once would be moved or removed twice
+	const auto unique_end = std::unique(batch.begin(), batch.end());
+	while(batch.end() != unique_end) {
+		batch.pop();
+	}
+
+	return batch;
+}
+
+usize EntityWorld::batch_group_end(core::Span<EntityData*> batch, usize begin) {
+	usize end = begin + 1;
+	while(end != batch.size() && batch[end]->archetype == batch[begin]->archetype) {
+		++end;
+	}
+	return end;
+}
+
+void EntityWorld::remove_types(EntityData& data, u32 key, core::Span<u32> type_indexes) {
+	Archetype* old_arc = data.archetype;
+
+	TypeIndexList types;
+	for(const ComponentRuntimeInfo& info : old_arc->component_infos()) {
+		if(!std::binary_search(type_indexes.begin(), type_indexes.end(), info.type_id)) {
+			types << info.type_id;
+		}
+	}
+
+	if(types.is_empty()) {
+		// Entities without components don't belong to any archetype
+		EntityData* ptr = &data;
+		remove_from_archetype(core::Span<EntityData*>(ptr));
+		data.archetype = nullptr;
+		return;
+	}
+
+	Archetype* new_arc = old_arc;
+	if(types.size() != old_arc->component_count()) {
+		new_arc = find_archetype(types);
+		if(!new_arc) {
+			new_arc = add_archetype(old_arc->archetype_without(type_indexes));
+		}
+	}
+
+	old_arc->_remove_edges[key] = new_arc;
+	if(new_arc != old_arc) {
+		transfer(data, new_arc);
+	}
+}
+
+Archetype* EntityWorld::find_archetype(core::Span<u32> type_indexes) {
+	// Every archetype is indexed, a miss means that it doesn't exist
+	const auto it = _archetype_index.find(signature_hash(type_indexes));
+	if(it == _archetype_index.end()) {
+		return nullptr;
+	}
+
+	for(Archetype* arc = it->second; arc; arc = arc->_next_with_same_hash) {
+		if(arc->matches_type_indexes(type_indexes)) {
+			return arc;
+		}
+	}
+	return nullptr;
+}
+
+Archetype* EntityWorld::add_archetype(std::unique_ptr<Archetype> archetype) {
+	Archetype* arc = _archetypes.emplace_back(std::move(archetype)).get();
+	index_archetype(arc);
+	++_structural_version;
+
+	return arc;
+}
+
+void EntityWorld::index_archetype(Archetype* arc) {
+	TypeIndexList types;
+	for(const ComponentRuntimeInfo& info : arc->component_infos()) {
+		types << info.type_id;
+	}
+
+	// Archetypes whose signatures collide are chained
+	const auto [it, inserted] = _archetype_index.emplace(signature_hash(types), arc);
+	arc->_next_with_same_hash = inserted ? nullptr : std::exchange(it->second, arc);
+}
 
-	y_debug_assert(data.archetype == to);
-	y_debug_assert(exists(data.id));
+u64 EntityWorld::signature_hash(core::Span<u32> type_indexes) {
+	return hash_bytes(type_indexes.data(), type_indexes.size() * sizeof(u32));
 }
 
 void EntityWorld::check_exists(EntityID id) const {
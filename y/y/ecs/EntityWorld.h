@@ -35,10 +35,19 @@ class EntityWorld : NonCopyable {
 		bool exists(EntityID id) const;
 
 		EntityID create_entity();
+		core::Vector<EntityID> create_entities(usize count);
+
 		void remove_entity(EntityID id);
+		void remove_entities(core::Span<EntityID> ids);
 
 		core::Span<std::unique_ptr<Archetype>> archetypes() const;
 
+		// Changes every time an archetype is added, archetypes are never removed or reordered
+		u64 structural_version() const;
+
+		// Changes when the archetypes are replaced by deserialization, pointers to the old ones are invalid
+		u64 archetype_generation() const;
+
 
 
 		template<typename... Args>
@@ -75,54 +84,122 @@ class EntityWorld : NonCopyable {
 			check_exists(id);
 
 			EntityData& data = _entities[id.index()];
-			Archetype* old_arc = data.archetype;
-			Archetype* new_arc = nullptr;
+			transfer(data, archetype_with<Args...>(data.archetype));
+		}
 
-			core::Vector types = core::vector_with_capacity<u32>((old_arc ? old_arc->component_count() : 0) + sizeof...(Args));
-			{
-				{
-					if(old_arc) {
-						for(const ComponentRuntimeInfo& info : old_arc->component_infos()) {
-							types << info.type_id;
-						}
-					}
-					add_type_indexes<0, Args...>(types);
-					sort(types.begin(), types.end());
-				}
+		// Entities are moved one archetype at a time, with their components created a whole chunk at a time
+		template<typename... Args>
+		void add_components(core::Span<EntityID> ids) {
+			core::Vector<EntityData*> batch = sorted_batch(ids);
+			for(usize begin = 0; begin != batch.size();) {
+				const usize end = batch_group_end(batch, begin);
+				const core::MutableSpan<EntityData*> group(batch.data() + begin, end - begin);
+				transfer(group, archetype_with<Args...>(group[0]->archetype));
+				begin = end;
+			}
+		}
 
-				for(const auto& arc : _archetypes) {
-					if(arc->matches_type_indexes(types)) {
-						new_arc = arc.get();
-						break;
-					}
-				}
+		template<typename... Args>
+		core::Vector<EntityID> create_entities(usize count) {
+			core::Vector<EntityID> ids = create_entities(count);
+			if(count) {
+				add_new_entities(ids, archetype_with<Args...>(nullptr));
+			}
+			return ids;
+		}
 
-				if(!new_arc) {
-					if(old_arc) {
-						new_arc = _archetypes.emplace_back(old_arc->archetype_with<Args...>()).get();
-					} else {
-						new_arc = _archetypes.emplace_back(Archetype::create<Args...>()).get();
-					}
+
+		template<typename T>
+		void remove_component(EntityID id) {
+			remove_components<T>(id);
+		}
+
+		// Removing components that the entity doesn't have is a no-op
+		template<typename... Args>
+		void remove_components(EntityID id) {
+			check_exists(id);
+
+			EntityData& data = _entities[id.index()];
+			Archetype* old_arc = data.archetype;
+			if(!old_arc) {
+				return;
+			}
+
+			const u32 key = type_list_index<Args...>();
+			if(const auto it = old_arc->_remove_edges.find(key); it != old_arc->_remove_edges.end()) {
+				if(it->second != old_arc) {
+					transfer(data, it->second);
 				}
+				return;
 			}
-			y_debug_assert(new_arc->_component_count == types.size());
-			transfer(data, new_arc);
+
+			TypeIndexList types;
+			add_type_indexes<0, Args...>(types);
+			sort(types.begin(), types.end());
+			remove_types(data, key, types);
 		}
 
 
 		y_serde3(_archetypes)
 
+		// Deserialization replaces the archetypes, lookups and transitions are rebuilt
+		void post_deserialize();
+
 	private:
 		friend class ComponentInfoSerializerBase;
 		friend class EntityWorldSerializer;
 
+		// Big enough that building the type list of an archetype doesn't allocate
+		using TypeIndexList = core::SmallVector<u32, 16>;
+
 		void check_exists(EntityID id) const;
 
 		void transfer(EntityData& data, Archetype* to);
+		void transfer(core::MutableSpan<EntityData*> group, Archetype* to);
+		void remove_from_archetype(core::Span<EntityData*> group);
+		void update_moved(Archetype* from, core::Span<EntityData*> group);
+		void remove_types(EntityData& data, u32 key, core::Span<u32> type_indexes);
+		void add_new_entities(core::Span<EntityID> ids, Archetype* to);
+
+		// Entities of a batch are grouped by archetype, by decreasing index within an archetype. Duplicated ids are dropped
+		core::Vector<EntityData*> sorted_batch(core::Span<EntityID> ids);
+		static usize batch_group_end(core::Span<EntityData*> batch, usize begin);
+
+		Archetype* find_archetype(core::Span<u32> type_indexes);
+		Archetype* add_archetype(std::unique_ptr<Archetype> archetype);
+		void index_archetype(Archetype* arc);
+
+		static u64 signature_hash(core::Span<u32> type_indexes);
 
 
+		// Archetype reached by adding Args to entities of from
+		template<typename... Args>
+		Archetype* archetype_with(Archetype* from) {
+			Archetype*& to = (from ? from->_add_edges : _root_edges)[type_list_index<Args...>()];
+			if(!to) {
+				TypeIndexList types;
+				types.set_min_capacity((from ? from->component_count() : 0) + sizeof...(Args));
+				{
+					if(from) {
+						for(const ComponentRuntimeInfo& info : from->component_infos()) {
+							types << info.type_id;
+						}
+					}
+					add_type_indexes<0, Args...>(types);
+					sort(types.begin(), types.end());
+				}
+
+				to = find_archetype(types);
+				if(!to) {
+					to = add_archetype(from ? from->archetype_with<Args...>() : Archetype::create<Args...>());
+				}
+				y_debug_assert(to->_component_count == types.size());
+			}
+			return to;
+		}
+
 		template<usize I, typename... Args>
-		static void add_type_indexes(core::Vector<u32>& types) {
+		static void add_type_indexes(TypeIndexList& types) {
 			static_assert(sizeof...(Args));
 			if constexpr(I < sizeof...(Args)) {
 				using type = std::tuple_element_t<I, std::tuple<Args...>>;
@@ -153,6 +230,15 @@ class EntityWorld : NonCopyable {
 
 		core::Vector<EntityData> _entities;
 		core::Vector<std::unique_ptr<Archetype>> _archetypes;
+
+		// Archetypes by signature_hash of their sorted type ids, collisions are chained through Archetype::_next_with_same_hash
+		core::SwissHashMap<u64, Archetype*> _archetype_index;
+
+		// Archetypes reached by adding components to entities that have none
+		core::SwissHashMap<u32, Archetype*> _root_edges;
+
+		u64 _structural_version = 0;
+		u64 _archetype_generation = 0;
 };
 
 }
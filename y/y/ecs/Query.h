@@ -0,0 +1,130 @@
+/*******************************
+Copyright (c) 2016-2020 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+
+#ifndef Y_ECS_QUERY_H
+#define Y_ECS_QUERY_H
+
+#include "EntityWorld.h"
+
+namespace y {
+namespace ecs {
+
+// Persistent view: the matching archetypes and their component offsets are computed once and kept up to date
+// with the world structural version, so that per frame queries do no lookup.
+// The world must outlive the query.
+template<typename... Args>
+class Query {
+	public:
+		static constexpr usize component_count = sizeof...(Args);
+
+		Query() = default;
+
+		Query(EntityWorld& world) : _world(&world) {
+			update();
+		}
+
+		// Only looks at archetypes created since the last update (all of them after a deserialization), does nothing if the world didn't change
+		void update() {
+			y_debug_assert(_world);
+			if(_version == _world->structural_version()) {
+				return;
+			}
+
+			if(_generation != _world->archetype_generation()) {
+				_matches.make_empty();
+				_scanned = 0;
+				_generation = _world->archetype_generation();
+			}
+
+			const core::Span<std::unique_ptr<Archetype>> archetypes = _world->archetypes();
+			y_debug_assert(_scanned <= archetypes.size());
+			for(; _scanned != archetypes.size(); ++_scanned) {
+				Match match{archetypes[_scanned].get(), {}};
+				if(match.archetype->template component_offsets<Args...>(match.offsets)) {
+					_matches << match;
+				}
+			}
+			_version = _world->structural_version();
+		}
+
+		usize archetype_count() {
+			update();
+			return _matches.size();
+		}
+
+		usize entity_count() {
+			update();
+			usize count = 0;
+			for(const Match& match : _matches) {
+				count += match.archetype->entity_count();
+			}
+			return count;
+		}
+
+		// Calls func(const ComponentChunk<Args...>&) once per non empty chunk
+		template<typename F>
+		void for_each_chunk(F&& func) {
+			update();
+			for(const Match& match : _matches) {
+				match.archetype->template for_each_chunk<Args...>(match.offsets, func);
+			}
+		}
+
+		// Calls func(Args&...) for every entity
+		template<typename F>
+		void for_each(F&& func) {
+			for_each_chunk([&](const ComponentChunk<Args...>& chunk) { chunk.for_each(func); });
+		}
+
+		// Same guarantees as EntityView::for_each_chunk_parallel, the chunk list is kept between calls
+		template<typename F>
+		void for_each_chunk_parallel(F&& func, concurrent::StaticThreadPool& pool = concurrent::default_thread_pool()) {
+			_chunks.make_empty();
+			for_each_chunk([&](const ComponentChunk<Args...>& chunk) { _chunks << chunk; });
+			concurrent::parallel_for(_chunks, 1, func, pool);
+		}
+
+		template<typename F>
+		void par_each(F&& func, concurrent::StaticThreadPool& pool = concurrent::default_thread_pool()) {
+			for_each_chunk_parallel([&](const ComponentChunk<Args...>& chunk) { chunk.for_each(func); }, pool);
+		}
+
+	private:
+		struct Match {
+			Archetype* archetype = nullptr;
+			std::array<usize, component_count> offsets;
+		};
+
+		EntityWorld* _world = nullptr;
+
+		core::Vector<Match> _matches;
+		core::Vector<ComponentChunk<Args...>> _chunks;
+
+		usize _scanned = 0;
+		u64 _version = u64(-1);
+		u64 _generation = 0;
+};
+
+}
+}
+
+#endif // Y_ECS_QUERY_H
@@ -24,6 +24,8 @@ SOFTWARE.
 
 #include <y/utils.h>
 
+#include <tuple>
+
 namespace y {
 namespace ecs {
 
@@ -46,6 +48,17 @@ static u32 type_index() {
 	return index;
 }
 
+// Identifies a list of component types, used to cache archetype transitions
+template<typename... Args>
+static u32 type_list_index() {
+	static_assert(sizeof...(Args));
+	if constexpr(sizeof...(Args) == 1) {
+		return type_index<Args...>();
+	} else {
+		return type_index<std::tuple<Args...>>();
+	}
+}
+
 
 
 class EntityID {
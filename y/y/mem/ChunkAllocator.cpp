@@ -0,0 +1,310 @@
+/*******************************
+Copyright (c) 2016-2020 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+
+
+#include "ChunkAllocator.h"
+
+#include <cstdlib>
+
+#if defined(Y_OS_LINUX)
+#include <sys/mman.h>
+#elif defined(Y_OS_WIN)
+#include <malloc.h>
+#endif
+
+namespace y {
+namespace memory {
+
+namespace {
+
+static constexpr usize page_size = 4096;
+
+void* map_memory(usize size, usize alignment, bool huge_pages) {
+	y_debug_assert(size % page_size == 0);
+#if defined(Y_OS_LINUX)
+	// Map more than needed and trim both ends to get the alignment
+	const usize extra = alignment > page_size ? alignment : 0;
+	void* ptr = mmap(nullptr, size + extra, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if(ptr == MAP_FAILED) {
+		return nullptr;
+	}
+
+	const usize addr = reinterpret_cast<usize>(ptr);
+	const usize aligned = align_up_to(addr, std::max(alignment, page_size));
+	if(const usize head = aligned - addr) {
+		munmap(ptr, head);
+	}
+	if(const usize tail = addr + size + extra - (aligned + size)) {
+		munmap(reinterpret_cast<void*>(aligned + size), tail);
+	}
+
+	if(huge_pages) {
+		madvise(reinterpret_cast<void*>(aligned), size, MADV_HUGEPAGE);
+	}
+	return reinterpret_cast<void*>(aligned);
+#elif defined(Y_OS_WIN)
+	unused(huge_pages);
+	return _aligned_malloc(size, alignment);
+#else
+	unused(huge_pages);
+	return std::aligned_alloc(alignment, size);
+#endif
+}
+
+void unmap_memory(void* ptr, usize size) {
+#if defined(Y_OS_LINUX)
+	munmap(ptr, size);
+#elif defined(Y_OS_WIN)
+	unused(size);
+	_aligned_free(ptr);
+#else
+	unused(size);
+	std::free(ptr);
+#endif
+}
+
+}
+
+
+// Lives at the start of its (block size aligned) block, chunks follow
+struct ChunkAllocator::Block {
+	SizePool* pool = nullptr;
+
+	Block* prev = nullptr;
+	Block* next = nullptr;
+
+	// Freed chunks, linked through their first bytes
+	void* free_list = nullptr;
+
+	// Chunks are carved lazily so that untouched memory is never committed
+	usize carved = 0;
+	usize used = 0;
+
+	u8* chunk(usize index, usize slot_size) {
+		return reinterpret_cast<u8*>(this) + chunk_alignment + index * slot_size;
+	}
+};
+
+static_assert(sizeof(void*) * 6 <= ChunkAllocator::chunk_alignment);
+
+struct ChunkAllocator::SizePool {
+	usize slot_size = 0;
+	usize chunks_per_block = 0;
+
+	// Blocks with at least one chunk available
+	Block* available = nullptr;
+
+	// Kept for reuse, not in the available list
+	Block* empty = nullptr;
+
+	void link(Block* block) {
+		block->prev = nullptr;
+		block->next = available;
+		if(available) {
+			available->prev = block;
+		}
+		available = block;
+	}
+
+	void unlink(Block* block) {
+		(block->prev ? block->prev->next : available) = block->next;
+		if(block->next) {
+			block->next->prev = block->prev;
+		}
+		block->prev = block->next = nullptr;
+	}
+};
+
+
+ChunkAllocator::ChunkAllocator(usize block_size, bool huge_pages) : _block_size(block_size), _huge_pages(huge_pages) {
+	y_always_assert(block_size && (block_size & (block_size - 1)) == 0, "Block size must be a power of 2");
+	y_always_assert(block_size >= page_size, "Block size must be at least a page");
+}
+
+ChunkAllocator::~ChunkAllocator() {
+	shrink();
+	if(_used_bytes) {
+		y_fatal("Chunks were not freed before allocator destruction (% bytes leaked).", _used_bytes);
+	}
+}
+
+usize ChunkAllocator::slot_size(usize size) const {
+	return align_up_to(std::max(size, usize(1)), chunk_alignment);
+}
+
+bool ChunkAllocator::is_dedicated(usize slot_size) const {
+	// Less than two chunks per block would waste most of the block
+	return slot_size > (_block_size - chunk_alignment) / 2;
+}
+
+ChunkAllocator::SizePool& ChunkAllocator::size_pool(usize slot_size) {
+	for(const auto& pool : _pools) {
+		if(pool->slot_size == slot_size) {
+			return *pool;
+		}
+	}
+
+	auto pool = std::make_unique<SizePool>();
+	pool->slot_size = slot_size;
+	pool->chunks_per_block = (_block_size - chunk_alignment) / slot_size;
+	return *_pools.emplace_back(std::move(pool));
+}
+
+ChunkAllocator::Block* ChunkAllocator::create_block(SizePool& pool) {
+	void* memory = map_memory(_block_size, _block_size, _huge_pages);
+	if(!memory) {
+		return nullptr;
+	}
+
+	_reserved_bytes += _block_size;
+	++_block_count;
+
+	Block* block = ::new(memory) Block();
+	block->pool = &pool;
+	return block;
+}
+
+void ChunkAllocator::release_block(Block* block) {
+	y_debug_assert(!block->used);
+	_reserved_bytes -= _block_size;
+	--_block_count;
+	block->~Block();
+	unmap_memory(block, _block_size);
+}
+
+[[nodiscard]] void* ChunkAllocator::allocate(usize size) noexcept {
+	const usize slot = slot_size(size);
+	const std::unique_lock lock(_lock);
+
+	if(is_dedicated(slot)) {
+		const usize mapped_size = align_up_to(slot, page_size);
+		void* ptr = map_memory(mapped_size, chunk_alignment, _huge_pages);
+		if(ptr) {
+			_reserved_bytes += mapped_size;
+			_used_bytes += slot;
+			++_dedicated_count;
+		}
+		return ptr;
+	}
+
+	SizePool& pool = size_pool(slot);
+	Block* block = pool.available;
+	if(!block) {
+		if(pool.empty) {
+			block = std::exchange(pool.empty, nullptr);
+		} else if(!(block = create_block(pool))) {
+			return nullptr;
+		}
+		pool.link(block);
+	}
+
+	void* ptr = nullptr;
+	if(block->free_list) {
+		ptr = block->free_list;
+		block->free_list = *static_cast<void**>(ptr);
+	} else {
+		y_debug_assert(block->carved < pool.chunks_per_block);
+		ptr = block->chunk(block->carved++, slot);
+	}
+
+	if(++block->used == pool.chunks_per_block) {
+		pool.unlink(block);
+	}
+
+	_used_bytes += slot;
+	return ptr;
+}
+
+void ChunkAllocator::deallocate(void* ptr, usize size) noexcept {
+	if(!ptr) {
+		return;
+	}
+
+	const usize slot = slot_size(size);
+	const std::unique_lock lock(_lock);
+
+	_used_bytes -= slot;
+
+	if(is_dedicated(slot)) {
+		const usize mapped_size = align_up_to(slot, page_size);
+		_reserved_bytes -= mapped_size;
+		--_dedicated_count;
+		unmap_memory(ptr, mapped_size);
+		return;
+	}
+
+	Block* block = reinterpret_cast<Block*>(align_down_to(reinterpret_cast<usize>(ptr), _block_size));
+	SizePool& pool = *block->pool;
+	y_debug_assert(pool.slot_size == slot);
+
+	// Move the block to the front so that the chunk we just freed is the next one reused, while it is still hot
+	if(block->used == pool.chunks_per_block) {
+		pool.link(block);
+	} else if(pool.available != block) {
+		pool.unlink(block);
+		pool.link(block);
+	}
+
+	*static_cast<void**>(ptr) = block->free_list;
+	block->free_list = ptr;
+
+	if(!--block->used) {
+		pool.unlink(block);
+		if(pool.empty) {
+			release_block(block);
+		} else {
+			// Forget the free list so that the block is carved in order again
+			block->free_list = nullptr;
+			block->carved = 0;
+			pool.empty = block;
+		}
+	}
+}
+
+void ChunkAllocator::shrink() {
+	const std::unique_lock lock(_lock);
+	for(const auto& pool : _pools) {
+		if(pool->empty) {
+			release_block(std::exchange(pool->empty, nullptr));
+		}
+	}
+}
+
+ChunkAllocator::Stats ChunkAllocator::stats() const {
+	const std::unique_lock lock(_lock);
+	Stats stats;
+	stats.reserved_bytes = _reserved_bytes;
+	stats.used_bytes = _used_bytes;
+	stats.block_count = _block_count;
+	stats.dedicated_count = _dedicated_count;
+	return stats;
+}
+
+
+PolymorphicAllocatorBase* chunk_allocator() {
+	// Archetypes can outlive any static, so this is never destroyed
+	static PolymorphicAllocatorBase* allocator = new PolymorphicAllocator<ChunkAllocator>();
+	return allocator;
+}
+
+}
+}
@@ -0,0 +1,92 @@
+/*******************************
+Copyright (c) 2016-2020 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+
+#ifndef Y_MEM_CHUNKALLOCATOR_H
+#define Y_MEM_CHUNKALLOCATOR_H
+
+#include "allocators.h"
+
+#include <y/core/Vector.h>
+
+#include <memory>
+#include <mutex>
+
+namespace y {
+namespace memory {
+
+// Pools large, fixed size chunks (like ECS archetype chunks) inside big blocks mapped from the system.
+// Chunks are 64 bytes aligned. Every chunk size gets its own list of blocks, freed chunks are reused first.
+// Each size keeps at most one empty block around, others are given back to the system as soon as they empty.
+class ChunkAllocator : NonMovable {
+	public:
+		static constexpr usize chunk_alignment = 64;
+		static constexpr usize default_block_size = 2 * 1024 * 1024;
+
+		struct Stats {
+			usize reserved_bytes = 0;
+			usize used_bytes = 0;
+			usize block_count = 0;
+			usize dedicated_count = 0;
+		};
+
+		// Huge pages are only a hint, and only used on Linux
+		ChunkAllocator(usize block_size = default_block_size, bool huge_pages = true);
+		~ChunkAllocator();
+
+		[[nodiscard]] void* allocate(usize size) noexcept;
+		void deallocate(void* ptr, usize size) noexcept;
+
+		// Releases the empty blocks kept for reuse
+		void shrink();
+
+		Stats stats() const;
+
+	private:
+		struct Block;
+		struct SizePool;
+
+		usize slot_size(usize size) const;
+		bool is_dedicated(usize slot_size) const;
+
+		SizePool& size_pool(usize slot_size);
+		Block* create_block(SizePool& pool);
+		void release_block(Block* block);
+
+		usize _block_size = 0;
+		bool _huge_pages = false;
+
+		mutable std::mutex _lock;
+		core::Vector<std::unique_ptr<SizePool>> _pools;
+
+		usize _reserved_bytes = 0;
+		usize _used_bytes = 0;
+		usize _block_count = 0;
+		usize _dedicated_count = 0;
+};
+
+// Shared by all archetypes by default, never destroyed
+PolymorphicAllocatorBase* chunk_allocator();
+
+}
+}
+
+#endif // Y_MEM_CHUNKALLOCATOR_H
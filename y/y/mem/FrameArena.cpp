@@ -0,0 +1,284 @@
+/*******************************
+Copyright (c) 2016-2020 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+
+
+#include "FrameArena.h"
+
+#include <cstring>
+
+namespace y {
+namespace memory {
+
+namespace {
+
+static constexpr usize shared_arena_index = FrameArena::max_thread_arenas;
+static constexpr usize unassigned_slot = usize(-1);
+
+static_assert(FrameArena::max_thread_arenas <= 64);
+
+// Each live thread owns one slot, slots are recycled when threads exit
+std::atomic<u64> used_thread_slots = 0;
+
+thread_local usize thread_slot = unassigned_slot;
+
+struct ThreadSlotReleaser {
+	~ThreadSlotReleaser() {
+		if(thread_slot < shared_arena_index) {
+			used_thread_slots.fetch_and(~(u64(1) << thread_slot));
+		}
+		thread_slot = shared_arena_index;
+	}
+};
+
+thread_local ThreadSlotReleaser thread_slot_releaser;
+
+usize acquire_thread_slot() {
+	u64 used = used_thread_slots.load();
+	for(;;) {
+		usize slot = 0;
+		while(slot != shared_arena_index && (used & (u64(1) << slot))) {
+			++slot;
+		}
+		if(slot == shared_arena_index) {
+			return slot;
+		}
+		if(used_thread_slots.compare_exchange_weak(used, used | (u64(1) << slot))) {
+			return slot;
+		}
+	}
+}
+
+usize current_thread_slot() {
+	if(thread_slot == unassigned_slot) {
+		thread_slot = acquire_thread_slot();
+		// Registers the destructor that gives the slot back
+		unused(thread_slot_releaser);
+	}
+	return thread_slot;
+}
+
+}
+
+
+struct FrameArena::Page {
+	Page* next = nullptr;
+	usize size = 0;
+
+	static constexpr usize header_size = align_up_to_max(sizeof(Page*) + sizeof(usize));
+
+	static Page* create(usize size, Page* next) {
+		void* ptr = std::malloc(header_size + size);
+		if(!ptr) {
+			return nullptr;
+		}
+		return ::new(ptr) Page{next, size};
+	}
+
+	u8* data() {
+		return reinterpret_cast<u8*>(this) + header_size;
+	}
+};
+
+struct FrameArena::SubArena : NonMovable {
+	// Current page first, all others are overflow pages
+	Page* pages = nullptr;
+	u8* cursor = nullptr;
+	u8* end = nullptr;
+
+	// Only written by the owner, atomics so that stats can read them
+	std::atomic<usize> allocated = 0;
+	std::atomic<usize> high_water = 0;
+	std::atomic<usize> reserved = 0;
+
+	~SubArena() {
+		release_pages(pages);
+	}
+
+	static void release_pages(Page* page) {
+		while(page) {
+			Page* next = page->next;
+			std::free(page);
+			page = next;
+		}
+	}
+
+	bool add_page(usize size) {
+		Page* page = Page::create(size, pages);
+		if(!page) {
+			return false;
+		}
+		pages = page;
+		cursor = page->data();
+		end = cursor + size;
+		reserved.store(reserved.load(std::memory_order_relaxed) + size, std::memory_order_relaxed);
+		return true;
+	}
+
+	void* allocate(usize size, usize alignment, usize page_size) {
+		u8* ptr = align(cursor, alignment);
+		if(!ptr || ptr + size > end) {
+			if(!add_page(std::max(page_size, size + alignment))) {
+				return nullptr;
+			}
+			ptr = align(cursor, alignment);
+		}
+		cursor = ptr + size;
+
+		const usize total = allocated.load(std::memory_order_relaxed) + size;
+		allocated.store(total, std::memory_order_relaxed);
+		if(total > high_water.load(std::memory_order_relaxed)) {
+			high_water.store(total, std::memory_order_relaxed);
+		}
+		return ptr;
+	}
+
+	void deallocate(void* ptr, usize size) {
+		if(static_cast<u8*>(ptr) + size == cursor) {
+			cursor = static_cast<u8*>(ptr);
+			allocated.store(allocated.load(std::memory_order_relaxed) - size, std::memory_order_relaxed);
+		}
+	}
+
+	void reset() {
+		if(pages && pages->next) {
+			// Merge overflow pages so that the whole frame fits in one page next time
+			const usize size = reserved.load(std::memory_order_relaxed);
+			release_pages(pages);
+			pages = nullptr;
+			reserved = 0;
+			if(!add_page(size)) {
+				cursor = end = nullptr;
+			}
+		} else if(pages) {
+#ifdef Y_DEBUG
+			std::memset(pages->data(), 0xCD, cursor - pages->data());
+#endif
+			cursor = pages->data();
+		}
+		allocated = 0;
+		high_water = 0;
+	}
+
+	static u8* align(u8* ptr, usize alignment) {
+		if(!ptr) {
+			return nullptr;
+		}
+		return reinterpret_cast<u8*>(align_up_to(reinterpret_cast<usize>(ptr), alignment));
+	}
+};
+
+
+FrameArena::FrameArena(usize page_size) : _page_size(page_size) {
+}
+
+FrameArena::~FrameArena() {
+	for(auto& sub : _sub_arenas) {
+		delete sub.load();
+	}
+}
+
+FrameArena::SubArena& FrameArena::sub_arena(usize index) {
+	// Slots are owned by a single thread (or under _shared_lock), nobody else can create this sub-arena
+	SubArena* sub = _sub_arenas[index].load(std::memory_order_acquire);
+	if(!sub) {
+		sub = new SubArena();
+		_sub_arenas[index].store(sub, std::memory_order_release);
+	}
+	return *sub;
+}
+
+[[nodiscard]] void* FrameArena::allocate(usize size, usize alignment) noexcept {
+	y_debug_assert(alignment && (alignment & (alignment - 1)) == 0);
+
+	const usize index = current_thread_slot();
+	if(index == shared_arena_index) {
+		const std::unique_lock lock(_shared_lock);
+		return sub_arena(index).allocate(size, alignment, _page_size);
+	}
+	return sub_arena(index).allocate(size, alignment, _page_size);
+}
+
+void FrameArena::deallocate(void* ptr, usize size) noexcept {
+	if(!ptr) {
+		return;
+	}
+
+	const usize index = current_thread_slot();
+	if(index == shared_arena_index) {
+		const std::unique_lock lock(_shared_lock);
+		sub_arena(index).deallocate(ptr, size);
+	} else {
+		sub_arena(index).deallocate(ptr, size);
+	}
+}
+
+void FrameArena::reset() {
+	_last_frame_bytes = frame_peak_bytes();
+	_peak_bytes = std::max(_peak_bytes, _last_frame_bytes);
+
+	for(auto& sub : _sub_arenas) {
+		if(SubArena* s = sub.load(std::memory_order_acquire)) {
+			s->reset();
+		}
+	}
+}
+
+usize FrameArena::allocated_bytes() const {
+	usize total = 0;
+	for(const auto& sub : _sub_arenas) {
+		if(const SubArena* s = sub.load(std::memory_order_acquire)) {
+			total += s->allocated.load(std::memory_order_relaxed);
+		}
+	}
+	return total;
+}
+
+usize FrameArena::frame_peak_bytes() const {
+	usize total = 0;
+	for(const auto& sub : _sub_arenas) {
+		if(const SubArena* s = sub.load(std::memory_order_acquire)) {
+			total += s->high_water.load(std::memory_order_relaxed);
+		}
+	}
+	return total;
+}
+
+usize FrameArena::last_frame_bytes() const {
+	return _last_frame_bytes;
+}
+
+usize FrameArena::peak_bytes() const {
+	return std::max(_peak_bytes, frame_peak_bytes());
+}
+
+usize FrameArena::reserved_bytes() const {
+	usize total = 0;
+	for(const auto& sub : _sub_arenas) {
+		if(const SubArena* s = sub.load(std::memory_order_acquire)) {
+			total += s->reserved.load(std::memory_order_relaxed);
+		}
+	}
+	return total;
+}
+
+}
+}
@@ -0,0 +1,115 @@
+/*******************************
+Copyright (c) 2016-2020 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+
+#ifndef Y_MEM_FRAMEARENA_H
+#define Y_MEM_FRAMEARENA_H
+
+#include "allocators.h"
+
+#include <y/core/Vector.h>
+
+#include <array>
+#include <atomic>
+#include <mutex>
+
+namespace y {
+namespace memory {
+
+// Bump allocator for data that does not outlive the frame.
+// Every thread allocates from its own sub-arena, so allocations never synchronize.
+// When a sub-arena runs out it chains overflow pages, which get merged into a single page on reset.
+class FrameArena : NonMovable {
+	public:
+		static constexpr usize default_page_size = 64 * 1024;
+		static constexpr usize max_thread_arenas = 64;
+
+		FrameArena(usize page_size = default_page_size);
+		~FrameArena();
+
+		[[nodiscard]] void* allocate(usize size, usize alignment = max_alignment) noexcept;
+
+		// Only reclaims memory if ptr is the last allocation of the calling thread
+		void deallocate(void* ptr, usize size) noexcept;
+
+		// Invalidates everything allocated since the last reset, no thread should be using the arena
+		void reset();
+
+		// Bytes allocated since the last reset, only exact if no other thread is allocating
+		usize allocated_bytes() const;
+
+		// Highest allocated_bytes reached this frame
+		usize frame_peak_bytes() const;
+
+		// Peak of the last frame, and of all frames since the arena was created
+		usize last_frame_bytes() const;
+		usize peak_bytes() const;
+		usize reserved_bytes() const;
+
+	private:
+		struct Page;
+		struct SubArena;
+
+		SubArena& sub_arena(usize index);
+
+		usize _page_size = 0;
+
+		// The last one is shared by threads that could not get a slot, and is guarded by _shared_lock
+		std::array<std::atomic<SubArena*>, max_thread_arenas + 1> _sub_arenas = {};
+		std::mutex _shared_lock;
+
+		usize _last_frame_bytes = 0;
+		usize _peak_bytes = 0;
+};
+
+
+// Allocates from a FrameArena, default constructed ones use the global allocator
+// Moving vectors moves their allocator along, copies allocate from the global allocator.
+class FrameArenaAllocator {
+	public:
+		FrameArenaAllocator() = default;
+
+		FrameArenaAllocator(FrameArena& arena) : _arena(&arena) {
+		}
+
+		[[nodiscard]] void* allocate(usize size) noexcept {
+			return _arena ? _arena->allocate(size) : global_allocator()->allocate(size);
+		}
+
+		void deallocate(void* ptr, usize size) noexcept {
+			if(_arena) {
+				_arena->deallocate(ptr, size);
+			} else {
+				global_allocator()->deallocate(ptr, size);
+			}
+		}
+
+	private:
+		FrameArena* _arena = nullptr;
+};
+
+template<typename T>
+using FrameVector = core::Vector<T, core::DefaultVectorResizePolicy, StdAllocatorAdapter<T, FrameArenaAllocator>>;
+
+}
+}
+
+#endif // Y_MEM_FRAMEARENA_H
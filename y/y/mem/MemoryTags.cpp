@@ -0,0 +1,230 @@
+/*******************************
+Copyright (c) 2016-2020 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+
+
+#include "MemoryTags.h"
+
+#include <atomic>
+#include <mutex>
+
+namespace y {
+namespace memory {
+
+namespace {
+
+// Thread local deltas are pushed to the global counters once they reach this size
+static constexpr i64 flush_threshold = 64 * 1024;
+
+struct GlobalTagCounters {
+	std::atomic<i64> live_bytes = 0;
+	std::atomic<i64> peak_bytes = 0;
+
+	// Totals of the threads that exited
+	std::atomic<u64> retired_allocation_count = 0;
+	std::atomic<u64> retired_allocated_bytes = 0;
+
+	void flush(i64 bytes) {
+		const i64 live = live_bytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+		i64 peak = peak_bytes.load(std::memory_order_relaxed);
+		while(live > peak && !peak_bytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+		}
+	}
+};
+
+struct ThreadCounters;
+
+struct Tracker {
+	std::array<GlobalTagCounters, memory_tag_count> tags;
+
+	// Only locked when threads start or exit, and to read stats
+	std::mutex threads_lock;
+	ThreadCounters* threads = nullptr;
+};
+
+// Never destroyed: static objects might still free memory during shutdown
+Tracker& tracker() {
+	static Tracker* tracker = new Tracker();
+	return *tracker;
+}
+
+thread_local MemoryTag current_tag = MemoryTag::Untagged;
+thread_local bool thread_counters_destroyed = false;
+
+struct ThreadCounters : NonMovable {
+	struct TagCounters {
+		// Only written by the owning thread, atomics so that stats can read them
+		std::atomic<i64> pending_bytes = 0;
+		std::atomic<u64> allocation_count = 0;
+		std::atomic<u64> allocated_bytes = 0;
+	};
+
+	std::array<TagCounters, memory_tag_count> tags;
+
+	ThreadCounters* prev = nullptr;
+	ThreadCounters* next = nullptr;
+
+	ThreadCounters() {
+		Tracker& t = tracker();
+		const std::unique_lock lock(t.threads_lock);
+		next = t.threads;
+		if(next) {
+			next->prev = this;
+		}
+		t.threads = this;
+	}
+
+	~ThreadCounters() {
+		Tracker& t = tracker();
+		const std::unique_lock lock(t.threads_lock);
+		for(usize i = 0; i != memory_tag_count; ++i) {
+			GlobalTagCounters& global = t.tags[i];
+			global.flush(tags[i].pending_bytes.load(std::memory_order_relaxed));
+			global.retired_allocation_count.fetch_add(tags[i].allocation_count.load(std::memory_order_relaxed), std::memory_order_relaxed);
+			global.retired_allocated_bytes.fetch_add(tags[i].allocated_bytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+		}
+
+		(prev ? prev->next : t.threads) = next;
+		if(next) {
+			next->prev = prev;
+		}
+
+		thread_counters_destroyed = true;
+	}
+
+	void track(MemoryTag tag, i64 bytes) {
+		TagCounters& counters = tags[usize(tag)];
+		if(bytes > 0) {
+			counters.allocation_count.store(counters.allocation_count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+			counters.allocated_bytes.store(counters.allocated_bytes.load(std::memory_order_relaxed) + bytes, std::memory_order_relaxed);
+		}
+
+		i64 pending = counters.pending_bytes.load(std::memory_order_relaxed) + bytes;
+		if(pending >= flush_threshold || pending <= -flush_threshold) {
+			tracker().tags[usize(tag)].flush(pending);
+			pending = 0;
+		}
+		counters.pending_bytes.store(pending, std::memory_order_relaxed);
+	}
+};
+
+thread_local ThreadCounters thread_counters;
+
+void track(MemoryTag tag, i64 bytes) {
+	y_debug_assert(tag < MemoryTag::MaxTags);
+	if(!thread_counters_destroyed) {
+		thread_counters.track(tag, bytes);
+	} else {
+		GlobalTagCounters& global = tracker().tags[usize(tag)];
+		global.flush(bytes);
+		if(bytes > 0) {
+			global.retired_allocation_count.fetch_add(1, std::memory_order_relaxed);
+			global.retired_allocated_bytes.fetch_add(bytes, std::memory_order_relaxed);
+		}
+	}
+}
+
+}
+
+
+const char* memory_tag_name(MemoryTag tag) {
+	const char* names[] = {"Untagged", "ECS", "Containers", "Assets", "Serde"};
+	static_assert(sizeof(names) / sizeof(names[0]) == memory_tag_count);
+	return names[usize(tag)];
+}
+
+MemoryTag current_memory_tag() {
+	return current_tag;
+}
+
+ScopedMemoryTag::ScopedMemoryTag(MemoryTag tag) : _previous(current_tag) {
+	y_debug_assert(tag < MemoryTag::MaxTags);
+	current_tag = tag;
+}
+
+ScopedMemoryTag::~ScopedMemoryTag() {
+	current_tag = _previous;
+}
+
+void track_allocation(MemoryTag tag, usize size) {
+	track(tag, i64(size));
+}
+
+void track_deallocation(MemoryTag tag, usize size) {
+	track(tag, -i64(size));
+}
+
+MemoryTagReport memory_tag_stats() {
+	Tracker& t = tracker();
+
+	std::array<i64, memory_tag_count> live = {};
+	MemoryTagReport report = {};
+	{
+		const std::unique_lock lock(t.threads_lock);
+		for(usize i = 0; i != memory_tag_count; ++i) {
+			const GlobalTagCounters& global = t.tags[i];
+			live[i] = global.live_bytes.load(std::memory_order_relaxed);
+			report[i].allocation_count = global.retired_allocation_count.load(std::memory_order_relaxed);
+			report[i].allocated_bytes = global.retired_allocated_bytes.load(std::memory_order_relaxed);
+		}
+
+		for(const ThreadCounters* counters = t.threads; counters; counters = counters->next) {
+			for(usize i = 0; i != memory_tag_count; ++i) {
+				live[i] += counters->tags[i].pending_bytes.load(std::memory_order_relaxed);
+				report[i].allocation_count += counters->tags[i].allocation_count.load(std::memory_order_relaxed);
+				report[i].allocated_bytes += counters->tags[i].allocated_bytes.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+	for(usize i = 0; i != memory_tag_count; ++i) {
+		// Memory freed by another thread than the one that allocated it can make the sum briefly negative
+		const i64 peak = t.tags[i].peak_bytes.load(std::memory_order_relaxed);
+		report[i].live_bytes = usize(std::max(live[i], i64(0)));
+		report[i].peak_bytes = usize(std::max(peak, live[i]));
+	}
+
+	return report;
+}
+
+
+const MemoryTagReport& MemoryTagSampler::sample() {
+	const MemoryTagReport report = memory_tag_stats();
+	const double elapsed = _timer.reset().to_secs();
+	for(usize i = 0; i != memory_tag_count; ++i) {
+		MemoryTagStats& stats = _report[i];
+		const double allocations = double(report[i].allocation_count - stats.allocation_count);
+		const double bytes = double(report[i].allocated_bytes - stats.allocated_bytes);
+		stats = report[i];
+		if(elapsed > 0.0) {
+			stats.allocations_per_sec = allocations / elapsed;
+			stats.bytes_per_sec = bytes / elapsed;
+		}
+	}
+	return _report;
+}
+
+const MemoryTagReport& MemoryTagSampler::last_sample() const {
+	return _report;
+}
+
+}
+}
@@ -0,0 +1,145 @@
+/*******************************
+Copyright (c) 2016-2020 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+
+#ifndef Y_MEM_MEMORYTAGS_H
+#define Y_MEM_MEMORYTAGS_H
+
+#include "memory.h"
+
+#include <y/core/Chrono.h>
+#include <y/core/Vector.h>
+
+#include <array>
+
+namespace y {
+namespace memory {
+
+enum class MemoryTag : u8 {
+	Untagged,
+	Ecs,
+	Containers,
+	Assets,
+	Serde,
+
+	MaxTags
+};
+
+static constexpr usize memory_tag_count = usize(MemoryTag::MaxTags);
+
+const char* memory_tag_name(MemoryTag tag);
+
+
+// The innermost scope of the calling thread, Untagged if none
+MemoryTag current_memory_tag();
+
+// Allocators created inside the scope charge their memory to the tag, even after the scope ends
+class ScopedMemoryTag : NonMovable {
+	public:
+		explicit ScopedMemoryTag(MemoryTag tag);
+		~ScopedMemoryTag();
+
+	private:
+		MemoryTag _previous;
+};
+
+
+// Counted in thread local counters, which are only merged when stats are queried
+void track_allocation(MemoryTag tag, usize size);
+void track_deallocation(MemoryTag tag, usize size);
+
+struct MemoryTagStats {
+	usize live_bytes = 0;
+	usize peak_bytes = 0;
+
+	u64 allocation_count = 0;
+	u64 allocated_bytes = 0;
+
+	// Since the previous sample, only filled by MemoryTagSampler
+	double allocations_per_sec = 0.0;
+	double bytes_per_sec = 0.0;
+};
+
+using MemoryTagReport = std::array<MemoryTagStats, memory_tag_count>;
+
+// Peaks are only tracked with the granularity of the thread local counters (a few dozen KB per thread)
+MemoryTagReport memory_tag_stats();
+
+class MemoryTagSampler : NonCopyable {
+	public:
+		const MemoryTagReport& sample();
+		const MemoryTagReport& last_sample() const;
+
+	private:
+		core::Chrono _timer;
+		MemoryTagReport _report = {};
+};
+
+
+// Charges everything to the tag it was created with: the innermost scope if any, DefaultTag otherwise
+template<MemoryTag DefaultTag = MemoryTag::Untagged, typename Allocator = GlobalAllocator>
+class TaggedAllocator : NonCopyable {
+	public:
+		TaggedAllocator() : _tag(tag_or_default()) {
+		}
+
+		TaggedAllocator(Allocator&& a) : _allocator(std::move(a)), _tag(tag_or_default()) {
+		}
+
+		TaggedAllocator(TaggedAllocator&&) = default;
+		TaggedAllocator& operator=(TaggedAllocator&&) = default;
+
+		[[nodiscard]] void* allocate(usize size) noexcept {
+			void* ptr = _allocator.allocate(size);
+			if(ptr) {
+				track_allocation(_tag, size);
+			}
+			return ptr;
+		}
+
+		void deallocate(void* ptr, usize size) noexcept {
+			if(ptr) {
+				track_deallocation(_tag, size);
+			}
+			_allocator.deallocate(ptr, size);
+		}
+
+		MemoryTag tag() const {
+			return _tag;
+		}
+
+	private:
+		static MemoryTag tag_or_default() {
+			const MemoryTag tag = current_memory_tag();
+			return tag == MemoryTag::Untagged ? DefaultTag : tag;
+		}
+
+		Allocator _allocator;
+		MemoryTag _tag;
+};
+
+template<typename T, MemoryTag DefaultTag = MemoryTag::Untagged>
+using TaggedVector = core::Vector<T, core::DefaultVectorResizePolicy, StdAllocatorAdapter<T, TaggedAllocator<DefaultTag>>>;
+
+}
+}
+
+#endif // Y_MEM_MEMORYTAGS_H
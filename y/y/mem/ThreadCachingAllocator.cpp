@@ -0,0 +1,374 @@
+/*******************************
+Copyright (c) 2016-2020 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+
+
+#include "ThreadCachingAllocator.h"
+
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <cstdlib>
+#include <algorithm>
+
+namespace y {
+namespace memory {
+
+namespace {
+
+static constexpr usize size_class_granularity = 16;
+static constexpr usize linear_class_count = 8;
+static constexpr usize size_class_count = linear_class_count + 4 * 8;
+static constexpr usize min_slab_size = 64 * 1024;
+
+static_assert(size_class_granularity % max_alignment == 0);
+
+// 16 to 128 bytes by steps of 16, then 4 classes per power of two
+constexpr usize class_size(usize c) {
+	if(c < linear_class_count) {
+		return (c + 1) * size_class_granularity;
+	}
+	const usize k = c - linear_class_count;
+	const usize l = 7 + k / 4;
+	return (usize(1) << l) + ((k % 4) + 1) * (usize(1) << (l - 2));
+}
+
+static_assert(class_size(linear_class_count - 1) == 128);
+static_assert(class_size(size_class_count - 1) == ThreadCachingAllocator::max_small_size);
+
+// Number of blocks moved between a thread cache and the central pool at once
+constexpr usize class_batch_size(usize c) {
+	return std::clamp(usize(16 * 1024) / class_size(c), usize(4), usize(64));
+}
+
+constexpr usize class_slab_size(usize c) {
+	return std::max(min_slab_size, class_batch_size(c) * class_size(c));
+}
+
+constexpr auto build_class_table() {
+	std::array<u8, ThreadCachingAllocator::max_small_size / size_class_granularity> table = {};
+	usize c = 0;
+	for(usize i = 0; i != table.size(); ++i) {
+		const usize size = (i + 1) * size_class_granularity;
+		while(class_size(c) < size) {
+			++c;
+		}
+		table[i] = u8(c);
+	}
+	return table;
+}
+
+static constexpr auto class_table = build_class_table();
+
+usize size_class(usize size) {
+	y_debug_assert(size <= ThreadCachingAllocator::max_small_size);
+	return class_table[size ? (size - 1) / size_class_granularity : 0];
+}
+
+
+struct Block {
+	Block* next;
+	// Only used by the first block of a batch while it is in the central pool
+	std::atomic<Block*> next_batch;
+};
+
+static_assert(sizeof(Block) <= size_class_granularity);
+
+Block* create_block(void* ptr, Block* next) {
+	return ::new(ptr) Block{next, {nullptr}};
+}
+
+
+// Treiber stack of batches, the top 16 bits of the head are an ABA tag.
+// Blocks are never released to the system so reading next_batch of a stale head is always safe.
+class CentralList : NonMovable {
+	static_assert(sizeof(void*) == sizeof(u64));
+
+	static constexpr u64 pointer_mask = (u64(1) << 48) - 1;
+	static constexpr u64 tag_increment = u64(1) << 48;
+
+	public:
+		void push(Block* batch) {
+			y_debug_assert((reinterpret_cast<u64>(batch) & ~pointer_mask) == 0);
+			u64 head = _head.load(std::memory_order_relaxed);
+			u64 new_head = 0;
+			do {
+				batch->next_batch.store(to_block(head), std::memory_order_relaxed);
+				new_head = reinterpret_cast<u64>(batch) | ((head & ~pointer_mask) + tag_increment);
+			} while(!_head.compare_exchange_weak(head, new_head, std::memory_order_release, std::memory_order_relaxed));
+		}
+
+		Block* pop() {
+			u64 head = _head.load(std::memory_order_acquire);
+			while(Block* batch = to_block(head)) {
+				const u64 new_head = reinterpret_cast<u64>(batch->next_batch.load(std::memory_order_relaxed)) | ((head & ~pointer_mask) + tag_increment);
+				if(_head.compare_exchange_weak(head, new_head, std::memory_order_acquire, std::memory_order_acquire)) {
+					return batch;
+				}
+			}
+			return nullptr;
+		}
+
+	private:
+		static Block* to_block(u64 head) {
+			return reinterpret_cast<Block*>(head & pointer_mask);
+		}
+
+		alignas(64) std::atomic<u64> _head = 0;
+};
+
+
+struct ThreadCache;
+
+struct Heap : NonMovable {
+	std::array<CentralList, size_class_count> central;
+
+	std::atomic<usize> reserved_bytes = 0;
+
+	// Counters of exited threads, and of threads that free memory after their cache was destroyed
+	std::atomic<i64> retired_bytes = 0;
+	std::atomic<i64> retired_allocations = 0;
+
+	// Only locked when threads start or exit, and to read stats
+	std::mutex caches_lock;
+	ThreadCache* caches = nullptr;
+};
+
+// Never destroyed: other static objects might still free memory during shutdown
+Heap& heap() {
+	static Heap* heap = new Heap();
+	return *heap;
+}
+
+// Carves a new slab, returns one batch and gives the others to the central pool
+Block* allocate_slab(usize c) {
+	const usize block_size = class_size(c);
+	const usize slab_size = class_slab_size(c);
+	const usize batch_size = class_batch_size(c);
+
+	u8* slab = static_cast<u8*>(std::malloc(slab_size));
+	if(!slab) {
+		return nullptr;
+	}
+
+	Heap& h = heap();
+	h.reserved_bytes.fetch_add(slab_size, std::memory_order_relaxed);
+
+	const usize block_count = slab_size / block_size;
+	Block* first_batch = nullptr;
+	for(usize begin = 0; begin < block_count; begin += batch_size) {
+		const usize end = std::min(begin + batch_size, block_count);
+		Block* next = nullptr;
+		for(usize i = end; i != begin; --i) {
+			next = create_block(slab + (i - 1) * block_size, next);
+		}
+		if(first_batch) {
+			h.central[c].push(next);
+		} else {
+			first_batch = next;
+		}
+	}
+	return first_batch;
+}
+
+Block* acquire_batch(usize c) {
+	if(Block* batch = heap().central[c].pop()) {
+		return batch;
+	}
+	return allocate_slab(c);
+}
+
+
+struct FreeList {
+	Block* head = nullptr;
+	// Upper bound, batches from the central pool may be partial
+	usize count = 0;
+};
+
+thread_local bool thread_cache_destroyed = false;
+
+struct ThreadCache : NonMovable {
+	std::array<FreeList, size_class_count> lists;
+
+	// Only written by the owning thread, atomics so that stats can read them
+	std::atomic<i64> live_bytes = 0;
+	std::atomic<i64> live_allocations = 0;
+
+	ThreadCache* prev = nullptr;
+	ThreadCache* next = nullptr;
+
+	ThreadCache() {
+		Heap& h = heap();
+		const std::unique_lock lock(h.caches_lock);
+		next = h.caches;
+		if(next) {
+			next->prev = this;
+		}
+		h.caches = this;
+	}
+
+	~ThreadCache() {
+		for(usize c = 0; c != size_class_count; ++c) {
+			while(lists[c].head) {
+				flush_batch(c);
+			}
+		}
+
+		Heap& h = heap();
+		h.retired_bytes.fetch_add(live_bytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+		h.retired_allocations.fetch_add(live_allocations.load(std::memory_order_relaxed), std::memory_order_relaxed);
+
+		{
+			const std::unique_lock lock(h.caches_lock);
+			(prev ? prev->next : h.caches) = next;
+			if(next) {
+				next->prev = prev;
+			}
+		}
+
+		thread_cache_destroyed = true;
+	}
+
+	void count(i64 bytes, i64 allocations) {
+		live_bytes.store(live_bytes.load(std::memory_order_relaxed) + bytes, std::memory_order_relaxed);
+		live_allocations.store(live_allocations.load(std::memory_order_relaxed) + allocations, std::memory_order_relaxed);
+	}
+
+	void* pop(usize c) {
+		FreeList& list = lists[c];
+		if(!list.head) {
+			list.head = acquire_batch(c);
+			list.count = class_batch_size(c);
+			if(!list.head) {
+				list.count = 0;
+				return nullptr;
+			}
+		}
+
+		Block* block = list.head;
+		list.head = block->next;
+		list.count = list.head ? list.count - 1 : 0;
+		return block;
+	}
+
+	void push(usize c, void* ptr) {
+		FreeList& list = lists[c];
+		list.head = create_block(ptr, list.head);
+		if(++list.count >= 2 * class_batch_size(c)) {
+			flush_batch(c);
+		}
+	}
+
+	void flush_batch(usize c) {
+		FreeList& list = lists[c];
+		Block* batch = list.head;
+		Block* last = batch;
+		usize size = 1;
+		for(const usize batch_size = class_batch_size(c); size != batch_size && last->next; ++size) {
+			last = last->next;
+		}
+
+		list.head = last->next;
+		list.count = list.head ? list.count - std::min(size, list.count) : 0;
+
+		last->next = nullptr;
+		heap().central[c].push(batch);
+	}
+};
+
+thread_local ThreadCache thread_cache;
+
+void count(i64 bytes, i64 allocations) {
+	if(!thread_cache_destroyed) {
+		thread_cache.count(bytes, allocations);
+	} else {
+		Heap& h = heap();
+		h.retired_bytes.fetch_add(bytes, std::memory_order_relaxed);
+		h.retired_allocations.fetch_add(allocations, std::memory_order_relaxed);
+	}
+}
+
+}
+
+
+ThreadCachingAllocator::Stats ThreadCachingAllocator::stats() {
+	Heap& h = heap();
+
+	i64 bytes = h.retired_bytes.load(std::memory_order_relaxed);
+	i64 allocations = h.retired_allocations.load(std::memory_order_relaxed);
+	{
+		const std::unique_lock lock(h.caches_lock);
+		for(const ThreadCache* cache = h.caches; cache; cache = cache->next) {
+			bytes += cache->live_bytes.load(std::memory_order_relaxed);
+			allocations += cache->live_allocations.load(std::memory_order_relaxed);
+		}
+	}
+
+	Stats stats;
+	stats.live_bytes = usize(std::max(bytes, i64(0)));
+	stats.live_allocations = usize(std::max(allocations, i64(0)));
+	stats.reserved_bytes = h.reserved_bytes.load(std::memory_order_relaxed);
+	return stats;
+}
+
+[[nodiscard]] void* ThreadCachingAllocator::allocate(usize size) noexcept {
+	void* ptr = nullptr;
+	if(size > max_small_size) {
+		ptr = std::malloc(align_up_to_max(size));
+	} else {
+		const usize c = size_class(size);
+		if(!thread_cache_destroyed) {
+			ptr = thread_cache.pop(c);
+		} else if(Block* batch = acquire_batch(c)) {
+			if(batch->next) {
+				heap().central[c].push(batch->next);
+			}
+			ptr = batch;
+		}
+	}
+
+	if(ptr) {
+		count(i64(size), 1);
+	}
+	return ptr;
+}
+
+void ThreadCachingAllocator::deallocate(void* ptr, usize size) noexcept {
+	if(!ptr) {
+		return;
+	}
+
+	count(-i64(size), -1);
+
+	if(size > max_small_size) {
+		std::free(ptr);
+	} else {
+		const usize c = size_class(size);
+		if(!thread_cache_destroyed) {
+			thread_cache.push(c, ptr);
+		} else {
+			heap().central[c].push(create_block(ptr, nullptr));
+		}
+	}
+}
+
+}
+}
@@ -0,0 +1,55 @@
+/*******************************
+Copyright (c) 2016-2020 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+
+#ifndef Y_MEM_THREADCACHINGALLOCATOR_H
+#define Y_MEM_THREADCACHINGALLOCATOR_H
+
+#include "memory.h"
+
+namespace y {
+namespace memory {
+
+// Small allocations are served from size class slabs through per-thread caches.
+// Caches exchange blocks with a lock-free central pool in batches so threads almost never synchronize.
+// Slabs are never returned to the system, the memory is recycled through the central pool instead.
+// All instances share the same process wide heap.
+class ThreadCachingAllocator : NonCopyable {
+	public:
+		static constexpr usize max_small_size = 32 * 1024;
+
+		struct Stats {
+			usize live_bytes = 0;
+			usize live_allocations = 0;
+			usize reserved_bytes = 0;
+		};
+
+		// Sums the per-thread counters, values are only exact when no other thread is allocating
+		static Stats stats();
+
+		[[nodiscard]] void* allocate(usize size) noexcept;
+		void deallocate(void* ptr, usize size) noexcept;
+};
+
+}
+}
+
+#endif // Y_MEM_THREADCACHINGALLOCATOR_H
@@ -22,6 +22,7 @@ SOFTWARE.
 
 #include "memory.h"
 #include "allocators.h"
+#include "ThreadCachingAllocator.h"
 
 #include <y/utils/log.h>
 #include <y/utils/format.h>
@@ -42,7 +43,18 @@ struct PrintingAllocator : private Allocator {
 	}
 };
 
-using GlobalAllocatorType = ThreadSafeAllocator<LeakDetectorAllocator<Mallocator>>;
+// The shared heap outlives every allocator instance, so leaks are checked on its process wide stats
+struct LeakReportingAllocator : ThreadCachingAllocator {
+	~LeakReportingAllocator() {
+		const Stats stats = ThreadCachingAllocator::stats();
+		if(stats.live_allocations) {
+			log_msg(fmt("Memory was not freed before exit (% bytes leaked in % allocations).", stats.live_bytes, stats.live_allocations), Log::Error);
+		}
+	}
+};
+
+using GlobalAllocatorType = LeakReportingAllocator;
+using ThreadLocalAllocatorType = ThreadCachingAllocator;
 
 PolymorphicAllocatorBase* global_allocator() {
 	static PolymorphicAllocator<GlobalAllocatorType> allocator;
@@ -50,7 +62,7 @@ PolymorphicAllocatorBase* global_allocator() {
 }
 
 PolymorphicAllocatorBase* thread_local_allocator() {
-	static thread_local PolymorphicAllocator<GlobalAllocatorType> allocator;
+	static thread_local PolymorphicAllocator<ThreadLocalAllocatorType> allocator;
 	return &allocator;
 }
 
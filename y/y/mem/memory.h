@@ -73,6 +73,9 @@ class StdAllocatorAdapter : NonCopyable {
 		using value_type = T;
 		using size_type = usize;
 
+		// Containers must keep freeing through the allocator that allocated their storage
+		using propagate_on_container_move_assignment = std::true_type;
+
 		StdAllocatorAdapter() = default;
 
 		StdAllocatorAdapter(Allocator&& a) : _allocator(std::move(a)) {
@@ -26,6 +26,9 @@ SOFTWARE.
 
 #include <y/core/Range.h>
 #include <y/core/Vector.h>
+#include <y/core/String.h>
+#include <y/core/Name.h>
+#include <y/mem/MemoryTags.h>
 
 #include "headers.h"
 #include "conversions.h"
@@ -138,16 +141,21 @@ struct IsArray<std::array<T, N>> {
 };
 
 
+// Names are pointers into the name table, they can never be written as raw bytes
+template<typename T>
+static constexpr bool is_name_base_v = std::is_same_v<remove_cvref_t<T>, core::Name>;
+
 template<typename T, typename value_type = remove_cvref_t<typename T::value_type>>
 constexpr bool use_collection_fast_path =
 		(has_resize_v<T> || has_emplace_back_v<T>) &&
 		std::is_pointer_v<decltype(std::declval<T>().begin())> &&
 		std::is_trivially_copyable_v<value_type> &&
 		!has_serde3_v<value_type> &&
+		!is_name_base_v<value_type> &&
 		!std::is_pointer_v<value_type>;
 
 template<typename T>
-static constexpr bool is_pod_base_v = std::is_trivially_copyable_v<remove_cvref_t<T>> && std::is_trivially_copy_constructible_v<remove_cvref_t<T>>;
+static constexpr bool is_pod_base_v = std::is_trivially_copyable_v<remove_cvref_t<T>> && std::is_trivially_copy_constructible_v<remove_cvref_t<T>> && !is_name_base_v<T>;
 
 template<typename T>
 constexpr bool is_pod_iterable() {
@@ -166,6 +174,10 @@ static constexpr bool is_property_v = detail::IsProperty<remove_cvref_t<T>>::val
 template<typename T>
 static constexpr bool is_range_v = detail::IsRange<remove_cvref_t<T>>::value;
 
+// Names are written as strings, they can be read back as core::String and vice versa
+template<typename T>
+static constexpr bool is_name_v = detail::is_name_base_v<T>;
+
 template<typename T>
 static constexpr bool is_tuple_v = detail::IsTuple<remove_cvref_t<T>>::value;
 
@@ -281,6 +293,8 @@ class WritableArchive final {
 
 			if constexpr(is_property_v<T>) {
 				return serialize_property(object);
+			} else if constexpr(is_name_v<T>) {
+				return serialize_name(object);
 			} else {
 				const auto header = detail::build_header(object);
 				y_try(write_one(header));
@@ -312,6 +326,14 @@ class WritableArchive final {
 		}
 
 
+		// ------------------------------- NAME -------------------------------
+		template<typename T, bool R>
+		Result serialize_name(NamedObject<T, R> object) {
+			const core::String str = object.object.view();
+			return serialize_one(NamedObject<const core::String>(str, object.name));
+		}
+
+
 		// ------------------------------- PTR -------------------------------
 		template<typename T>
 		Result serialize_ptr(NamedObject<T> object) {
@@ -532,7 +554,7 @@ class WritableArchive final {
 		io2::Buffer _buffer;
 #endif
 		usize _cached_file_size = 0;
-		core::Vector<SizePatch> _patches;
+		memory::TaggedVector<SizePatch, memory::MemoryTag::Serde> _patches;
 
 		std::unique_ptr<File> _storage;
 };
@@ -558,7 +580,7 @@ class ReadableArchive final {
 	};
 
 	struct ObjectData {
-		core::Vector<HeaderOffset> members;
+		memory::TaggedVector<HeaderOffset, memory::MemoryTag::Serde> members;
 		usize end_offset = 0;
 	};
 
@@ -594,6 +616,8 @@ class ReadableArchive final {
 
 			if constexpr(is_property_v<T>) {
 				return deserialize_property(object);
+			} else if constexpr(is_name_v<T>) {
+				return deserialize_name(object);
 			} else {
 				detail::FullHeader header;
 				size_type size = size_type(-1);
@@ -640,6 +664,19 @@ class ReadableArchive final {
 
 
 
+		// ------------------------------- NAME -------------------------------
+		template<typename T, bool R>
+		Result deserialize_name(NamedObject<T, R> object) {
+			core::String str;
+			auto result = deserialize_one(NamedObject<core::String>(str, object.name));
+			if(result.is_ok()) {
+				object.object = core::Name(str);
+			}
+			return result;
+		}
+
+
+
 		// ------------------------------- PTR -------------------------------
 		template<typename T>
 		Result deserialize_ptr(NamedObject<T> object, const detail::FullHeader& header, size_type size) {
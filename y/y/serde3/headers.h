@@ -25,6 +25,8 @@ SOFTWARE.
 #include <y/utils/name.h>
 #include <y/utils/hash.h>
 
+#include <y/core/Name.h>
+
 #include "serde.h"
 #include "poly.h"
 
@@ -54,6 +56,25 @@ template<typename T>
 using deconst_t = typename detail::Deconst<remove_cvref_t<T>>::type;
 
 
+namespace detail {
+// Types that are written as another type share its header
+template<typename T>
+struct HeaderType {
+	using type = T;
+};
+
+template<>
+struct HeaderType<core::Name> {
+	using type = core::String;
+};
+
+template<template<typename...> typename C, typename... Args>
+struct HeaderType<C<Args...>> {
+	using type = C<typename HeaderType<Args>::type...>;
+};
+}
+
+
 namespace detail {
 
 struct TypeHeader {
@@ -158,7 +179,7 @@ constexpr u32 ct_str_hash(std::string_view str) {
 
 template<typename T>
 constexpr u32 header_type_hash() {
-	using naked = deconst_t<T>;
+	using naked = typename detail::HeaderType<deconst_t<T>>::type;
 	u32 hash = ct_str_hash(ct_type_name<naked>());
 	if constexpr(has_serde3_v<T>) {
 		hash |= 0x01;
@@ -26,6 +26,7 @@ SOFTWARE.
 
 #include <algorithm>
 #include <memory>
+#include <charconv>
 
 namespace y {
 namespace detail {
@@ -58,12 +59,16 @@ FmtBuffer::FmtBuffer(core::String& str) {
 	_start = _buffer = str.data() + size;
 }
 
+FmtBuffer::FmtBuffer(char* buffer, usize size) : _buffer(buffer), _buffer_size(size - 1), _start(buffer), _external(true) {
+	y_debug_assert(size);
+}
+
 std::string_view FmtBuffer::done() && {
 	y_debug_assert(!fmt_buffer || fmt_buffer[fmt_total_buffer_size] == 0);
 	*_buffer = 0;
 	if(_dynamic) {
 		_dynamic->shrink(_buffer - _dynamic->begin());
-	} else {
+	} else if(!_external) {
 		y_debug_assert(_buffer <= fmt_buffer.get() + fmt_total_buffer_size);
 		fmt_buffer_end = (_buffer == fmt_buffer.get() + fmt_total_buffer_size) ? fmt_buffer.get() : _buffer + 1;
 	}
@@ -72,6 +77,10 @@ std::string_view FmtBuffer::done() && {
 
 
 bool FmtBuffer::try_expand() {
+	if(_external) {
+		return false;
+	}
+
 	if(_dynamic) {
 		const char* begin = _dynamic->begin();
 		const usize start_offset = _start - begin;
@@ -115,23 +124,68 @@ void FmtBuffer::advance(usize r) {
 	const usize l = std::min(_buffer_size, r);
 	_buffer += l;
 	_buffer_size -= l;
-	y_debug_assert(_dynamic || _buffer <= fmt_buffer.get() + fmt_total_buffer_size);
-	y_debug_assert(_dynamic || _buffer + _buffer_size <= fmt_buffer.get() + fmt_total_buffer_size);
-}
-
-#define y_buff_fmt_(str, t)															\
-	do {																			\
-		auto _fmt_l = std::snprintf(_buffer, _buffer_size + 1, str, t);				\
-		if(_fmt_l < 0 || _buffer_size < usize(_fmt_l)) {							\
-			if(!try_expand()) {														\
-				advance(_fmt_l < 0 ? 0 : _fmt_l);									\
-				break;																\
-			}																		\
-		} else {																	\
-			advance(_fmt_l);														\
-			break;																	\
-		}																			\
-	} while(true)
+	y_debug_assert(_dynamic || _external || _buffer <= fmt_buffer.get() + fmt_total_buffer_size);
+	y_debug_assert(_dynamic || _external || _buffer + _buffer_size <= fmt_buffer.get() + fmt_total_buffer_size);
+}
+
+
+// Large enough for any integer, pointer or shortest round trip double
+static constexpr usize number_buffer_size = 32;
+
+static constexpr char digit_pairs[] =
+	"00010203040506070809"
+	"10111213141516171819"
+	"20212223242526272829"
+	"30313233343536373839"
+	"40414243444546474849"
+	"50515253545556575859"
+	"60616263646566676869"
+	"70717273747576777879"
+	"80818283848586878889"
+	"90919293949596979899";
+
+// Writes the digits backward from end, returns the first char
+static char* format_unsigned(char* end, u64 value) {
+	while(value >= 100) {
+		const usize pair = usize(value % 100) * 2;
+		value /= 100;
+		*--end = digit_pairs[pair + 1];
+		*--end = digit_pairs[pair];
+	}
+	if(value >= 10) {
+		const usize pair = usize(value) * 2;
+		*--end = digit_pairs[pair + 1];
+		*--end = digit_pairs[pair];
+	} else {
+		*--end = char('0' + value);
+	}
+	return end;
+}
+
+template<typename T>
+static void fmt_integer(FmtBuffer& buffer, T value) {
+	char digits[number_buffer_size];
+	char* end = digits + number_buffer_size;
+	char* begin = nullptr;
+	if constexpr(std::is_signed_v<T>) {
+		const u64 magnitude = value < 0 ? u64(0) - u64(value) : u64(value);
+		begin = format_unsigned(end, magnitude);
+		if(value < 0) {
+			*--begin = '-';
+		}
+	} else {
+		begin = format_unsigned(end, u64(value));
+	}
+	buffer.copy(begin, end - begin);
+}
+
+template<typename T>
+static void fmt_float(FmtBuffer& buffer, T value) {
+	char digits[number_buffer_size];
+	const auto result = std::to_chars(digits, digits + number_buffer_size, value);
+	y_debug_assert(result.ec == std::errc());
+	buffer.copy(digits, result.ptr - digits);
+}
 
 void FmtBuffer::copy(const char* str, usize len) {
 	if(!len) {
@@ -178,43 +232,43 @@ void FmtBuffer::fmt_one(unsigned char i) {
 }
 
 void FmtBuffer::fmt_one(const void* p) {
-	y_buff_fmt_("%p", p);
+	char digits[number_buffer_size] = {'0', 'x'};
+	const auto result = std::to_chars(digits + 2, digits + number_buffer_size, reinterpret_cast<uintptr_t>(p), 16);
+	copy(digits, result.ptr - digits);
 }
 
 void FmtBuffer::fmt_one(int i) {
-	y_buff_fmt_("%d", i);
+	fmt_integer(*this, i);
 }
 
 void FmtBuffer::fmt_one(long int i) {
-	y_buff_fmt_("%ld", i);
+	fmt_integer(*this, i);
 }
 
 void FmtBuffer::fmt_one(long long int i) {
-	y_buff_fmt_("%lld", i);
+	fmt_integer(*this, i);
 }
 
 void FmtBuffer::fmt_one(unsigned i) {
-	y_buff_fmt_("%u", i);
+	fmt_integer(*this, i);
 }
 
 void FmtBuffer::fmt_one(long unsigned i) {
-	y_buff_fmt_("%lu", i);
+	fmt_integer(*this, i);
 }
 
 void FmtBuffer::fmt_one(long long unsigned i) {
-	y_buff_fmt_("%llu", i);
+	fmt_integer(*this, i);
 }
 
 void FmtBuffer::fmt_one(float i) {
-	y_buff_fmt_("%f", i);
+	fmt_float(*this, i);
 }
 
 void FmtBuffer::fmt_one(double i) {
-	y_buff_fmt_("%lf", i);
+	fmt_float(*this, i);
 }
 
-#undef y_buff_fmt_
-
 }
 
 }
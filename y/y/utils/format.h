@@ -39,12 +39,71 @@ namespace core {
 class String;
 }
 
+// Format string with its placeholder offsets, they are computed by a constexpr constructor
+// so the scan can be done at compile time for literals (always when the FmtString is constexpr)
+class FmtString {
+	public:
+		static constexpr usize max_placeholders = 15;
+		static constexpr usize npos = usize(-1);
+
+		template<typename T>
+		constexpr FmtString(const T& str) {
+			if constexpr(std::is_array_v<T>) {
+				init(str, std::extent_v<T>);
+			} else {
+				init(str, npos);
+			}
+		}
+
+		constexpr const char* data() const {
+			return _str;
+		}
+
+		constexpr usize size() const {
+			return _size;
+		}
+
+		// Offset of the index-th placeholder, previous ones end before from
+		usize placeholder(usize index, usize from) const {
+			if(index < _count) {
+				return _offsets[index];
+			}
+			if(_count == max_placeholders && from < _size) {
+				if(const void* p = std::memchr(_str + from, '%', _size - from)) {
+					return usize(static_cast<const char*>(p) - _str);
+				}
+			}
+			return npos;
+		}
+
+	private:
+		constexpr void init(const char* str, usize max_size) {
+			_str = str;
+			if(!str) {
+				_str = "";
+				return;
+			}
+			for(; _size != max_size && str[_size]; ++_size) {
+				if(str[_size] == '%' && _count != max_placeholders) {
+					_offsets[_count++] = u32(_size);
+				}
+			}
+		}
+
+		const char* _str = nullptr;
+		usize _size = 0;
+		usize _count = 0;
+		u32 _offsets[max_placeholders] = {};
+};
+
+
 namespace detail {
 
 class FmtBuffer {
 	public:
 		FmtBuffer();
 		FmtBuffer(core::String& str);
+		FmtBuffer(char* buffer, usize size);
 
 		void copy(const char* str, usize len);
 
@@ -113,67 +172,80 @@ class FmtBuffer {
 		usize _buffer_size = 0;
 		char* _start = nullptr;
 		core::String* _dynamic = nullptr;
+		bool _external = false;
 };
 
 
-template<typename T, typename... Args>
-void fmt_rec(FmtBuffer& buffer, const char* fmt, T&& t, Args&&... args) {
-	const char* c = std::strchr(fmt, '%');
-	if(!c) {
-		buffer.fmt_one(fmt);
-	} else {
-		buffer.copy(fmt, c - fmt);
-		++c;
-
-		using naked_type = std::remove_reference_t<T>;
-		if constexpr(std::is_enum_v<naked_type>) {
-			buffer.fmt_one(std::underlying_type_t<naked_type>(t));
-		} else {
-			buffer.fmt_one(y_fwd(t));
-		}
+template<typename T>
+void fmt_arg(FmtBuffer& buffer, const FmtString& fmt_str, usize& index, usize& pos, T&& t) {
+	const usize offset = fmt_str.placeholder(index++, pos);
+	if(offset == FmtString::npos) {
+		return;
+	}
 
-		if constexpr(sizeof...(args)) {
-			fmt_rec(buffer, c, y_fwd(args)...);
-		} else {
-			buffer.fmt_one(c);
-		}
+	buffer.copy(fmt_str.data() + pos, offset - pos);
+	pos = offset + 1;
+
+	using naked_type = std::remove_reference_t<T>;
+	if constexpr(std::is_enum_v<naked_type>) {
+		buffer.fmt_one(std::underlying_type_t<naked_type>(t));
+	} else {
+		buffer.fmt_one(y_fwd(t));
 	}
 }
 
+// Extra arguments are ignored, extra placeholders are left as is
+template<typename... Args>
+void fmt_args(FmtBuffer& buffer, const FmtString& fmt_str, Args&&... args) {
+	usize index = 0;
+	usize pos = 0;
+	(fmt_arg(buffer, fmt_str, index, pos, y_fwd(args)), ...);
+	buffer.copy(fmt_str.data() + pos, fmt_str.size() - pos);
+}
+
 }
 
 static constexpr usize fmt_max_size = 1023;
 
 template<typename... Args>
-std::string_view fmt(const char* fmt_str, Args&&... args) {
+std::string_view fmt(const FmtString& fmt_str, Args&&... args) {
 #ifdef y_profile_zone
 	y_profile_zone("fmt");
 #endif
 	if constexpr(sizeof...(args)) {
 		detail::FmtBuffer buffer;
-		detail::fmt_rec(buffer, fmt_str, y_fwd(args)...);
+		detail::fmt_args(buffer, fmt_str, y_fwd(args)...);
 		return std::move(buffer).done();
 	}
 
-	return fmt_str;
+	return std::string_view(fmt_str.data(), fmt_str.size());
 }
 
 template<typename... Args>
-std::string_view fmt_into(core::String& out, const char* fmt_str, Args&&... args) {
+std::string_view fmt_into(core::String& out, const FmtString& fmt_str, Args&&... args) {
 #ifdef y_profile_zone
 	y_profile_zone("fmt_into");
 #endif
 	detail::FmtBuffer buffer(out);
-	if constexpr(sizeof...(args)) {
-		detail::fmt_rec(buffer, fmt_str, y_fwd(args)...);
-	} else {
-		buffer.fmt_one(fmt_str);
-	}
+	detail::fmt_args(buffer, fmt_str, y_fwd(args)...);
+	return std::move(buffer).done();
+}
+
+// Formats into a caller provided buffer without allocating, the result is truncated to size - 1 chars and null terminated
+template<typename... Args>
+std::string_view fmt_to(char* out, usize size, const FmtString& fmt_str, Args&&... args) {
+	detail::FmtBuffer buffer(out, size);
+	detail::fmt_args(buffer, fmt_str, y_fwd(args)...);
 	return std::move(buffer).done();
 }
 
+template<usize N, typename... Args>
+std::string_view fmt_to(char (&out)[N], const FmtString& fmt_str, Args&&... args) {
+	return fmt_to(out, N, fmt_str, y_fwd(args)...);
+}
+
 template<typename... Args>
-const char* fmt_c_str(const char* fmt_str, Args&&... args) {
+const char* fmt_c_str(const FmtString& fmt_str, Args&&... args) {
 	return fmt(fmt_str, y_fwd(args)...).data();
 }
 
@@ -28,6 +28,13 @@ SOFTWARE.
 #include "name.h"
 
 #include <functional>
+#include <iterator>
+#include <algorithm>
+#include <cstring>
+
+#ifdef Y_MSVC
+#include <intrin.h>
+#endif
 
 namespace y {
 
@@ -57,18 +64,184 @@ constexpr u64 type_hash_2() {
 }
 
 
+
+// wyhash (final 4), see https://github.com/wangyi-fudan/wyhash
+namespace detail {
+static constexpr u64 wyhash_secret[4] = {0x2d358dccaa6c78a5, 0x8bb84b93962eacc9, 0x4b33a62ed433d4a3, 0x4d5a2da51de1aa47};
+static constexpr usize wyhash_stripe_size = 48;
+
+inline void wyhash_mum(u64& a, u64& b) {
+#if defined(__SIZEOF_INT128__)
+	__extension__ using u128 = unsigned __int128;
+	const u128 r = u128(a) * b;
+	a = u64(r);
+	b = u64(r >> 64);
+#elif defined(Y_MSVC) && defined(_M_X64)
+	a = _umul128(a, b, &b);
+#else
+	const u64 ha = a >> 32, hb = b >> 32, la = u32(a), lb = u32(b);
+	const u64 rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+	const u64 t = rl + (rm0 << 32);
+	u64 c = t < rl;
+	const u64 lo = t + (rm1 << 32);
+	c += lo < t;
+	a = lo;
+	b = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+#endif
+}
+
+inline u64 wyhash_mix(u64 a, u64 b) {
+	wyhash_mum(a, b);
+	return a ^ b;
+}
+
+inline u64 wyhash_read8(const u8* p) {
+	u64 v;
+	std::memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+inline u64 wyhash_read4(const u8* p) {
+	u32 v;
+	std::memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+inline u64 wyhash_seed(u64 seed) {
+	return seed ^ wyhash_mix(seed ^ wyhash_secret[0], wyhash_secret[1]);
+}
+
+inline void wyhash_stripe(const u8* p, u64& seed, u64& see1, u64& see2) {
+	seed = wyhash_mix(wyhash_read8(p) ^ wyhash_secret[1], wyhash_read8(p + 8) ^ seed);
+	see1 = wyhash_mix(wyhash_read8(p + 16) ^ wyhash_secret[2], wyhash_read8(p + 24) ^ see1);
+	see2 = wyhash_mix(wyhash_read8(p + 32) ^ wyhash_secret[3], wyhash_read8(p + 40) ^ see2);
+}
+
+// Hashes the last 1 to 48 bytes of an input longer than 16 bytes, p[-16, 0) must be readable
+inline u64 wyhash_tail(const u8* p, usize size, u64 seed, usize total) {
+	for(; size > 16; size -= 16, p += 16) {
+		seed = wyhash_mix(wyhash_read8(p) ^ wyhash_secret[1], wyhash_read8(p + 8) ^ seed);
+	}
+	u64 a = wyhash_read8(p + size - 16) ^ wyhash_secret[1];
+	u64 b = wyhash_read8(p + size - 8) ^ seed;
+	wyhash_mum(a, b);
+	return wyhash_mix(a ^ wyhash_secret[0] ^ total, b ^ wyhash_secret[1]);
+}
+
+// seed must already have gone through wyhash_seed
+inline u64 hash_bytes_seeded(const void* data, usize size, u64 seed) {
+	const u8* p = static_cast<const u8*>(data);
+
+	if(size <= 16) {
+		u64 a = 0;
+		u64 b = 0;
+		if(size >= 4) {
+			const usize mid = (size >> 3) << 2;
+			a = (detail::wyhash_read4(p) << 32) | detail::wyhash_read4(p + mid);
+			b = (detail::wyhash_read4(p + size - 4) << 32) | detail::wyhash_read4(p + size - 4 - mid);
+		} else if(size) {
+			a = (u64(p[0]) << 16) | (u64(p[size >> 1]) << 8) | p[size - 1];
+		}
+		a ^= detail::wyhash_secret[1];
+		b ^= seed;
+		detail::wyhash_mum(a, b);
+		return detail::wyhash_mix(a ^ detail::wyhash_secret[0] ^ size, b ^ detail::wyhash_secret[1]);
+	}
+
+	usize left = size;
+	if(left > detail::wyhash_stripe_size) {
+		u64 see1 = seed;
+		u64 see2 = seed;
+		do {
+			detail::wyhash_stripe(p, seed, see1, see2);
+			p += detail::wyhash_stripe_size;
+			left -= detail::wyhash_stripe_size;
+		} while(left > detail::wyhash_stripe_size);
+		seed ^= see1 ^ see2;
+	}
+
+	return detail::wyhash_tail(p, left, seed, size);
+}
+}
+
+inline u64 hash_bytes(const void* data, usize size, u64 seed = 0) {
+	return detail::hash_bytes_seeded(data, size, detail::wyhash_seed(seed));
+}
+
+
+// Streaming version of hash_bytes: feeding the same bytes in any number of pieces gives the same hash
+class BytesHasher {
+	public:
+		BytesHasher(u64 seed = 0) : _seed(detail::wyhash_seed(seed)), _see1(_seed), _see2(_seed) {
+		}
+
+		void add(const void* data, usize size) {
+			const u8* p = static_cast<const u8*>(data);
+			while(size) {
+				// Stripes are only hashed once we know they are not the last bytes
+				if(_buffered == detail::wyhash_stripe_size) {
+					detail::wyhash_stripe(_buffer + 16, _seed, _see1, _see2);
+					std::memcpy(_buffer, _buffer + detail::wyhash_stripe_size, 16);
+					_buffered = 0;
+				}
+
+				const usize len = std::min(size, detail::wyhash_stripe_size - _buffered);
+				std::memcpy(_buffer + 16 + _buffered, p, len);
+				_buffered += len;
+				_size += len;
+				p += len;
+				size -= len;
+			}
+		}
+
+		template<typename T>
+		void add(const T& t) {
+			static_assert(std::has_unique_object_representations_v<T>);
+			add(&t, sizeof(T));
+		}
+
+		u64 hash() const {
+			if(_size <= detail::wyhash_stripe_size) {
+				// No stripe has been hashed yet, _seed is still the initial seed
+				return detail::hash_bytes_seeded(_buffer + 16, _size, _seed);
+			}
+			return detail::wyhash_tail(_buffer + 16, _buffered, _seed ^ _see1 ^ _see2, _size);
+		}
+
+	private:
+		u64 _seed = 0;
+		u64 _see1 = 0;
+		u64 _see2 = 0;
+		usize _size = 0;
+		usize _buffered = 0;
+
+		// The first 16 bytes hold the end of the previous stripe, the tail can read them
+		u8 _buffer[16 + detail::wyhash_stripe_size] = {};
+};
+
+
 template<typename T>
 inline auto hash(const T& t) {
 	return std::hash<T>()(t);
 }
 
+namespace detail {
+// Hashing the bytes is only valid if equal values always have the same bytes (no padding, no floats)
+template<typename T>
+static constexpr bool is_byte_hashable_v = std::has_unique_object_representations_v<T>;
+}
+
 template<typename B, typename E>
 inline auto hash_range(B begin, const E& end) {
-	decltype(hash(*begin)) h = 0;
-	for(; begin != end; ++begin) {
-		hash_combine(h, hash(*begin));
+	if constexpr(std::is_pointer_v<B> && std::is_same_v<B, E> && detail::is_byte_hashable_v<std::remove_cv_t<std::remove_pointer_t<B>>>) {
+		return usize(hash_bytes(begin, usize(end - begin) * sizeof(*begin)));
+	} else {
+		decltype(hash(*begin)) h = 0;
+		for(; begin != end; ++begin) {
+			hash_combine(h, hash(*begin));
+		}
+		return h;
 	}
-	return h;
 }
 
 template<typename C>
@@ -22,7 +22,17 @@ SOFTWARE.
 #include "log.h"
 #include <y/utils.h>
 
+#include <y/core/Vector.h>
+#include <y/utils/format.h>
+#include <y/concurrent/concurrent.h>
+
 #include <mutex>
+#include <atomic>
+#include <thread>
+#include <condition_variable>
+#include <memory>
+#include <chrono>
+#include <cstring>
 
 #include <iostream>
 #include <array>
@@ -56,7 +66,13 @@ static void* callback_user_data = nullptr;
 
 static std::mutex lock;
 
-void log_msg(std::string_view msg, Log type) {
+thread_local u64 delivered_time = 0;
+
+static u64 now_ns() {
+	return u64(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+static void deliver(std::string_view msg, Log type, u64 time) {
 	// https://en.wikipedia.org/wiki/ANSI_escape_code
 	static constexpr std::array<const char*, 5> log_type_str = {{
 		"[info] ",
@@ -70,6 +86,7 @@ void log_msg(std::string_view msg, Log type) {
 
 	detail::setup_console();
 
+	delivered_time = time;
 	if(callback && callback(msg, type, callback_user_data)) {
 		return;
 	}
@@ -77,10 +94,430 @@ void log_msg(std::string_view msg, Log type) {
 	(type == Log::Error || type == Log::Warning ? std::cerr : std::cout) << log_type_str[usize(type)] << msg << std::endl;
 }
 
+
+namespace {
+
+struct LogRecord {
+	u32 size;
+	Log type;
+	u64 time;
+};
+
+static_assert(sizeof(LogRecord) == 16);
+
+static constexpr u32 padding_record = u32(-1);
+static constexpr usize min_ring_size = 1024;
+static constexpr auto drain_interval = std::chrono::milliseconds(10);
+
+usize record_size(usize msg_size) {
+	return (sizeof(LogRecord) + msg_size + sizeof(LogRecord) - 1) & ~(sizeof(LogRecord) - 1);
+}
+
+// Single producer (the owning thread), single consumer (the drain thread)
+// Records are 16 bytes aligned and never wrap: a padding record fills the end of the ring instead
+struct ThreadRing : NonMovable {
+	alignas(64) std::atomic<u64> head = 0;
+	u64 cached_tail = 0;
+
+	// Set while the owner is pushing, so that stopping can wait for in flight messages
+	std::atomic<bool> writing = false;
+
+	alignas(64) std::atomic<u64> tail = 0;
+
+	// Cleared when the owning thread exits, the ring can then be claimed by a new thread
+	std::atomic<bool> owned = true;
+
+	usize capacity = 0;
+	std::unique_ptr<u8[]> data;
+
+	void reset(usize size) {
+		if(capacity != size) {
+			capacity = size;
+			data = std::make_unique<u8[]>(size);
+		}
+		head = 0;
+		tail = 0;
+		cached_tail = 0;
+	}
+
+	usize max_message_size() const {
+		return capacity / 2 - sizeof(LogRecord);
+	}
+
+	// Returns the number of bytes needed to push a record at head, padding included
+	usize required_space(u64 h, usize size) const {
+		const usize contiguous = capacity - usize(h & (capacity - 1));
+		return contiguous < size ? contiguous + size : size;
+	}
+
+	bool has_space(u64 h, usize required) {
+		if(h + required - cached_tail <= capacity) {
+			return true;
+		}
+		cached_tail = tail.load(std::memory_order_acquire);
+		return h + required - cached_tail <= capacity;
+	}
+
+	void push(u64 h, std::string_view msg, Log type, u64 time) {
+		usize pos = usize(h & (capacity - 1));
+		usize advance = record_size(msg.size());
+		if(capacity - pos < advance) {
+			const LogRecord padding = {padding_record, type, 0};
+			std::memcpy(data.get() + pos, &padding, sizeof(padding));
+			advance += capacity - pos;
+			pos = 0;
+		}
+
+		const LogRecord record = {u32(msg.size()), type, time};
+		std::memcpy(data.get() + pos, &record, sizeof(record));
+		std::memcpy(data.get() + pos + sizeof(record), msg.data(), msg.size());
+
+		head.store(h + advance, std::memory_order_release);
+	}
+
+	// Consumer side: returns the position of the next record at or after t, skipping padding
+	const u8* peek(u64& t, u64 h, LogRecord& record) const {
+		while(t != h) {
+			const usize pos = usize(t & (capacity - 1));
+			std::memcpy(&record, data.get() + pos, sizeof(record));
+			if(record.size != padding_record) {
+				return data.get() + pos;
+			}
+			t += capacity - pos;
+		}
+		return nullptr;
+	}
+};
+
+struct AsyncLogger {
+	std::atomic<bool> enabled = false;
+	std::atomic<u64> dropped = 0;
+
+	AsyncLogSettings settings;
+
+	// Guards the ring list
+	std::mutex rings_lock;
+	core::Vector<std::unique_ptr<ThreadRing>> rings;
+
+	// Guards everything below
+	std::mutex drain_lock;
+	std::condition_variable drain_condition;
+	std::condition_variable flush_condition;
+	std::thread drain_thread;
+	std::thread::id drain_thread_id;
+	bool drain_run = false;
+	u64 flush_requested = 0;
+	u64 flushed = 0;
+
+	// Only touched by the drain thread
+	u64 reported_drops = 0;
+	core::Vector<ThreadRing*> drain_rings;
+	core::Vector<u64> drain_heads;
+	core::Vector<u64> drain_tails;
+};
+
+// Never destroyed: threads might still log during shutdown
+AsyncLogger& async_logger() {
+	static AsyncLogger* logger = new AsyncLogger();
+	return *logger;
+}
+
+
+thread_local ThreadRing* thread_ring = nullptr;
+thread_local bool thread_ring_released = false;
+
+struct ThreadRingOwner {
+	~ThreadRingOwner() {
+		// Anything left in the ring is still drained before a new thread claims it
+		if(thread_ring) {
+			thread_ring->owned.store(false, std::memory_order_release);
+			thread_ring = nullptr;
+		}
+		thread_ring_released = true;
+	}
+};
+
+thread_local ThreadRingOwner thread_ring_owner;
+
+ThreadRing* register_thread_ring(AsyncLogger& logger) {
+	if(thread_ring_released) {
+		return nullptr;
+	}
+
+	unused(thread_ring_owner);
+
+	const std::unique_lock lock(logger.rings_lock);
+	for(const auto& ring : logger.rings) {
+		bool owned = false;
+		if(ring->owned.compare_exchange_strong(owned, true, std::memory_order_acquire)) {
+			return thread_ring = ring.get();
+		}
+	}
+
+	auto ring = std::make_unique<ThreadRing>();
+	ring->reset(logger.settings.ring_size);
+	return thread_ring = logger.rings.emplace_back(std::move(ring)).get();
+}
+
+bool is_drain_thread(const AsyncLogger& logger) {
+	return logger.drain_thread_id == std::this_thread::get_id();
+}
+
+void wake_drain_thread(AsyncLogger& logger) {
+	// Not locking can lose the notification, in which case the drain thread wakes up on its own
+	logger.drain_condition.notify_one();
+}
+
+// Returns false if the message could not be queued and should be delivered synchronously
+bool try_push(AsyncLogger& logger, std::string_view msg, Log type, u64 time) {
+	ThreadRing* ring = thread_ring;
+	if(!ring && !(ring = register_thread_ring(logger))) {
+		return false;
+	}
+
+	ring->writing.store(true);
+	if(!logger.enabled.load()) {
+		ring->writing.store(false, std::memory_order_release);
+		return false;
+	}
+
+	msg = msg.substr(0, ring->max_message_size());
+
+	const u64 h = ring->head.load(std::memory_order_relaxed);
+	const usize required = ring->required_space(h, record_size(msg.size()));
+	if(!ring->has_space(h, required)) {
+		// The drain thread can not wait on itself
+		if(logger.settings.overflow == LogOverflow::Drop || is_drain_thread(logger)) {
+			logger.dropped.fetch_add(1, std::memory_order_relaxed);
+			ring->writing.store(false, std::memory_order_release);
+			return true;
+		}
+
+		do {
+			wake_drain_thread(logger);
+			std::this_thread::yield();
+		} while(!ring->has_space(h, required));
+	}
+
+	ring->push(h, msg, type, time);
+
+	// Wake the drain thread early rather than letting the ring fill up
+	if(h + required - ring->cached_tail > ring->capacity / 2) {
+		ring->cached_tail = ring->tail.load(std::memory_order_acquire);
+		if(h + required - ring->cached_tail > ring->capacity / 2) {
+			wake_drain_thread(logger);
+		}
+	}
+
+	ring->writing.store(false, std::memory_order_release);
+	return true;
+}
+
+// Delivers everything that was queued when the pass started, oldest message first
+void drain(AsyncLogger& logger) {
+	auto& rings = logger.drain_rings;
+	auto& heads = logger.drain_heads;
+	auto& tails = logger.drain_tails;
+
+	{
+		const std::unique_lock lock(logger.rings_lock);
+		rings.make_empty();
+		for(const auto& ring : logger.rings) {
+			rings << ring.get();
+		}
+	}
+
+	heads.make_empty();
+	tails.make_empty();
+	for(const ThreadRing* ring : rings) {
+		heads << ring->head.load(std::memory_order_acquire);
+		tails << ring->tail.load(std::memory_order_relaxed);
+	}
+
+	for(;;) {
+		usize next = usize(-1);
+		u64 next_time = 0;
+		const u8* next_data = nullptr;
+		LogRecord next_record = {};
+
+		for(usize i = 0; i != rings.size(); ++i) {
+			LogRecord record = {};
+			const u8* data = rings[i]->peek(tails[i], heads[i], record);
+			if(data && (!next_data || record.time < next_time)) {
+				next = i;
+				next_time = record.time;
+				next_data = data;
+				next_record = record;
+			}
+		}
+
+		if(!next_data) {
+			break;
+		}
+
+		deliver(std::string_view(reinterpret_cast<const char*>(next_data + sizeof(LogRecord)), next_record.size), next_record.type, next_record.time);
+
+		tails[next] += record_size(next_record.size);
+		rings[next]->tail.store(tails[next], std::memory_order_release);
+	}
+
+	// Rings might only contain padding at this point
+	for(usize i = 0; i != rings.size(); ++i) {
+		rings[i]->tail.store(tails[i], std::memory_order_release);
+	}
+
+	const u64 dropped = logger.dropped.load(std::memory_order_relaxed);
+	if(dropped != logger.reported_drops) {
+		char msg[64] = {};
+		const std::string_view warning = fmt_to(msg, "% log messages dropped.", dropped - logger.reported_drops);
+		logger.reported_drops = dropped;
+		deliver(warning, Log::Warning, now_ns());
+	}
+}
+
+void drain_loop() {
+	concurrent::set_thread_name("Log drain");
+
+	AsyncLogger& logger = async_logger();
+	std::unique_lock lock(logger.drain_lock);
+	for(;;) {
+		const bool run = logger.drain_run;
+		const u64 requested = logger.flush_requested;
+
+		lock.unlock();
+		drain(logger);
+		lock.lock();
+
+		logger.flushed = requested;
+		logger.flush_condition.notify_all();
+
+		if(!run) {
+			break;
+		}
+
+		if(logger.drain_run && logger.flush_requested == requested) {
+			logger.drain_condition.wait_for(lock, drain_interval);
+		}
+	}
+}
+
+}
+
+
+void log_msg(std::string_view msg, Log type) {
+	const u64 time = now_ns();
+
+	AsyncLogger& logger = async_logger();
+	if(logger.enabled.load(std::memory_order_relaxed) && try_push(logger, msg, type, time)) {
+		if(type == Log::Error) {
+			flush_log();
+		}
+		return;
+	}
+
+	deliver(msg, type, time);
+}
+
 void set_log_callback(detail::log_callback func, void* user_data) {
 	std::lock_guard _(lock);
 	callback = func;
 	callback_user_data = user_data;
 }
 
+u64 log_time_ns() {
+	return delivered_time;
+}
+
+void start_async_logging(const AsyncLogSettings& settings) {
+	AsyncLogger& logger = async_logger();
+
+	const std::unique_lock lock(logger.drain_lock);
+	if(logger.enabled) {
+		y_fatal("Async logging already started.");
+	}
+
+	usize ring_size = min_ring_size;
+	while(ring_size < settings.ring_size) {
+		ring_size *= 2;
+	}
+
+	{
+		// Rings are empty and unused at this point
+		const std::unique_lock rings_lock(logger.rings_lock);
+		logger.settings = settings;
+		logger.settings.ring_size = ring_size;
+		for(const auto& ring : logger.rings) {
+			ring->reset(ring_size);
+		}
+	}
+
+	logger.drain_run = true;
+	logger.drain_thread = std::thread(drain_loop);
+	logger.drain_thread_id = logger.drain_thread.get_id();
+
+	logger.enabled.store(true);
+}
+
+void stop_async_logging() {
+	AsyncLogger& logger = async_logger();
+	if(is_drain_thread(logger)) {
+		y_fatal("Async logging can not be stopped from the log callback.");
+	}
+
+	{
+		const std::unique_lock lock(logger.drain_lock);
+		if(!logger.enabled) {
+			return;
+		}
+		logger.enabled.store(false);
+	}
+
+	core::Vector<ThreadRing*> rings;
+	{
+		const std::unique_lock lock(logger.rings_lock);
+		for(const auto& ring : logger.rings) {
+			rings << ring.get();
+		}
+	}
+
+	// Blocked writers need the drain thread to keep going
+	for(const ThreadRing* ring : rings) {
+		while(ring->writing.load()) {
+			std::this_thread::yield();
+		}
+	}
+
+	{
+		const std::unique_lock lock(logger.drain_lock);
+		logger.drain_run = false;
+	}
+
+	logger.drain_condition.notify_all();
+	logger.drain_thread.join();
+
+	const std::unique_lock lock(logger.drain_lock);
+	logger.drain_thread_id = std::thread::id();
+}
+
+bool is_async_logging() {
+	return async_logger().enabled.load(std::memory_order_relaxed);
+}
+
+void flush_log() {
+	AsyncLogger& logger = async_logger();
+
+	std::unique_lock lock(logger.drain_lock);
+	if(!logger.drain_run || is_drain_thread(logger)) {
+		return;
+	}
+
+	const u64 target = ++logger.flush_requested;
+	logger.drain_condition.notify_all();
+	logger.flush_condition.wait(lock, [&] { return logger.flushed >= target; });
+}
+
+u64 dropped_log_count() {
+	return async_logger().dropped.load(std::memory_order_relaxed);
+}
+
 }
@@ -35,8 +35,36 @@ enum class Log {
 	Perf
 };
 
+enum class LogOverflow {
+	Drop,
+	Block
+};
+
+struct AsyncLogSettings {
+	// Per thread ring size in bytes, rounded up to a power of two
+	usize ring_size = 64 * 1024;
+
+	// What to do when a thread fills its ring faster than the sink drains it
+	LogOverflow overflow = LogOverflow::Drop;
+};
+
 void log_msg(std::string_view msg, Log type = Log::Info);
 
+// Messages are queued in per thread rings and delivered in order (per thread) by a background thread.
+// Errors still wait for delivery so that nothing is lost right before a fatal error.
+void start_async_logging(const AsyncLogSettings& settings = AsyncLogSettings());
+void stop_async_logging();
+bool is_async_logging();
+
+// Returns once every message logged by this thread before the call has been delivered
+void flush_log();
+
+u64 dropped_log_count();
+
+// Timestamp (steady clock, in ns) taken when the message being delivered was logged.
+// Only meaningful from within the log callback.
+u64 log_time_ns();
+
 
 namespace detail {
 void setup_console();
@@ -20,26 +20,368 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE.
 **********************************/
 
+
 #include "perf.h"
 
 #include <y/core/Chrono.h>
+#include <y/core/String.h>
+#include <y/core/HashMap.h>
 #include <y/io2/File.h>
+#include <y/utils/format.h>
 
 #include <y/concurrent/concurrent.h>
+#include <y/concurrent/StaticThreadPool.h>
+#include <y/mem/ThreadCachingAllocator.h>
 
 #include <atomic>
 #include <thread>
 #include <mutex>
+#include <condition_variable>
+#include <memory>
+#include <chrono>
 #include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define Y_PERF_USE_TSC
+#ifdef Y_MSVC
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#endif
 
 
 namespace y {
 namespace perf {
 
+namespace {
+
+enum class EventType : u32 {
+	Enter,
+	Leave,
+	Instant,
+
+	// Counters take two events, the second one holds the value (as a double) instead of the ticks
+	Counter,
+	CounterValue
+};
+
+struct Event {
+	u64 ticks;
+	ZoneId zone;
+	EventType type;
+};
+
+static_assert(sizeof(Event) == 16);
+
+// Ring slots are atomic so that the flight recorder can read them while the owner overwrites them
+struct EventSlot {
+	std::atomic<u64> ticks;
+	std::atomic<u64> zone_and_type;
+
+	void store(const Event& event) {
+		ticks.store(event.ticks, std::memory_order_relaxed);
+		zone_and_type.store(u64(event.zone) | (u64(event.type) << 32), std::memory_order_relaxed);
+	}
+
+	Event load() const {
+		const u64 packed = zone_and_type.load(std::memory_order_relaxed);
+		return Event{ticks.load(std::memory_order_relaxed), ZoneId(packed), EventType(packed >> 32)};
+	}
+};
+
+
+// Binary capture layout: a FileHeader followed by records
+enum class RecordType : u32 {
+	Zone = 1,		// id = zone id, payload = name
+	Thread,			// id = thread id, payload = name
+	Events,			// id = thread id, payload = Event[]
+	Dropped,		// id = thread id, payload = u32 count
+	Calibration		// payload = Calibration
+};
+
+struct FileHeader {
+	u32 magic = 0;
+	u32 version = 0;
+};
+
+struct RecordHeader {
+	RecordType type;
+	u32 id;
+	u64 size;
+};
+
+struct Calibration {
+	u64 start_ticks = 0;
+	u64 end_ticks = 0;
+	double start_us = 0.0;
+	double end_us = 0.0;
+};
+
+static constexpr u32 capture_magic = 0x46525059; // "YPRF"
+static constexpr u32 capture_version = 2;
+
+// 256KB per thread: small enough to stay in cache, recording gets a lot slower once every write misses
+static constexpr usize ring_size = 16 * 1024;
+static constexpr auto flush_interval = std::chrono::milliseconds(2);
+
+static constexpr usize max_flight_frames = 256;
+
+// Zone stats histograms: 4 buckets per power of 2 of the duration in ticks
+static constexpr usize bucket_count = 192;
+static constexpr usize zones_per_page = 256;
+static constexpr usize max_zone_pages = 256;
+
+static u64 ticks() {
+#ifdef Y_PERF_USE_TSC
+	return __rdtsc();
+#else
+	return u64(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+}
+
+static double micros() {
+	return core::Chrono::program().to_micros();
+}
+
+static usize log2(u64 n) {
+	y_debug_assert(n);
+#ifdef Y_MSVC
+	unsigned long index = 0;
+	_BitScanReverse64(&index, n);
+	return usize(index);
+#else
+	return usize(63 - __builtin_clzll(n));
+#endif
+}
+
+static usize bucket_index(u64 duration) {
+	if(duration < 4) {
+		return usize(duration);
+	}
+	const usize octave = log2(duration);
+	const usize sub = usize(duration >> (octave - 2)) & 3;
+	return std::min((octave - 1) * 4 + sub, bucket_count - 1);
+}
+
+// Middle of the bucket
+static double bucket_value(usize index) {
+	if(index < 4) {
+		return double(index);
+	}
+	const usize octave = index / 4 + 1;
+	const double low = double(u64(4 + index % 4) << (octave - 2));
+	return low + double(u64(1) << (octave - 2)) * 0.5;
+}
+
+
+// Single producer (the owning thread), single consumer (the flusher)
+// When flight recording outside of captures, the producer ignores the consumer and overwrites the oldest events
+struct ThreadBuffer : NonMovable {
+	alignas(64) std::atomic<u64> head = 0;
+	u64 cached_tail = 0;
+
+	alignas(64) std::atomic<u64> tail = 0;
+
+	std::atomic<u32> dropped = 0;
+	std::atomic<bool> orphaned = false;
+
+	// Only touched by the flusher
+	bool announced = false;
+
+	u32 thread_id = 0;
+	core::String thread_name;
+
+	std::unique_ptr<EventSlot[]> events = std::make_unique<EventSlot[]>(ring_size);
+
+	void push(ZoneId zone, EventType type, u64 timestamp, bool overwrite) {
+		const u64 h = head.load(std::memory_order_relaxed);
+		if(!overwrite && h - cached_tail >= ring_size) {
+			cached_tail = tail.load(std::memory_order_acquire);
+			if(h - cached_tail >= ring_size) {
+				dropped.fetch_add(1, std::memory_order_relaxed);
+				return;
+			}
+		}
+		events[h % ring_size].store(Event{timestamp, zone, type});
+		head.store(h + 1, std::memory_order_release);
+	}
+
+	// Both events are published together so that consumers never see half a counter
+	void push_counter(ZoneId zone, u64 timestamp, double value, bool overwrite) {
+		const u64 h = head.load(std::memory_order_relaxed);
+		if(!overwrite && h + 2 - cached_tail > ring_size) {
+			cached_tail = tail.load(std::memory_order_acquire);
+			if(h + 2 - cached_tail > ring_size) {
+				dropped.fetch_add(2, std::memory_order_relaxed);
+				return;
+			}
+		}
+
+		u64 value_bits = 0;
+		std::memcpy(&value_bits, &value, sizeof(value));
+		events[h % ring_size].store(Event{timestamp, zone, EventType::Counter});
+		events[(h + 1) % ring_size].store(Event{value_bits, zone, EventType::CounterValue});
+		head.store(h + 2, std::memory_order_release);
+	}
+};
+
+// Only written by the owning thread, atomics so that end_frame can read them
+struct ZoneRecord {
+	std::atomic<u64> frame = 0;
+	std::atomic<u64> count = 0;
+	std::atomic<u64> total = 0;
+	std::atomic<u64> min = 0;
+	std::atomic<u64> max = 0;
+
+	// Range of buckets used this frame, so that resets and merges don't touch all of them
+	std::atomic<u32> first_bucket = 0;
+	std::atomic<u32> last_bucket = 0;
+	std::array<std::atomic<u32>, bucket_count> buckets = {};
+
+	void add(u64 current_frame, u64 duration) {
+		const u32 bucket = u32(bucket_index(duration));
+		if(frame.load(std::memory_order_relaxed) != current_frame) {
+			for(u32 i = first_bucket.load(std::memory_order_relaxed); i <= last_bucket.load(std::memory_order_relaxed); ++i) {
+				buckets[i].store(0, std::memory_order_relaxed);
+			}
+			count.store(0, std::memory_order_relaxed);
+			total.store(0, std::memory_order_relaxed);
+			min.store(duration, std::memory_order_relaxed);
+			max.store(duration, std::memory_order_relaxed);
+			first_bucket.store(bucket, std::memory_order_relaxed);
+			last_bucket.store(bucket, std::memory_order_relaxed);
+			frame.store(current_frame, std::memory_order_release);
+		}
+
+		count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+		total.store(total.load(std::memory_order_relaxed) + duration, std::memory_order_relaxed);
+		min.store(std::min(min.load(std::memory_order_relaxed), duration), std::memory_order_relaxed);
+		max.store(std::max(max.load(std::memory_order_relaxed), duration), std::memory_order_relaxed);
+		first_bucket.store(std::min(first_bucket.load(std::memory_order_relaxed), bucket), std::memory_order_relaxed);
+		last_bucket.store(std::max(last_bucket.load(std::memory_order_relaxed), bucket), std::memory_order_relaxed);
+		buckets[bucket].store(buckets[bucket].load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+	}
+};
+
+struct ZonePage {
+	std::array<std::atomic<ZoneRecord*>, zones_per_page> records = {};
+
+	~ZonePage() {
+		for(auto& record : records) {
+			delete record.load(std::memory_order_relaxed);
+		}
+	}
+};
+
+struct ThreadStats : NonMovable {
+	std::array<std::atomic<ZonePage*>, max_zone_pages> pages = {};
+	std::atomic<bool> orphaned = false;
+
+	~ThreadStats() {
+		for(auto& page : pages) {
+			delete page.load(std::memory_order_relaxed);
+		}
+	}
+
+	// Records are created by the owning thread only
+	ZoneRecord* record(ZoneId zone) {
+		const usize page_index = zone / zones_per_page;
+		if(page_index >= max_zone_pages) {
+			return nullptr;
+		}
+
+		ZonePage* page = pages[page_index].load(std::memory_order_relaxed);
+		if(!page) {
+			page = new ZonePage();
+			pages[page_index].store(page, std::memory_order_release);
+		}
+
+		std::atomic<ZoneRecord*>& slot = page->records[zone % zones_per_page];
+		ZoneRecord* record = slot.load(std::memory_order_relaxed);
+		if(!record) {
+			record = new ZoneRecord();
+			slot.store(record, std::memory_order_release);
+		}
+		return record;
+	}
+};
+
+struct ZoneAccumulator {
+	u64 count = 0;
+	u64 total = 0;
+	u64 min = u64(-1);
+	u64 max = 0;
+	u32 first_bucket = u32(bucket_count);
+	u32 last_bucket = 0;
+	std::array<u64, bucket_count> buckets = {};
+};
+
+struct Recorder {
+	std::mutex zones_lock;
+	core::Vector<core::String> zone_names;
+	core::ExternalHashMap<core::String, ZoneId> zone_ids;
+
+	// Guards everything below
+	std::mutex lock;
+	core::Vector<std::unique_ptr<ThreadBuffer>> buffers;
+
+	std::unique_ptr<io2::File> output;
+	core::String output_name;
+	usize written_zones = 0;
+
+	u64 start_ticks = 0;
+	double start_us = 0.0;
+
+	std::thread flusher;
+	std::condition_variable flusher_condition;
+	bool flusher_run = false;
+
+	core::Vector<Event> events;
+
+	// Flight recorder, ring of frame start timestamps
+	FlightRecorderSettings flight_settings;
+	core::Vector<u64> frame_starts;
+	usize frame_start_index = 0;
+	u64 next_spike_dump = 0;
+
+	// Zone stats
+	std::mutex stats_lock;
+	core::Vector<std::unique_ptr<ThreadStats>> thread_stats;
+	core::Vector<ZoneAccumulator> accumulators;
+	core::Vector<ZoneId> touched_zones;
+	ZoneStatsSnapshot snapshot;
+
+	u64 frame_start_ticks = ticks();
+	u64 first_ticks = ticks();
+	double first_us = micros();
+};
+
+// Never destroyed: threads might still record during shutdown
+Recorder& recorder() {
+	static Recorder* recorder = new Recorder();
+	return *recorder;
+}
+
+enum RecordingMode : u32 {
+	Capturing = 0x01,
+	CollectingStats = 0x02,
+	FlightRecording = 0x04,
+
+	RecordingEvents = Capturing | FlightRecording
+};
 
 #ifdef Y_PERF_LOG_ENABLED
+static std::atomic<u32> recording_mode = CollectingStats;
+#else
+static std::atomic<u32> recording_mode = 0;
+#endif
+
+static std::atomic<u64> current_frame = 1;
 
-namespace {
 static struct Guard {
 	~Guard() {
 		if(is_capturing()) {
@@ -50,210 +392,727 @@ static struct Guard {
 	void use() {
 	}
 } guard;
-}
 
 
-class ThreadData;
+thread_local ThreadBuffer* thread_buffer = nullptr;
+thread_local ThreadStats* thread_stats = nullptr;
+thread_local bool thread_data_released = false;
 
-static std::recursive_mutex mutex;
-static std::shared_ptr<io2::File> output_file;
+struct ThreadDataOwner {
+	~ThreadDataOwner() {
+		// The flusher and end_frame free them once they have been read
+		if(thread_buffer) {
+			thread_buffer->orphaned.store(true, std::memory_order_release);
+			thread_buffer = nullptr;
+		}
+		if(thread_stats) {
+			thread_stats->orphaned.store(true, std::memory_order_release);
+			thread_stats = nullptr;
+		}
+		thread_data_released = true;
+	}
+};
 
-static constexpr usize buffer_size = 1024 * 1024;
-static constexpr usize print_buffer_len = 512;
+thread_local ThreadDataOwner thread_data_owner;
 
-static std::shared_ptr<ThreadData> head;
-static std::atomic<bool> capturing = false;
-static std::atomic<u32> capture_id = 0;
+ThreadBuffer* register_thread_buffer() {
+	if(thread_data_released) {
+		return nullptr;
+	}
 
+	unused(thread_data_owner);
 
-static thread_local ThreadData* thread_local_ptr = nullptr;
-static thread_local u32 thread_capture_id = 0;
+	auto buffer = std::make_unique<ThreadBuffer>();
+	buffer->thread_id = concurrent::thread_id();
+	if(const char* name = concurrent::thread_name()) {
+		buffer->thread_name = name;
+	}
 
+	Recorder& r = recorder();
+	const std::unique_lock lock(r.lock);
+	return thread_buffer = r.buffers.emplace_back(std::move(buffer)).get();
+}
 
+ThreadStats* register_thread_stats() {
+	if(thread_data_released) {
+		return nullptr;
+	}
 
+	unused(thread_data_owner);
 
-static double micros() {
-	return core::Chrono::program().to_micros();
+	Recorder& r = recorder();
+	const std::unique_lock lock(r.stats_lock);
+	return thread_stats = r.thread_stats.emplace_back(std::make_unique<ThreadStats>()).get();
 }
 
-static bool is_thread_capturing() {
-	return capturing && thread_capture_id == capture_id;
+void record(ZoneId zone, EventType type, u64 timestamp, u32 mode) {
+	ThreadBuffer* buffer = thread_buffer;
+	if(!buffer && !(buffer = register_thread_buffer())) {
+		return;
+	}
+	buffer->push(zone, type, timestamp, !(mode & Capturing));
 }
 
-bool is_capturing() {
-	return capturing;
-}
-
-class ThreadData final : public std::enable_shared_from_this<ThreadData>, NonMovable {
-	public:
-		ThreadData(std::shared_ptr<io2::File> output, std::shared_ptr<ThreadData> next_thread) :
-				_output_file(std::move(output)),
-				_next(std::move(next_thread)),
-				_original_thread_id(concurrent::thread_id()) {
-
-			if(_output_file) {
-				_buffer = std::make_unique<u8[]>(buffer_size);
-				if(const char* name = concurrent::thread_name()) {
-					char b[print_buffer_len];
-					const usize len = std::snprintf(b, sizeof(b), R"({"name":"thread_name","ph":"M","pid":0,"tid":%u,"args":{"name":"%u: %s"}},)", concurrent::thread_id(), concurrent::thread_id(), name);
-					if(len >= sizeof(b)) {
-						y_fatal("Too long.");
-					}
-					write(b, len);
-				}
-			}
+void record_counter(ZoneId zone, double value, u32 mode) {
+	ThreadBuffer* buffer = thread_buffer;
+	if(!buffer && !(buffer = register_thread_buffer())) {
+		return;
+	}
+	buffer->push_counter(zone, ticks(), value, !(mode & Capturing));
+}
+
+void record_stats(ZoneId zone, u64 duration) {
+	ThreadStats* stats = thread_stats;
+	if(!stats && !(stats = register_thread_stats())) {
+		return;
+	}
+	if(ZoneRecord* record = stats->record(zone)) {
+		record->add(current_frame.load(std::memory_order_relaxed), duration);
+	}
+}
+
+// Must be called with the stats lock held
+void merge_thread_stats(Recorder& r, const ThreadStats& stats, u64 frame) {
+	for(usize p = 0; p != max_zone_pages; ++p) {
+		const ZonePage* page = stats.pages[p].load(std::memory_order_acquire);
+		if(!page) {
+			continue;
 		}
 
-		~ThreadData() {
-			y_debug_assert(!_buffer == !_output_file);
-			if(_buffer) {
-				flush();
-				// last thread to be deleted writes the end
-				if(!_next) {
-					char b[print_buffer_len];
-					const usize len = std::snprintf(b, sizeof(b), R"({"name":"capture ended","cat":"perf","ph":"I","pid":0,"tid":%u,"ts":%.1f}]})", concurrent::thread_id(), micros());
-					_output_file->write(b, len).expected("Unable to write perf dump.");
-				}
+		for(usize i = 0; i != zones_per_page; ++i) {
+			const ZoneRecord* record = page->records[i].load(std::memory_order_acquire);
+			if(!record || record->frame.load(std::memory_order_acquire) != frame) {
+				continue;
 			}
 
+			const ZoneId zone = ZoneId(p * zones_per_page + i);
+			while(r.accumulators.size() <= zone) {
+				r.accumulators.emplace_back();
+			}
+
+			ZoneAccumulator& acc = r.accumulators[zone];
+			if(!acc.count) {
+				r.touched_zones << zone;
+			}
+
+			acc.count += record->count.load(std::memory_order_relaxed);
+			acc.total += record->total.load(std::memory_order_relaxed);
+			acc.min = std::min(acc.min, record->min.load(std::memory_order_relaxed));
+			acc.max = std::max(acc.max, record->max.load(std::memory_order_relaxed));
+
+			const u32 first = record->first_bucket.load(std::memory_order_relaxed);
+			const u32 last = std::min(record->last_bucket.load(std::memory_order_relaxed), u32(bucket_count - 1));
+			acc.first_bucket = std::min(acc.first_bucket, first);
+			acc.last_bucket = std::max(acc.last_bucket, last);
+			for(u32 b = first; b <= last; ++b) {
+				acc.buckets[b] += record->buckets[b].load(std::memory_order_relaxed);
+			}
 		}
+	}
+}
 
-		void write(const char* str, usize len) {
-			if(_buffer) {
-				const usize remaining = buffer_size - _buffer_offset;
-				if(len >= remaining) {
-					flush();
-				}
-				std::memcpy(_buffer.get() + _buffer_offset, str, len);
-				_buffer_offset += len;
+double us_per_tick(const Recorder& r, u64 now) {
+	const double elapsed_ticks = double(now - r.first_ticks);
+	return elapsed_ticks > 0.0 ? (micros() - r.first_us) / elapsed_ticks : 0.0;
+}
+
+double percentile(const ZoneAccumulator& acc, double p) {
+	const u64 rank = std::max(u64(1), u64(std::ceil(double(acc.count) * p)));
+	u64 seen = 0;
+	for(u32 b = acc.first_bucket; b <= acc.last_bucket; ++b) {
+		seen += acc.buckets[b];
+		if(seen >= rank) {
+			return std::clamp(bucket_value(b), double(acc.min), double(acc.max));
+		}
+	}
+	return double(acc.max);
+}
+
+
+void write_record(io2::File& file, RecordType type, u32 id, const void* data, usize size) {
+	const RecordHeader header{type, id, size};
+	file.write_one(header).expected("Unable to write perf dump.");
+	if(size) {
+		file.write(data, size).expected("Unable to write perf dump.");
+	}
+}
+
+// Must be called with the recorder lock held
+void drain(Recorder& r) {
+	y_debug_assert(r.output);
+	io2::File& file = *r.output;
+
+	// Zones first so that every event refers to a known zone
+	{
+		const std::unique_lock lock(r.zones_lock);
+		for(; r.written_zones != r.zone_names.size(); ++r.written_zones) {
+			const core::String& name = r.zone_names[r.written_zones];
+			write_record(file, RecordType::Zone, u32(r.written_zones), name.data(), name.size());
+		}
+	}
+
+	for(usize i = 0; i != r.buffers.size();) {
+		ThreadBuffer& buffer = *r.buffers[i];
+		const bool orphaned = buffer.orphaned.load(std::memory_order_acquire);
+
+		if(!buffer.announced) {
+			write_record(file, RecordType::Thread, buffer.thread_id, buffer.thread_name.data(), buffer.thread_name.size());
+			buffer.announced = true;
+		}
+
+		const u64 tail = buffer.tail.load(std::memory_order_relaxed);
+		const u64 head = buffer.head.load(std::memory_order_acquire);
+		if(head != tail) {
+			r.events.make_empty();
+			for(u64 i = tail; i != head; ++i) {
+				r.events.emplace_back(buffer.events[i % ring_size].load());
 			}
+			write_record(file, RecordType::Events, buffer.thread_id, r.events.data(), r.events.size() * sizeof(Event));
+			buffer.tail.store(head, std::memory_order_release);
 		}
 
-		bool is_empty() const {
-			return !_buffer;
+		if(const u32 dropped = buffer.dropped.exchange(0, std::memory_order_relaxed)) {
+			write_record(file, RecordType::Dropped, buffer.thread_id, &dropped, sizeof(dropped));
 		}
 
-	private:
-		void flush() {
-			const std::unique_lock lock(mutex);
-			y_debug_assert(output_file);
-			y_debug_assert(output_file->is_open());
-			_output_file->write(_buffer.get(), _buffer_offset).expected("Unable to write perf dump.");
-			_buffer_offset = 0;
+		if(orphaned) {
+			r.buffers.erase_unordered(r.buffers.begin() + i);
+		} else {
+			++i;
 		}
+	}
+}
 
-		std::unique_ptr<u8[]> _buffer;
-		usize _buffer_offset = 0;
+void flusher_loop() {
+	concurrent::set_thread_name("Perf flusher");
 
-		std::shared_ptr<io2::File> _output_file;
-		std::shared_ptr<ThreadData> _next;
-		const u32 _original_thread_id;
+	Recorder& r = recorder();
+	std::unique_lock lock(r.lock);
+	while(r.flusher_run) {
+		r.flusher_condition.wait_for(lock, flush_interval);
+		drain(r);
+	}
+}
 
-};
 
-void start_capture(const char* out_filename) {
-	auto file = std::make_shared<io2::File>(std::move(io2::File::create(out_filename).expected("Unable to open output file.")));
+// Must be called with the recorder lock held, outside of captures
+void release_orphaned_buffers(Recorder& r) {
+	for(usize i = 0; i != r.buffers.size();) {
+		if(r.buffers[i]->orphaned.load(std::memory_order_acquire)) {
+			r.buffers.erase_unordered(r.buffers.begin() + i);
+		} else {
+			++i;
+		}
+	}
+}
 
+// Must be called with the recorder lock held
+core::String dump_flight_recorder(Recorder& r, u64 frame) {
+	if(!(recording_mode & FlightRecording) || is_capturing()) {
+		return core::String();
+	}
+
+	// The oldest slot of the frame ring is the start of the oldest retained frame
+	const u64 frame_start = r.frame_starts[r.frame_start_index];
+
+	const core::String output_name = fmt("%_%.json", r.flight_settings.output_prefix, frame);
+	const core::String binary_name = output_name + ".bin";
 	{
-		const std::string_view start = R"({"traceEvents":[)";
-		file->write(start.data(), start.size()).expected("Unable to write perf dump.");
+		auto output = io2::File::create(binary_name);
+		if(!output) {
+			return core::String();
+		}
+		io2::File& file = output.unwrap();
+		file.write_one(FileHeader{capture_magic, capture_version}).expected("Unable to write perf dump.");
+
+		{
+			const std::unique_lock lock(r.zones_lock);
+			for(usize i = 0; i != r.zone_names.size(); ++i) {
+				write_record(file, RecordType::Zone, u32(i), r.zone_names[i].data(), r.zone_names[i].size());
+			}
+		}
+
+		for(const auto& buffer : r.buffers) {
+			const u64 head = buffer->head.load(std::memory_order_acquire);
+			const u64 begin = head > ring_size ? head - ring_size : 0;
+
+			r.events.make_empty();
+			for(u64 i = begin; i != head; ++i) {
+				r.events.emplace_back(buffer->events[i % ring_size].load());
+			}
+
+			// The owner may have overwritten the oldest slots while we were reading them
+			std::atomic_thread_fence(std::memory_order_acquire);
+			const u64 new_head = buffer->head.load(std::memory_order_relaxed);
+			const u64 valid_begin = new_head >= ring_size ? new_head - ring_size + 1 : 0;
+
+			// Drop zones that started before the retained frames
+			usize depth = 0;
+			usize kept = 0;
+			bool counter_kept = false;
+			for(u64 i = begin; i != head; ++i) {
+				const Event& event = r.events[usize(i - begin)];
+				if(event.type == EventType::CounterValue) {
+					if(counter_kept) {
+						r.events[kept++] = event;
+					}
+					counter_kept = false;
+					continue;
+				}
+
+				counter_kept = false;
+				if(i < valid_begin || event.ticks < frame_start) {
+					continue;
+				}
+				if(event.type == EventType::Counter) {
+					counter_kept = true;
+				} else if(event.type == EventType::Enter) {
+					++depth;
+				} else if(event.type == EventType::Leave) {
+					if(!depth) {
+						continue;
+					}
+					--depth;
+				}
+				r.events[kept++] = event;
+			}
+
+			write_record(file, RecordType::Thread, buffer->thread_id, buffer->thread_name.data(), buffer->thread_name.size());
+			write_record(file, RecordType::Events, buffer->thread_id, r.events.data(), kept * sizeof(Event));
+		}
+
+		const u64 now = ticks();
+		const double now_us = micros();
+		const double start_us = now_us - double(now - frame_start) * us_per_tick(r, now);
+		const Calibration calibration{frame_start, now, start_us, now_us};
+		write_record(file, RecordType::Calibration, 0, &calibration, sizeof(calibration));
+	}
+
+	const bool converted = convert_capture(binary_name.data(), output_name.data()).is_ok();
+	std::remove(binary_name.data());
+	return converted ? output_name : core::String();
+}
+
+void flight_recorder_end_frame(Recorder& r, u64 frame, u64 frame_end, double frame_us) {
+	const std::unique_lock lock(r.lock);
+	if(!(recording_mode & FlightRecording)) {
+		return;
+	}
+
+	const FlightRecorderSettings& settings = r.flight_settings;
+	const bool spike = settings.spike_threshold_ms > 0.0 && frame_us > settings.spike_threshold_ms * 1000.0;
+
+	// Don't dump again until the dumped frames have left the recorder, the dump itself makes the next frame spike
+	if(spike && frame >= r.next_spike_dump) {
+		dump_flight_recorder(r, frame);
+		r.next_spike_dump = frame + settings.frame_count + 1;
 	}
 
-	const std::unique_lock lock(mutex);
+	r.frame_starts[r.frame_start_index] = frame_end;
+	r.frame_start_index = (r.frame_start_index + 1) % r.frame_starts.size();
+
+	if(!is_capturing()) {
+		release_orphaned_buffers(r);
+	}
+}
+
+
+// Zone names end at the first parenthesis and are escaped for JSON
+core::String sanitize_zone_name(const char* name) {
+	core::String sanitized;
+	for(const char* c = name; *c && *c != '('; ++c) {
+		sanitized.push_back(*c == '"' ? '\'' : (*c == '\\' ? '/' : *c));
+	}
+	return sanitized;
+}
+
+}
+
+
+ZoneId zone_id(const char* name) {
+	core::String sanitized = sanitize_zone_name(name);
+
+	Recorder& r = recorder();
+	const std::unique_lock lock(r.zones_lock);
+	if(const auto it = r.zone_ids.find(sanitized); it != r.zone_ids.end()) {
+		return it->second;
+	}
+
+	const ZoneId id = ZoneId(r.zone_names.size());
+	r.zone_ids.emplace(sanitized, id);
+	r.zone_names.emplace_back(std::move(sanitized));
+	return id;
+}
+
+bool is_capturing() {
+	return recording_mode & Capturing;
+}
+
+void start_capture(const char* out_filename) {
+	Recorder& r = recorder();
+	const std::unique_lock lock(r.lock);
 
 	if(is_capturing()) {
 		y_fatal("Capture already in progress.");
 	}
 
-	output_file = std::move(file);
+	r.output_name = out_filename;
+	r.output = std::make_unique<io2::File>(std::move(io2::File::create(r.output_name + ".bin").expected("Unable to open output file.")));
+	r.output->write_one(FileHeader{capture_magic, capture_version}).expected("Unable to write perf dump.");
+	r.written_zones = 0;
+
+	// Throw away anything recorded after the last capture ended
+	for(const auto& buffer : r.buffers) {
+		buffer->tail.store(buffer->head.load(std::memory_order_acquire), std::memory_order_release);
+		buffer->dropped = 0;
+		buffer->announced = false;
+	}
+
+	r.start_ticks = ticks();
+	r.start_us = micros();
+
+	r.flusher_run = true;
+	r.flusher = std::thread(flusher_loop);
+
 	guard.use();
-	++capture_id;
-	capturing = true;
+	recording_mode.fetch_or(Capturing);
 }
 
-
 void end_capture() {
-	const std::unique_lock lock(mutex);
+	Recorder& r = recorder();
+	{
+		const std::unique_lock lock(r.lock);
+		if(!is_capturing()) {
+			y_fatal("Not capturing.");
+		}
+		recording_mode.fetch_and(~u32(Capturing));
+		r.flusher_run = false;
+	}
 
-	if(!is_capturing()) {
-		y_fatal("Not capturing.");
+	r.flusher_condition.notify_all();
+	r.flusher.join();
+
+	core::String output_name;
+	{
+		const std::unique_lock lock(r.lock);
+		drain(r);
+
+		const Calibration calibration{r.start_ticks, ticks(), r.start_us, micros()};
+		write_record(*r.output, RecordType::Calibration, 0, &calibration, sizeof(calibration));
+		r.output = nullptr;
+
+		output_name = r.output_name;
 	}
 
-	capturing = false;
-	head = nullptr;
-	output_file = nullptr;
+	convert_capture((output_name + ".bin").data(), output_name.data()).expected("Unable to convert perf dump.");
 }
 
-static std::shared_ptr<ThreadData> thread_data() {
-	std::shared_ptr<ThreadData> data;
-	if(!is_thread_capturing()) {
-		std::unique_lock lock(mutex);
-		auto file = output_file;
-		data = std::make_shared<ThreadData>(output_file, head);
-		if(!data->is_empty()) {
-			head = data;
+
+core::Result<void> convert_capture(const char* binary_filename, const char* json_filename) {
+	core::Vector<u8> data;
+	{
+		auto file = io2::File::open(binary_filename);
+		if(!file || !file.unwrap().read_all(data)) {
+			return core::Err();
 		}
-		thread_local_ptr = data.get();
-		thread_capture_id = capture_id;
+	}
+
+	FileHeader file_header;
+	if(data.size() < sizeof(file_header)) {
+		return core::Err();
+	}
+	std::memcpy(&file_header, data.data(), sizeof(file_header));
+	if(file_header.magic != capture_magic || file_header.version != capture_version) {
+		return core::Err();
+	}
+
+	const auto for_each_record = [&](auto&& func) {
+		for(usize offset = sizeof(file_header); offset + sizeof(RecordHeader) <= data.size();) {
+			RecordHeader header;
+			std::memcpy(&header, data.data() + offset, sizeof(header));
+			offset += sizeof(header);
+			if(offset + header.size > data.size()) {
+				return false;
+			}
+			func(header, data.data() + offset);
+			offset += header.size;
+		}
+		return true;
+	};
+
+	Calibration calibration;
+	core::Vector<core::String> zone_names;
+	const bool valid = for_each_record([&](const RecordHeader& header, const u8* payload) {
+		if(header.type == RecordType::Calibration && header.size == sizeof(Calibration)) {
+			std::memcpy(&calibration, payload, sizeof(Calibration));
+		} else if(header.type == RecordType::Zone) {
+			while(zone_names.size() <= header.id) {
+				zone_names.emplace_back();
+			}
+			zone_names[header.id] = core::String(reinterpret_cast<const char*>(payload), header.size);
+		}
+	});
+	if(!valid || calibration.end_ticks <= calibration.start_ticks) {
+		return core::Err();
+	}
+
+	const double us_per_tick = (calibration.end_us - calibration.start_us) / double(calibration.end_ticks - calibration.start_ticks);
+	const auto to_us = [&](u64 t) {
+		return calibration.start_us + double(t - calibration.start_ticks) * us_per_tick;
+	};
+
+	auto out_file = io2::File::create(json_filename);
+	if(!out_file) {
+		return core::Err();
+	}
+	io2::File& out = out_file.unwrap();
+
+	bool write_ok = true;
+	const auto write = [&](const char* str, usize len) {
+		write_ok &= out.write(str, len).is_ok();
+	};
+	char b[256] = {};
+
+	const std::string_view start = R"({"traceEvents":[)";
+	write(start.data(), start.size());
+
+	for_each_record([&](const RecordHeader& header, const u8* payload) {
+		if(header.type == RecordType::Thread) {
+			const int len = std::snprintf(b, sizeof(b), R"({"name":"thread_name","ph":"M","pid":0,"tid":%u,"args":{"name":"%u: %.*s"}},)", header.id, header.id, int(header.size), reinterpret_cast<const char*>(payload));
+			write(b, std::min(usize(len), sizeof(b) - 1));
+		} else if(header.type == RecordType::Dropped) {
+			u32 dropped = 0;
+			std::memcpy(&dropped, payload, sizeof(dropped));
+			const int len = std::snprintf(b, sizeof(b), R"({"name":"%u events dropped","cat":"perf","ph":"I","pid":0,"tid":%u,"ts":%.1f},)", dropped, header.id, calibration.end_us);
+			write(b, usize(len));
+		} else if(header.type == RecordType::Events) {
+			const usize count = header.size / sizeof(Event);
+			for(usize i = 0; i != count; ++i) {
+				Event event;
+				std::memcpy(&event, payload + i * sizeof(Event), sizeof(Event));
+				if(event.type == EventType::CounterValue || event.ticks < calibration.start_ticks || event.zone >= zone_names.size()) {
+					continue;
+				}
+
+				if(event.type == EventType::Counter) {
+					Event value_event;
+					if(i + 1 == count) {
+						continue;
+					}
+					std::memcpy(&value_event, payload + (i + 1) * sizeof(Event), sizeof(Event));
+					if(value_event.type != EventType::CounterValue) {
+						continue;
+					}
+
+					double value = 0.0;
+					std::memcpy(&value, &value_event.ticks, sizeof(value));
+					if(!std::isfinite(value)) {
+						value = 0.0;
+					}
+
+					const core::String& name = zone_names[event.zone];
+					const std::string_view name_begin = R"({"name":")";
+					write(name_begin.data(), name_begin.size());
+					write(name.data(), name.size());
+					const int len = std::snprintf(b, sizeof(b), R"(","cat":"","ph":"C","pid":0,"tid":%u,"ts":%.1f,"args":{"value":%.17g}},)", header.id, to_us(event.ticks), value);
+					write(b, usize(len));
+					++i;
+					continue;
+				}
+
+				const char phase = event.type == EventType::Enter ? 'B' : (event.type == EventType::Leave ? 'E' : 'I');
+				const core::String& name = zone_names[event.zone];
+				const std::string_view name_begin = R"({"name":")";
+				write(name_begin.data(), name_begin.size());
+				write(name.data(), name.size());
+				const int len = std::snprintf(b, sizeof(b), R"(","cat":"","ph":"%c","pid":0,"tid":%u,"ts":%.1f},)", phase, header.id, to_us(event.ticks));
+				write(b, usize(len));
+			}
+		}
+	});
+
+	const int len = std::snprintf(b, sizeof(b), R"({"name":"capture ended","cat":"perf","ph":"I","pid":0,"tid":0,"ts":%.1f}]})", calibration.end_us);
+	write(b, usize(len));
+
+	if(!write_ok) {
+		return core::Err();
+	}
+	return core::Ok();
+}
+
+
+void set_zone_stats_enabled(bool enabled) {
+	if(enabled) {
+		recording_mode.fetch_or(CollectingStats);
 	} else {
-		y_debug_assert(thread_local_ptr);
-		data = thread_local_ptr->shared_from_this();
+		recording_mode.fetch_and(~u32(CollectingStats));
 	}
-	return data;
 }
 
-static int paren(const char* buff) {
-	if(const char* p = std::strchr(buff, '('); p) {
-		return p - buff;
+bool zone_stats_enabled() {
+	return recording_mode & CollectingStats;
+}
+
+void end_frame() {
+#ifdef Y_PERF_LOG_ENABLED
+	if(recording_mode.load(std::memory_order_relaxed) & RecordingEvents) {
+		static const ZoneId live_bytes = zone_id("Allocator live bytes");
+		static const ZoneId pending_tasks = zone_id("Thread pool pending tasks");
+		counter(live_bytes, double(memory::ThreadCachingAllocator::stats().live_bytes));
+		counter(pending_tasks, double(concurrent::default_thread_pool().pending_tasks()));
+	}
+#endif
+
+	Recorder& r = recorder();
+	std::unique_lock lock(r.stats_lock);
+
+	// Merge before starting the next frame: threads reset their records when they see a new frame
+	const u64 frame = current_frame.load(std::memory_order_relaxed);
+	for(usize i = 0; i != r.thread_stats.size();) {
+		const ThreadStats& stats = *r.thread_stats[i];
+		const bool orphaned = stats.orphaned.load(std::memory_order_acquire);
+		merge_thread_stats(r, stats, frame);
+		if(orphaned) {
+			r.thread_stats.erase_unordered(r.thread_stats.begin() + i);
+		} else {
+			++i;
+		}
 	}
-	return print_buffer_len;
+	current_frame.store(frame + 1, std::memory_order_relaxed);
+
+	const u64 now = ticks();
+	const double tick_us = us_per_tick(r, now);
+
+	ZoneStatsSnapshot& snapshot = r.snapshot;
+	snapshot.frame = frame;
+	snapshot.frame_us = double(now - r.frame_start_ticks) * tick_us;
+	snapshot.zones.make_empty();
+	r.frame_start_ticks = now;
+
+	{
+		const std::unique_lock zones_lock(r.zones_lock);
+		for(const ZoneId zone : r.touched_zones) {
+			ZoneAccumulator& acc = r.accumulators[zone];
+
+			ZoneStats& stats = snapshot.zones.emplace_back();
+			stats.name = r.zone_names[zone];
+			stats.zone = zone;
+			stats.count = acc.count;
+			stats.total_us = double(acc.total) * tick_us;
+			stats.min_us = double(acc.min) * tick_us;
+			stats.max_us = double(acc.max) * tick_us;
+			stats.p50_us = percentile(acc, 0.5) * tick_us;
+			stats.p99_us = percentile(acc, 0.99) * tick_us;
+
+			acc = ZoneAccumulator();
+		}
+	}
+	r.touched_zones.make_empty();
+
+	std::sort(snapshot.zones.begin(), snapshot.zones.end(), [](const ZoneStats& a, const ZoneStats& b) { return a.total_us > b.total_us; });
+
+	const double frame_us = snapshot.frame_us;
+	lock.unlock();
+
+	flight_recorder_end_frame(r, frame, now, frame_us);
 }
 
-void enter(const char* cat, const char* func) {
-	if(!is_capturing()) {
-		return;
+ZoneStatsSnapshot zone_stats() {
+	Recorder& r = recorder();
+	const std::unique_lock lock(r.stats_lock);
+	return r.snapshot;
+}
+
+
+void start_flight_recorder(const FlightRecorderSettings& settings) {
+	Recorder& r = recorder();
+	const std::unique_lock lock(r.lock);
+
+	r.flight_settings = settings;
+	r.flight_settings.frame_count = std::clamp(settings.frame_count, usize(1), max_flight_frames);
+
+	// Until enough frames have been recorded, dumps start when the recorder started
+	r.frame_starts = core::Vector<u64>(r.flight_settings.frame_count, ticks());
+	r.frame_start_index = 0;
+
+	// The current frame started before the recorder, its duration says nothing
+	r.next_spike_dump = current_frame.load(std::memory_order_relaxed) + 1;
+
+	recording_mode.fetch_or(FlightRecording);
+}
+
+void stop_flight_recorder() {
+	Recorder& r = recorder();
+	const std::unique_lock lock(r.lock);
+	recording_mode.fetch_and(~u32(FlightRecording));
+}
+
+bool is_flight_recording() {
+	return recording_mode & FlightRecording;
+}
+
+core::String dump_recent() {
+	Recorder& r = recorder();
+	const std::unique_lock lock(r.lock);
+	return dump_flight_recorder(r, current_frame.load(std::memory_order_relaxed));
+}
+
+
+u64 enter(ZoneId zone) {
+	const u32 mode = recording_mode.load(std::memory_order_relaxed);
+	if(!mode) {
+		return 0;
 	}
-	char b[print_buffer_len];
-	const usize len = std::snprintf(b, sizeof(b), R"({"name":"%.*s","cat":"%s","ph":"B","pid":0,"tid":%u,"ts":%.1f},)", paren(func), func, cat, concurrent::thread_id(), micros());
-	if(len >= sizeof(b)) {
-		y_fatal("Too long.");
+
+	const u64 timestamp = ticks();
+	if(mode & RecordingEvents) {
+		record(zone, EventType::Enter, timestamp, mode);
 	}
-	thread_data()->write(b, len);
+	return timestamp;
 }
 
-void leave(const char* cat, const char* func) {
-	if(!is_capturing()) {
+void leave(ZoneId zone, u64 start) {
+	const u32 mode = recording_mode.load(std::memory_order_relaxed);
+	if(!mode || !start) {
 		return;
 	}
-	char b[print_buffer_len];
-	const usize len = std::snprintf(b, sizeof(b), R"({"name":"%.*s","cat":"%s","ph":"E","pid":0,"tid":%u,"ts":%.1f},)", paren(func), func, cat, concurrent::thread_id(), micros());
-	if(len >= sizeof(b)) {
-		y_fatal("Too long.");
+
+	const u64 timestamp = ticks();
+	if(mode & RecordingEvents) {
+		record(zone, EventType::Leave, timestamp, mode);
+	}
+	if(mode & CollectingStats) {
+		record_stats(zone, timestamp - start);
 	}
-	thread_data()->write(b, len);
 }
 
-void event(const char* cat, const char* name) {
-	if(!is_capturing()) {
-		return;
+void counter(ZoneId zone, double value) {
+	const u32 mode = recording_mode.load(std::memory_order_relaxed);
+	if(mode & RecordingEvents) {
+		record_counter(zone, value, mode);
 	}
-	char b[print_buffer_len];
-	const usize len = std::snprintf(b, sizeof(b), R"({"name":"%s","cat":"%s","ph":"I","pid":0,"tid":%u,"ts":%.1f},)", name, cat, concurrent::thread_id(), micros());
-	if(len >= sizeof(b)) {
-		y_fatal("Too long.");
+}
+
+void counter(const char* name, double value) {
+	const u32 mode = recording_mode.load(std::memory_order_relaxed);
+	if(mode & RecordingEvents) {
+		record_counter(zone_id(name), value, mode);
 	}
-	thread_data()->write(b, len);
 }
 
+void event(ZoneId zone) {
+	const u32 mode = recording_mode.load(std::memory_order_relaxed);
+	if(mode & RecordingEvents) {
+		record(zone, EventType::Instant, ticks(), mode);
+	}
+}
 
-#else
-void start_capture(const char*) {}
-void end_capture() {}
-bool is_capturing() { return false; }
-void enter(const char*, const char*) {}
-void leave(const char*, const char*) {}
-void event(const char*, const char*) {}
-#endif
+void event(const char* name) {
+	const u32 mode = recording_mode.load(std::memory_order_relaxed);
+	if(mode & RecordingEvents) {
+		record(zone_id(name), EventType::Instant, ticks(), mode);
+	}
+}
 
 }
 }
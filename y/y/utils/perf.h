@@ -23,43 +23,116 @@ SOFTWARE.
 #define Y_UTILS_PERF_H
 
 #include <y/utils.h>
+#include <y/core/Result.h>
+#include <y/core/String.h>
+#include <y/core/Vector.h>
 
 namespace y {
 namespace perf {
 
-// For use with chrome://tracing
+// Captures are recorded as fixed size binary events in per thread ring buffers, drained by a background thread.
+// The binary capture is then converted to the chrome://tracing format
 // Format described here: https://docs.google.com/document/d/1CvAClvFfyA5R-PhYUmn5OOQtYMH4h6I0nSsKchNAySU/preview
 
+using ZoneId = u32;
+
+// Zones are interned by content, ids are stable for the lifetime of the program
+ZoneId zone_id(const char* name);
+
+// Records into out_filename + ".bin", end_capture converts it into out_filename
 void start_capture(const char* out_filename);
 void end_capture();
 
 bool is_capturing();
 
-void enter(const char* cat, const char* func);
-void leave(const char* cat, const char* func);
-void event(const char* cat, const char* name);
-
-inline auto log_func(const char* func, const char* cat = "") {
-	class Logger : NonCopyable {
-		const char* _cat;
-		const char* _func;
-		public:
-			Logger(const char* cat, const char* func) : _cat(cat), _func(func) {
-				enter(cat, func);
-			}
-			~Logger() {
-				leave(_cat, _func);
-			}
-	};
-
-	return Logger(cat, func);
-}
+// Offline conversion of a binary capture to chrome://tracing JSON
+core::Result<void> convert_capture(const char* binary_filename, const char* json_filename);
+
+// enter returns the timestamp to give back to leave, 0 if neither captures nor zone stats are enabled
+u64 enter(ZoneId zone);
+void leave(ZoneId zone, u64 start);
+void event(ZoneId zone);
+void event(const char* name);
+
+// Counters are recorded as chrome://tracing "C" events, they share their ids with zones
+void counter(ZoneId counter, double value);
+void counter(const char* name, double value);
+
+class ScopedZone : NonCopyable {
+	public:
+		ScopedZone(ZoneId zone) : _zone(zone), _start(enter(zone)) {
+		}
+
+		~ScopedZone() {
+			leave(_zone, _start);
+		}
+
+	private:
+		ZoneId _zone;
+		u64 _start;
+};
+
+
+// Zone stats aggregate every zone per frame, without capturing. Enabled by default when Y_PERF_LOG_ENABLED is defined
+struct ZoneStats {
+	core::String name;
+	ZoneId zone = 0;
+
+	u64 count = 0;
+	double total_us = 0.0;
+	double min_us = 0.0;
+	double max_us = 0.0;
+
+	// Approximated from log scale histograms (within ~12%)
+	double p50_us = 0.0;
+	double p99_us = 0.0;
+};
+
+struct ZoneStatsSnapshot {
+	u64 frame = 0;
+	double frame_us = 0.0;
+
+	// Hottest (highest total time) first
+	core::Vector<ZoneStats> zones;
+};
+
+void set_zone_stats_enabled(bool enabled);
+bool zone_stats_enabled();
+
+// Closes the current frame: its stats are merged from all threads and returned by zone_stats() until the next call
+// When Y_PERF_LOG_ENABLED is defined, also records the built-in counters (allocator live bytes and default thread pool pending tasks)
+void end_frame();
+ZoneStatsSnapshot zone_stats();
+
+
+// The flight recorder keeps the last frames in the per thread rings (overwriting the oldest events, memory use is fixed)
+// Frames are delimited by end_frame(), busy threads might wrap their ring before frame_count frames
+struct FlightRecorderSettings {
+	usize frame_count = 8;
+
+	// Frames longer than this are dumped automatically, 0 to disable
+	double spike_threshold_ms = 0.0;
+
+	// Dumps are written to <output_prefix>_<frame>.json
+	core::String output_prefix = "perf_recent";
+};
+
+void start_flight_recorder(const FlightRecorderSettings& settings = FlightRecorderSettings());
+void stop_flight_recorder();
+
+bool is_flight_recording();
+
+// Dumps the retained frames to chrome://tracing JSON, returns the name of the file or an empty string if not recording (or capturing)
+core::String dump_recent();
 
 #ifdef Y_PERF_LOG_ENABLED
 
-#define y_profile_event() y::perf::event("", Y_FUNCTION_NAME)
-#define y_profile() auto y_create_name_with_prefix(prof) = y::perf::log_func(Y_FUNCTION_NAME)
-#define y_profile_zone(name) auto y_create_name_with_prefix(prof) = y::perf::log_func(name)
+// y_profile_zone only takes string literals, dynamic names are interned once by the caller and given to y_profile_zone_id
+#define y_profile_event() y::perf::event(Y_FUNCTION_NAME)
+#define y_profile() static const y::perf::ZoneId y_create_name_with_prefix(zone) = y::perf::zone_id(Y_FUNCTION_NAME); y::perf::ScopedZone y_create_name_with_prefix(prof)(y_create_name_with_prefix(zone))
+#define y_profile_zone(name) static const y::perf::ZoneId y_create_name_with_prefix(zone) = y::perf::zone_id("" name); y::perf::ScopedZone y_create_name_with_prefix(prof)(y_create_name_with_prefix(zone))
+#define y_profile_zone_id(zone) y::perf::ScopedZone y_create_name_with_prefix(prof)(zone)
+#define y_profile_counter(name, value) do { static const y::perf::ZoneId y_create_name_with_prefix(counter) = y::perf::zone_id("" name); y::perf::counter(y_create_name_with_prefix(counter), double(value)); } while(false)
 #define y_profile_unique_lock(inner) [&]() {							\
 		std::unique_lock l(inner, std::defer_lock);						\
 		if(l.try_lock()) {												\
@@ -72,8 +145,11 @@ inline auto log_func(const char* func, const char* cat = "") {
 
 #else
 
+#define y_profile_event() do {} while(false)
 #define y_profile() do {} while(false)
 #define y_profile_zone(name) do {} while(false)
+#define y_profile_zone_id(zone) do {} while(false)
+#define y_profile_counter(name, value) do {} while(false)
 #define y_profile_unique_lock(lock) std::unique_lock(lock)
 
 #endif
@@ -22,31 +22,191 @@ SOFTWARE.
 #ifndef Y_UTILS_SORT_H
 #define Y_UTILS_SORT_H
 
-#include "types.h"
+#include <y/defines.h>
+#include "traits.h"
+
 #include <array>
+#include <memory>
+#include <algorithm>
 
 #if __has_include(<pdqsort.h>)
 #include <pdqsort.h>
 #define Y_USE_PDQSORT
 #else
-#include <algorithm>
 // you can find pdqsort at https://github.com/orlp/pdqsort
 #endif
 
 
 namespace y {
 
+namespace detail {
+// Below this, pdqsort beats the fixed cost of the radix passes (one per key byte)
+template<typename K>
+static constexpr usize radix_sort_threshold = 128 * sizeof(K);
+
+template<typename K>
+constexpr bool is_radix_key_v = (std::is_integral_v<K> || std::is_enum_v<K>) && !std::is_same_v<K, bool>;
+
+template<typename T, typename K>
+constexpr bool is_radix_sortable_v = is_radix_key_v<K> && std::is_trivially_copyable_v<T>;
+
+// Buffer of the same size as the data, for sorts that ping-pong between the two. T doesn't need to be default constructible.
+// Trivially copyable elements are left in the data, others are moved into the scratch buffer (see holds_elements)
+template<typename T>
+class SortScratch {
+	public:
+		static constexpr bool holds_elements = !std::is_trivially_copyable_v<T>;
+
+		SortScratch([[maybe_unused]] T* data, usize size) : _data(std::allocator<T>().allocate(size)), _size(size) {
+			if constexpr(holds_elements) {
+				std::uninitialized_move(data, data + size, _data);
+			} else if constexpr(std::is_trivially_default_constructible_v<T>) {
+				std::uninitialized_default_construct_n(_data, _size);
+			} else {
+				std::uninitialized_copy(data, data + size, _data);
+			}
+		}
+
+		~SortScratch() {
+			std::destroy_n(_data, _size);
+			std::allocator<T>().deallocate(_data, _size);
+		}
+
+		SortScratch(const SortScratch&) = delete;
+		SortScratch& operator=(const SortScratch&) = delete;
+
+		T* data() const {
+			return _data;
+		}
+
+	private:
+		T* _data = nullptr;
+		usize _size = 0;
+};
+
+// Maps keys to unsigned integers that sort in the same order
+template<typename K>
+constexpr auto radix_key(K key) {
+	if constexpr(std::is_enum_v<K>) {
+		return radix_key(std::underlying_type_t<K>(key));
+	} else {
+		using unsigned_type = std::make_unsigned_t<K>;
+		if constexpr(std::is_signed_v<K>) {
+			return unsigned_type(unsigned_type(key) ^ (unsigned_type(1) << (sizeof(K) * 8 - 1)));
+		} else {
+			return unsigned_type(key);
+		}
+	}
+}
+
+template<typename It>
+auto contiguous_data(It it) {
+	return std::addressof(*it);
+}
+
+template<typename T, typename Key>
+void radix_sort(T* data, usize size, Key& key, T* scratch) {
+	using key_type = decltype(radix_key(key(*data)));
+	static constexpr usize digit_count = sizeof(key_type);
+
+	usize histograms[digit_count][256] = {};
+	for(usize i = 0; i != size; ++i) {
+		const key_type k = radix_key(key(data[i]));
+		for(usize d = 0; d != digit_count; ++d) {
+			++histograms[d][(k >> (d * 8)) & 0xFF];
+		}
+	}
+
+	T* src = data;
+	T* dst = scratch;
+	for(usize d = 0; d != digit_count; ++d) {
+		usize* histogram = histograms[d];
+		const usize shift = d * 8;
+
+		// Every key has the same digit, this pass would not move anything
+		if(histogram[(radix_key(key(*src)) >> shift) & 0xFF] == size) {
+			continue;
+		}
+
+		usize offset = 0;
+		for(usize i = 0; i != 256; ++i) {
+			const usize count = histogram[i];
+			histogram[i] = offset;
+			offset += count;
+		}
+
+		for(usize i = 0; i != size; ++i) {
+			dst[histogram[(radix_key(key(src[i])) >> shift) & 0xFF]++] = src[i];
+		}
+		std::swap(src, dst);
+	}
+
+	if(src != data) {
+		std::copy(src, src + size, data);
+	}
+}
+
 template<typename It, typename Compare>
-inline void sort(It begin, It end, Compare&& comp) {
+inline void comparison_sort(It begin, It end, Compare&& comp) {
 #ifdef Y_USE_PDQSORT
 	pdqsort(begin, end, y_fwd(comp));
 #else
 	std::sort(begin, end, y_fwd(comp));
 #endif
 }
+}
+
+
+// Stable LSD radix sort on an integral (or enum) key, It must be contiguous
+template<typename It, typename Key>
+inline void radix_sort(It begin, It end, Key&& key) {
+	using value_type = remove_cvref_t<decltype(*begin)>;
+	static_assert(detail::is_radix_sortable_v<value_type, remove_cvref_t<decltype(key(*begin))>>, "Type can not be radix sorted");
+
+	const usize size = usize(end - begin);
+	if(size <= 1) {
+		return;
+	}
+
+	value_type* data = detail::contiguous_data(begin);
+	const detail::SortScratch<value_type> scratch(data, size);
+	detail::radix_sort(data, size, key, scratch.data());
+}
+
+template<typename It>
+inline void radix_sort(It begin, It end) {
+	radix_sort(begin, end, [](const auto& k) { return k; });
+}
+
+
+// f is either a comparator or a key extractor: f(a, b) -> bool or f(a) -> key
+// Sorting by an integral key will use a radix sort for large enough ranges
+template<typename It, typename F>
+inline void sort(It begin, It end, F&& f) {
+	using value_type = remove_cvref_t<decltype(*begin)>;
+	if constexpr(std::is_invocable_v<F&, const value_type&>) {
+		using key_type = remove_cvref_t<std::invoke_result_t<F&, const value_type&>>;
+		if constexpr(detail::is_radix_sortable_v<value_type, key_type>) {
+			if(usize(end - begin) >= detail::radix_sort_threshold<key_type>) {
+				radix_sort(begin, end, f);
+				return;
+			}
+		}
+		detail::comparison_sort(begin, end, [&](const value_type& a, const value_type& b) { return f(a) < f(b); });
+	} else {
+		detail::comparison_sort(begin, end, y_fwd(f));
+	}
+}
 
 template<typename It>
 inline void sort(It begin, It end) {
+	using value_type = remove_cvref_t<decltype(*begin)>;
+	if constexpr(detail::is_radix_sortable_v<value_type, value_type>) {
+		if(usize(end - begin) >= detail::radix_sort_threshold<value_type>) {
+			radix_sort(begin, end);
+			return;
+		}
+	}
 #ifdef Y_USE_PDQSORT
 	pdqsort(begin, end);
 #else
@@ -35,7 +35,7 @@ float Animation::duration() const {
 	return _duration;
 }
 
-std::optional<math::Transform<>> Animation::bone_transform(const core::String& name, float time) const {
+std::optional<math::Transform<>> Animation::bone_transform(const core::Name& name, float time) const {
 	const auto channel = std::find_if(_channels.begin(), _channels.end(), [&](const auto& ch) { return ch.name() == name; });
 
 	if(channel == _channels.end()) {
@@ -37,7 +37,7 @@ class Animation {
 		float duration() const;
 		core::Span<AnimationChannel> channels() const;
 
-		std::optional<math::Transform<>> bone_transform(const core::String& name, float time) const;
+		std::optional<math::Transform<>> bone_transform(const core::Name& name, float time) const;
 
 
 		y_serde3(_duration, _channels)
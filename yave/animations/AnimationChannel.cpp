@@ -24,7 +24,7 @@ SOFTWARE.
 
 namespace yave {
 
-AnimationChannel::AnimationChannel(const core::String& name, core::Vector<BoneKey>&& keys) : _name(name), _keys(keys) {
+AnimationChannel::AnimationChannel(const core::Name& name, core::Vector<BoneKey>&& keys) : _name(name), _keys(keys) {
 	if(_keys.is_empty()) {
 		y_fatal("Empty animation channel.");
 	}
@@ -45,7 +45,7 @@ math::Transform<> AnimationChannel::bone_transform(float time) const {
 }
 
 
-const core::String& AnimationChannel::name() const {
+const core::Name& AnimationChannel::name() const {
 	return _name;
 }
 
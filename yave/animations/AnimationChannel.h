@@ -25,6 +25,7 @@ SOFTWARE.
 #include <yave/meshes/Bone.h>
 
 #include <y/core/Vector.h>
+#include <y/core/Name.h>
 
 namespace yave {
 
@@ -36,18 +37,18 @@ class AnimationChannel {
 		};
 
 		AnimationChannel() = default;
-		AnimationChannel(const core::String& name, core::Vector<BoneKey>&& keys);
+		AnimationChannel(const core::Name& name, core::Vector<BoneKey>&& keys);
 
 		math::Transform<> bone_transform(float time) const;
 
-		const core::String& name() const;
+		const core::Name& name() const;
 		core::Span<BoneKey> keys() const;
 
 
 		y_serde3(_name, _keys)
 
 	private:
-		core::String _name;
+		core::Name _name;
 		core::Vector<BoneKey> _keys;
 };
 
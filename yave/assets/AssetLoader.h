@@ -23,6 +23,7 @@ SOFTWARE.
 #define YAVE_ASSETS_ASSETLOADER_H
 
 #include <y/core/HashMap.h>
+#include <y/mem/MemoryTags.h>
 
 #include <yave/device/DeviceLinked.h>
 
@@ -108,6 +109,8 @@ class AssetLoader : NonMovable, public DeviceLinked {
 		// This is dangerous: Do not call in loading threads!
 		void wait_until_loaded(const GenericAssetPtr& ptr);
 
+		const AssetLoadingThreadPool& thread_pool() const;
+
 
 		template<typename T>
 		inline Result<T> load_res(AssetId id);
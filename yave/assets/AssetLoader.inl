@@ -177,6 +177,7 @@ std::unique_ptr<AssetLoader::LoadingJob> AssetLoader::Loader<T>::create_loading_
 
 			core::Result<void> read() override {
 				y_profile_zone("loading");
+				const memory::ScopedMemoryTag tag(memory::MemoryTag::Assets);
 
 				const AssetId id = _data->id;
 
@@ -205,6 +206,7 @@ std::unique_ptr<AssetLoader::LoadingJob> AssetLoader::Loader<T>::create_loading_
 				}
 
 				y_profile_zone("finalizing");
+				const memory::ScopedMemoryTag tag(memory::MemoryTag::Assets);
 				y_debug_assert(_data->is_loading());
 				_data->finalize_loading(T(dptr, std::move(_load_from)));
 			}
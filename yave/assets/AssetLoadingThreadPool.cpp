@@ -91,6 +91,16 @@ void AssetLoadingThreadPool::add_loading_job(std::unique_ptr<LoadingJob> job) {
 	_condition.notify_one();
 }
 
+usize AssetLoadingThreadPool::pending_loading_jobs() const {
+	const std::unique_lock lock(_lock);
+	return _loading_jobs.size();
+}
+
+usize AssetLoadingThreadPool::pending_finalize_jobs() const {
+	const std::unique_lock lock(_lock);
+	return _finalize_jobs.size();
+}
+
 void AssetLoadingThreadPool::process_one(std::unique_lock<std::mutex> lock) {
 	y_debug_assert(lock.owns_lock());
 
@@ -71,6 +71,9 @@ class AssetLoadingThreadPool : NonMovable {
 
 		void add_loading_job(std::unique_ptr<LoadingJob> job);
 
+		usize pending_loading_jobs() const;
+		usize pending_finalize_jobs() const;
+
 	private:
 		void process_one(std::unique_lock<std::mutex> lock);
 		void worker();
@@ -78,7 +81,7 @@ class AssetLoadingThreadPool : NonMovable {
 		std::deque<std::unique_ptr<LoadingJob>> _loading_jobs;
 		std::list<std::unique_ptr<LoadingJob>> _finalize_jobs;
 
-		std::mutex _lock;
+		mutable std::mutex _lock;
 		std::condition_variable _condition;
 
 		core::Vector<std::thread> _threads;
@@ -25,6 +25,7 @@ SOFTWARE.
 #include <yave/utils/color.h>
 #include <y/utils/log.h>
 #include <y/utils/format.h>
+#include <y/utils/sort.h>
 
 namespace yave {
 
@@ -151,15 +152,18 @@ void FrameGraph::render(CmdBufferRecorder& recorder) && {
 	alloc_resources();
 
 	usize copy_index = 0;
-	std::sort(_image_copies.begin(), _image_copies.end(), [&](const auto& a, const auto& b) { return a.pass_index < b.pass_index; });
+	y::sort(_image_copies.begin(), _image_copies.end(), [](const ImageCopyInfo& copy) { return copy.pass_index; });
+
+	memory::FrameArena& arena = _resources->pool()->frame_arena();
+	y_defer(arena.reset());
 
 	std::unordered_map<FrameGraphResourceId, PipelineStage> to_barrier;
-	core::Vector<BufferBarrier> buffer_barriers;
-	core::Vector<ImageBarrier> image_barriers;
+	memory::FrameVector<BufferBarrier> buffer_barriers(memory::FrameArenaAllocator{arena});
+	memory::FrameVector<ImageBarrier> image_barriers(memory::FrameArenaAllocator{arena});
 
 	usize pass_id = 0;
 	for(const auto& pass : _passes) {
-		y_profile_zone(pass->name());
+		y_profile_zone_id(pass->_zone_id);
 		const auto region = recorder.region(pass->name(), math::Vec4(identifying_color(pass_id++), 1.0f));
 
 		{
@@ -222,7 +226,7 @@ void FrameGraph::alloc_resources() {
 
 	auto images = core::vector_with_capacity<std::pair<FrameGraphImageId, ImageCreateInfo>>(_images.size());
 	std::copy(_images.begin(), _images.end(), std::back_inserter(images));
-	std::sort(images.begin(), images.end(), [](const auto& a, const auto& b) { return a.second.first_use < b.second.first_use; });
+	y::sort(images.begin(), images.end(), [](const auto& image) { return image.second.first_use; });
 
 	for(auto&& [res, info] : images) {
 		if(info.alias.is_valid()) {
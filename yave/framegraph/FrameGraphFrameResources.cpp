@@ -43,6 +43,10 @@ DevicePtr FrameGraphFrameResources::device() const {
 	return _pool->device();
 }
 
+FrameGraphResourcePool* FrameGraphFrameResources::pool() const {
+	return _pool.get();
+}
+
 u32 FrameGraphFrameResources::create_resource_id() {
 	return _next_id++;
 }
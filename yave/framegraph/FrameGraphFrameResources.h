@@ -33,6 +33,8 @@ class FrameGraphFrameResources final : NonMovable {
 
 		DevicePtr device() const;
 
+		FrameGraphResourcePool* pool() const;
+
 		u32 create_resource_id();
 
 		void create_image(FrameGraphImageId res, ImageFormat format, const math::Vec2ui& size, ImageUsage usage);
@@ -26,6 +26,9 @@ SOFTWARE.
 namespace yave {
 
 FrameGraphPass::FrameGraphPass(std::string_view name, FrameGraph* parent, usize index) : _name(name), _parent(parent), _index(index) {
+#ifdef Y_PERF_LOG_ENABLED
+	_zone_id = _parent->resources().pool()->zone_id(_name);
+#endif
 }
 
 const core::String& FrameGraphPass::name() const {
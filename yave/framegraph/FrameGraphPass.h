@@ -23,6 +23,7 @@ SOFTWARE.
 #define YAVE_FRAMEGRAPH_FRAMEGRAPHPASS_H
 
 #include <y/core/Functor.h>
+#include <y/utils/perf.h>
 
 #include <yave/graphics/descriptors/DescriptorSet.h>
 
@@ -68,6 +69,7 @@ class FrameGraphPass final : NonMovable {
 
 		render_func _render = [](CmdBufferRecorder&, const FrameGraphPass*) {};
 		core::String _name;
+		perf::ZoneId _zone_id = 0;
 
 		FrameGraph* _parent = nullptr;
 		const usize _index;
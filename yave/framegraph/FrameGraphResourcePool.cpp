@@ -126,6 +126,18 @@ void FrameGraphResourcePool::release(TransientBuffer buffer) {
 	audit();
 }
 
+memory::FrameArena& FrameGraphResourcePool::frame_arena() {
+	return _frame_arena;
+}
+
+perf::ZoneId FrameGraphResourcePool::zone_id(const core::String& pass_name) {
+	const auto lock = y_profile_unique_lock(_lock);
+	if(const auto it = _zone_ids.find(pass_name); it != _zone_ids.end()) {
+		return it->second;
+	}
+	return _zone_ids[pass_name] = perf::zone_id(pass_name.data());
+}
+
 void FrameGraphResourcePool::garbage_collect() {
 	y_profile();
 	const auto lock = y_profile_unique_lock(_lock);
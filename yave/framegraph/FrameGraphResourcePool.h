@@ -31,6 +31,9 @@ SOFTWARE.
 #include "FrameGraphResourceToken.h"
 #include "FrameGraphPass.h"
 
+#include <y/mem/FrameArena.h>
+#include <y/core/HashMap.h>
+
 #include <mutex>
 
 namespace yave {
@@ -50,6 +53,12 @@ class FrameGraphResourcePool : NonMovable, public DeviceLinked {
 
 		void garbage_collect();
 
+		// Reset at the end of every FrameGraph::render, graphs sharing a pool must not render concurrently
+		memory::FrameArena& frame_arena();
+
+		// Graphs are rebuilt every frame, this keeps pass names from being interned again each time
+		perf::ZoneId zone_id(const core::String& pass_name);
+
 	private:
 		bool create_image_from_pool(TransientImage<>& res, ImageFormat format, const math::Vec2ui& size, ImageUsage usage);
 		bool create_buffer_from_pool(TransientBuffer& res, usize byte_size, BufferUsage usage, MemoryType memory);
@@ -59,6 +68,10 @@ class FrameGraphResourcePool : NonMovable, public DeviceLinked {
 
 		u64 _collection_id = 0;
 
+		memory::FrameArena _frame_arena;
+
+		core::ExternalHashMap<core::String, perf::ZoneId> _zone_ids;
+
 		void audit() const;
 
 		Y_TODO(Find a way to not lock on every method call)
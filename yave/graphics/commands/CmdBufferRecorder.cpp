@@ -148,8 +148,10 @@ void RenderPassRecorder::bind_attrib_buffers(const SubBuffer<BufferUsage::Attrib
 		bool has_per_vertex = per_vertex.device();
 		const u32 attrib_count = per_instance.size() + has_per_vertex;
 
-		auto offsets = core::vector_with_capacity<VkDeviceSize>(attrib_count);
-		auto buffers = core::vector_with_capacity<VkBuffer>(attrib_count);
+		core::SmallVector<VkDeviceSize, 8> offsets;
+		core::SmallVector<VkBuffer, 8> buffers;
+		offsets.set_min_capacity(attrib_count);
+		buffers.set_min_capacity(attrib_count);
 
 		if(has_per_vertex) {
 			offsets << per_vertex.byte_offset();
@@ -314,10 +316,12 @@ void CmdBufferRecorder::barriers(core::Span<BufferBarrier> buffers, core::Span<I
 		return;
 	}
 
-	auto image_barriers = core::vector_with_capacity<VkImageMemoryBarrier>(images.size());
+	core::SmallVector<VkImageMemoryBarrier, 8> image_barriers;
+	image_barriers.set_min_capacity(images.size());
 	std::transform(images.begin(), images.end(), std::back_inserter(image_barriers), [](const auto& b) { return b.vk_barrier(); });
 
-	auto buffer_barriers = core::vector_with_capacity<VkBufferMemoryBarrier>(buffers.size());
+	core::SmallVector<VkBufferMemoryBarrier, 8> buffer_barriers;
+	buffer_barriers.set_min_capacity(buffers.size());
 	std::transform(buffers.begin(), buffers.end(), std::back_inserter(buffer_barriers), [](const auto& b) { return b.vk_barrier(); });
 
 	PipelineStage src_mask = PipelineStage::None;
@@ -39,8 +39,7 @@ namespace std {
 template<>
 struct hash<VkDescriptorSetLayoutBinding> {
 	auto operator()(const VkDescriptorSetLayoutBinding& l) const {
-		const char* data = reinterpret_cast<const char*>(&l);
-		return y::hash_range(data, data + sizeof(l));
+		return y::usize(y::hash_bytes(&l, sizeof(l)));
 	}
 };
 
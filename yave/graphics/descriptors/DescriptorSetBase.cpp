@@ -28,7 +28,8 @@ namespace yave {
 void DescriptorSetBase::update_set(DevicePtr dptr, core::Span<Descriptor> bindings) {
 	y_profile();
 
-	auto writes = core::vector_with_capacity<VkWriteDescriptorSet>(bindings.size());
+	core::SmallVector<VkWriteDescriptorSet, 16> writes;
+	writes.set_min_capacity(bindings.size());
 	for(const auto& binding : bindings) {
 		const u32 descriptor_count = binding.descriptor_set_layout_binding(0).descriptorCount;
 		VkWriteDescriptorSet write = vk_struct();
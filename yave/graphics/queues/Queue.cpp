@@ -61,9 +61,10 @@ void Queue::submit_base(CmdBufferBase& base) const {
 	auto cmd = base.vk_cmd_buffer();
 
 	const auto& wait = base._proxy->data()._waits;
-	auto wait_semaphores = core::vector_with_capacity<VkSemaphore>(wait.size());
+	core::SmallVector<VkSemaphore, 8> wait_semaphores;
+	wait_semaphores.set_min_capacity(wait.size());
 	std::transform(wait.begin(), wait.end(), std::back_inserter(wait_semaphores), [](const auto& s) { return s.vk_semaphore(); });
-	const core::Vector<VkPipelineStageFlags> stages(wait.size(), VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+	const core::SmallVector<VkPipelineStageFlags, 8> stages(wait.size(), VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
 
 	const Semaphore& signal = base._proxy->data()._signal;
 	const VkSemaphore sig_semaphore = signal.device() ? signal.vk_semaphore() : VkSemaphore{};
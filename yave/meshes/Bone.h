@@ -24,7 +24,7 @@ SOFTWARE.
 
 #include <yave/yave.h>
 #include <yave/utils/serde.h>
-#include <y/core/String.h>
+#include <y/core/Name.h>
 
 namespace yave {
 
@@ -48,7 +48,7 @@ struct BoneTransform {
 static_assert(std::is_trivially_copyable_v<BoneTransform>, "BoneTransform should be trivially copyable");
 
 struct Bone {
-	core::String name;
+	core::Name name;
 	u32 parent;
 
 	BoneTransform local_transform;